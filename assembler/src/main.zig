@@ -8,8 +8,16 @@ const std = @import("std");
 // hardware side. This is basically the reverse of that decoder.
 //
 // Format types:
-//   R-type: register-register ops   (add, sub, and, or, xor, sll, srl, sra, slt, sltu)
-//   I-type: register-immediate ops  (addi, andi, ori, xori, slti, sltiu, slli, srli, srai)
+//   R-type: register-register ops   (add, sub, and, or, xor, sll, srl, sra, slt, sltu,
+//                                    and the M extension: mul, mulh, mulhsu, mulhu,
+//                                    div, divu, rem, remu,
+//                                    and Zba/Zbb: sh1add, sh2add, sh3add, andn, orn, xnor,
+//                                    min, minu, max, maxu, rol, ror)
+//   I-type: register-immediate ops  (addi, andi, ori, xori, slti, sltiu, slli, srli, srai,
+//                                    and Zbb's rori)
+//   R1-type: unary Zbb ops          (clz, ctz, cpop, sext.b, sext.h, zext.h, rev8, orc.b)
+//                                    — the rs2 field is fixed and picks the op
+//   CSR-type: counter reads         (csrr rd, cycle) — csrrs rd, csr, x0
 //   IL-type: loads                  (lw) — same encoding as I-type but different opcode
 //   S-type: stores                  (sw)
 //   B-type: branches                (beq, bne, blt, bge, bltu, bgeu)
@@ -20,11 +28,13 @@ const std = @import("std");
 const Format = enum {
     R, // register-register: add x3, x1, x2
     I, // immediate:         addi x1, x0, 5
+    R1, // unary:            clz x1, x2
     IL, // load:             lw x1, 0(x2)
     S, // store:             sw x1, 0(x2)
     B, // branch:            beq x1, x2, label
     U, // upper immediate:   lui x1, 0x12345
     J, // jump:              jal x1, label
+    CSR, // counter read:    csrr x1, instret
 };
 
 // Each entry describes one instruction: its name, opcode, funct3, funct7, and format.
@@ -35,6 +45,7 @@ const InsnInfo = struct {
     funct3: u3,
     funct7: u7,
     format: Format,
+    rs2: u5 = 0, // Fixed rs2 field of the unary ops
 };
 
 // This is our lookup table. When we see "add" in the assembly, we search
@@ -52,6 +63,41 @@ const insn_table = [_]InsnInfo{
     .{ .name = "or", .opcode = 0x33, .funct3 = 0x6, .funct7 = 0x00, .format = .R },
     .{ .name = "and", .opcode = 0x33, .funct3 = 0x7, .funct7 = 0x00, .format = .R },
 
+    // M extension: multiply/divide (opcode 0x33, funct7 0000001 = 0x01)
+    .{ .name = "mul", .opcode = 0x33, .funct3 = 0x0, .funct7 = 0x01, .format = .R },
+    .{ .name = "mulh", .opcode = 0x33, .funct3 = 0x1, .funct7 = 0x01, .format = .R },
+    .{ .name = "mulhsu", .opcode = 0x33, .funct3 = 0x2, .funct7 = 0x01, .format = .R },
+    .{ .name = "mulhu", .opcode = 0x33, .funct3 = 0x3, .funct7 = 0x01, .format = .R },
+    .{ .name = "div", .opcode = 0x33, .funct3 = 0x4, .funct7 = 0x01, .format = .R },
+    .{ .name = "divu", .opcode = 0x33, .funct3 = 0x5, .funct7 = 0x01, .format = .R },
+    .{ .name = "rem", .opcode = 0x33, .funct3 = 0x6, .funct7 = 0x01, .format = .R },
+    .{ .name = "remu", .opcode = 0x33, .funct3 = 0x7, .funct7 = 0x01, .format = .R },
+
+    // Zba: shift-and-add for address arithmetic
+    .{ .name = "sh1add", .opcode = 0x33, .funct3 = 0x2, .funct7 = 0x10, .format = .R },
+    .{ .name = "sh2add", .opcode = 0x33, .funct3 = 0x4, .funct7 = 0x10, .format = .R },
+    .{ .name = "sh3add", .opcode = 0x33, .funct3 = 0x6, .funct7 = 0x10, .format = .R },
+
+    // Zbb: basic bit manipulation
+    .{ .name = "andn", .opcode = 0x33, .funct3 = 0x7, .funct7 = 0x20, .format = .R },
+    .{ .name = "orn", .opcode = 0x33, .funct3 = 0x6, .funct7 = 0x20, .format = .R },
+    .{ .name = "xnor", .opcode = 0x33, .funct3 = 0x4, .funct7 = 0x20, .format = .R },
+    .{ .name = "min", .opcode = 0x33, .funct3 = 0x4, .funct7 = 0x05, .format = .R },
+    .{ .name = "minu", .opcode = 0x33, .funct3 = 0x5, .funct7 = 0x05, .format = .R },
+    .{ .name = "max", .opcode = 0x33, .funct3 = 0x6, .funct7 = 0x05, .format = .R },
+    .{ .name = "maxu", .opcode = 0x33, .funct3 = 0x7, .funct7 = 0x05, .format = .R },
+    .{ .name = "rol", .opcode = 0x33, .funct3 = 0x1, .funct7 = 0x30, .format = .R },
+    .{ .name = "ror", .opcode = 0x33, .funct3 = 0x5, .funct7 = 0x30, .format = .R },
+    .{ .name = "rori", .opcode = 0x13, .funct3 = 0x5, .funct7 = 0x30, .format = .I },
+    .{ .name = "clz", .opcode = 0x13, .funct3 = 0x1, .funct7 = 0x30, .format = .R1, .rs2 = 0x00 },
+    .{ .name = "ctz", .opcode = 0x13, .funct3 = 0x1, .funct7 = 0x30, .format = .R1, .rs2 = 0x01 },
+    .{ .name = "cpop", .opcode = 0x13, .funct3 = 0x1, .funct7 = 0x30, .format = .R1, .rs2 = 0x02 },
+    .{ .name = "sext.b", .opcode = 0x13, .funct3 = 0x1, .funct7 = 0x30, .format = .R1, .rs2 = 0x04 },
+    .{ .name = "sext.h", .opcode = 0x13, .funct3 = 0x1, .funct7 = 0x30, .format = .R1, .rs2 = 0x05 },
+    .{ .name = "zext.h", .opcode = 0x33, .funct3 = 0x4, .funct7 = 0x04, .format = .R1, .rs2 = 0x00 },
+    .{ .name = "rev8", .opcode = 0x13, .funct3 = 0x5, .funct7 = 0x34, .format = .R1, .rs2 = 0x18 },
+    .{ .name = "orc.b", .opcode = 0x13, .funct3 = 0x5, .funct7 = 0x14, .format = .R1, .rs2 = 0x07 },
+
     // I-type ALU (opcode 0010011 = 0x13)
     .{ .name = "addi", .opcode = 0x13, .funct3 = 0x0, .funct7 = 0x00, .format = .I },
     .{ .name = "slti", .opcode = 0x13, .funct3 = 0x2, .funct7 = 0x00, .format = .I },
@@ -86,6 +132,9 @@ const insn_table = [_]InsnInfo{
 
     // Jump register (opcode 1100111 = 0x67) — I-type format
     .{ .name = "jalr", .opcode = 0x67, .funct3 = 0x0, .funct7 = 0x00, .format = .I },
+
+    // Counter CSR read (opcode 1110011 = 0x73): csrrs rd, csr, x0
+    .{ .name = "csrr", .opcode = 0x73, .funct3 = 0x2, .funct7 = 0x00, .format = .CSR },
 };
 
 // Look up an instruction by name. Returns null if not found.
@@ -157,6 +206,54 @@ fn parseRegister(token: []const u8) !u5 {
     return error.InvalidRegister;
 }
 
+// ============================================================================
+// CSR PARSER
+// ============================================================================
+// Counter CSRs by name (cycle, time, instret, hpmcounter3-31, their "h"
+// upper halves, the machine-mode mcycle/minstret/mhpmcounterN and the
+// mhpmeventN selectors), or by number: "csrr x1, 0xC00".
+// ============================================================================
+
+fn parseCsr(token: []const u8) !u12 {
+    if (std.fmt.parseInt(u12, token, 0)) |val| {
+        return val;
+    } else |_| {}
+
+    // An "h" suffix is the upper half, 0x80 above the lower one
+    const high = token.len > 1 and token[token.len - 1] == 'h';
+    const name = if (high) token[0 .. token.len - 1] else token;
+    const upper: u12 = if (high) 0x80 else 0;
+
+    const fixed = [_]struct { name: []const u8, csr: u12 }{
+        .{ .name = "cycle", .csr = 0xC00 },
+        .{ .name = "time", .csr = 0xC01 },
+        .{ .name = "instret", .csr = 0xC02 },
+        .{ .name = "mcycle", .csr = 0xB00 },
+        .{ .name = "minstret", .csr = 0xB02 },
+    };
+    for (fixed) |entry| {
+        if (std.mem.eql(u8, name, entry.name)) return entry.csr + upper;
+    }
+
+    // Numbered counters: hpmcounter3-31, mhpmcounter3-31, mhpmevent3-31
+    const numbered = [_]struct { prefix: []const u8, base: u12 }{
+        .{ .prefix = "hpmcounter", .base = 0xC00 },
+        .{ .prefix = "mhpmcounter", .base = 0xB00 },
+        .{ .prefix = "mhpmevent", .base = 0x320 },
+    };
+    for (numbered) |entry| {
+        if (std.mem.startsWith(u8, name, entry.prefix)) {
+            const n = std.fmt.parseInt(u12, name[entry.prefix.len..], 10) catch
+                return error.InvalidCsr;
+            if (n < 3 or n > 31) return error.InvalidCsr;
+            if (high and entry.base == 0x320) return error.InvalidCsr;
+            return entry.base + n + upper;
+        }
+    }
+
+    return error.InvalidCsr;
+}
+
 // ============================================================================
 // TOKENIZER
 // ============================================================================
@@ -300,6 +397,20 @@ fn encodeInstruction(
                 @as(u32, info.opcode);
         },
 
+        // R1-type (unary): clz rd, rs1
+        // Same bit layout as R-type, with the table's fixed rs2 field
+        .R1 => {
+            if (token_count < 3) return error.NotEnoughOperands;
+            const rd = try parseRegister(tokens[1]);
+            const rs1 = try parseRegister(tokens[2]);
+            return @as(u32, info.funct7) << 25 |
+                @as(u32, info.rs2) << 20 |
+                @as(u32, rs1) << 15 |
+                @as(u32, info.funct3) << 12 |
+                @as(u32, rd) << 7 |
+                @as(u32, info.opcode);
+        },
+
         // IL-type (load): lw rd, offset(rs1)
         // Same bit layout as I-type, but tokens are ordered differently:
         //   "lw x1, 8(x2)" → tokens: ["lw", "x1", "8", "x2"]
@@ -400,9 +511,194 @@ fn encodeInstruction(
                 @as(u32, rd) << 7 |
                 @as(u32, info.opcode);
         },
+
+        // CSR read: csrr rd, csr
+        // Bit layout: [csr][rs1 = x0][funct3][rd][opcode]
+        .CSR => {
+            if (token_count < 3) return error.NotEnoughOperands;
+            const rd = try parseRegister(tokens[1]);
+            const csr = try parseCsr(tokens[2]);
+            return @as(u32, csr) << 20 |
+                @as(u32, info.funct3) << 12 |
+                @as(u32, rd) << 7 |
+                @as(u32, info.opcode);
+        },
     };
 }
 
+// ============================================================================
+// COMPRESSION (RV32C)
+// ============================================================================
+// With -c, every instruction that has a 16-bit form is emitted as one. The
+// compressed forms are just shorter encodings of common cases: small
+// immediates, rd == rs1, registers x8-x15 (the 3-bit rd'/rs1'/rs2'
+// fields), and the stack pointer. The hardware expands them back into
+// the same 32-bit instructions (see rtl/rvc_expander.sv).
+//
+// compressInstruction works on the finished 32-bit encoding, so it
+// doesn't care how the instruction was written (mv, li, ret, ...).
+// ============================================================================
+
+// Bits [hi:lo] of an immediate, ready to be shifted into a 16-bit encoding
+fn cbits(value: i32, comptime hi: u5, comptime lo: u5) u16 {
+    const v: u32 = @bitCast(value);
+    return @truncate((v >> lo) & ((@as(u32, 1) << (hi - lo + 1)) - 1));
+}
+
+fn fitsSigned(value: i32, comptime num_bits: u5) bool {
+    const limit: i32 = 1 << (num_bits - 1);
+    return value >= -limit and value < limit;
+}
+
+// x8-x15: the registers a 3-bit rd'/rs1'/rs2' field can name
+fn isCReg(reg: u32) bool {
+    return reg >= 8 and reg <= 15;
+}
+
+// CI format: [funct3][imm[5]][rd][imm[4:0]][quadrant]
+fn encodeCI(funct3: u16, imm: i32, rd: u16, quadrant: u16) u16 {
+    return funct3 << 13 | cbits(imm, 5, 5) << 12 | rd << 7 | cbits(imm, 4, 0) << 2 | quadrant;
+}
+
+// Returns the 16-bit form of a 32-bit instruction, or null if it has none
+fn compressInstruction(code: u32) ?u16 {
+    const opcode = code & 0x7F;
+    const funct3 = (code >> 12) & 0x7;
+    const funct7 = code >> 25;
+    const rd = (code >> 7) & 0x1F;
+    const rs1 = (code >> 15) & 0x1F;
+    const rs2 = (code >> 20) & 0x1F;
+
+    // Sign-extended immediates of each format
+    const signed: i32 = @bitCast(code);
+    const imm_i: i32 = signed >> 20;
+    const imm_s: i32 = (signed >> 25) * 32 + @as(i32, @intCast(rd));
+    const imm_b: i32 = (signed >> 31) * 4096 + @as(i32, @intCast(((code >> 7) & 0x1) << 11 |
+        ((code >> 25) & 0x3F) << 5 | ((code >> 8) & 0xF) << 1));
+    const imm_j: i32 = (signed >> 31) * 1048576 + @as(i32, @intCast(((code >> 12) & 0xFF) << 12 |
+        ((code >> 20) & 0x1) << 11 | ((code >> 21) & 0x3FF) << 1));
+
+    // Register fields: full 5-bit ones, and 3-bit ones for x8-x15
+    const c_rd: u16 = @truncate(rd);
+    const c_rs1: u16 = @truncate(rs1);
+    const c_rs2: u16 = @truncate(rs2);
+    const c_rd_p: u16 = @truncate(rd & 0x7);
+    const c_rs1_p: u16 = @truncate(rs1 & 0x7);
+    const c_rs2_p: u16 = @truncate(rs2 & 0x7);
+
+    switch (opcode) {
+        0x13 => switch (funct3) {
+            0b000 => {
+                if (rd == 0 and rs1 == 0 and imm_i == 0) return 0x0001; // c.nop
+                if (rd != 0 and rs1 == rd and imm_i != 0 and fitsSigned(imm_i, 6))
+                    return encodeCI(0b000, imm_i, c_rd, 0b01); // c.addi
+                if (rd != 0 and rs1 == 0 and fitsSigned(imm_i, 6))
+                    return encodeCI(0b010, imm_i, c_rd, 0b01); // c.li
+                if (rd == 2 and rs1 == 2 and imm_i != 0 and @mod(imm_i, 16) == 0 and fitsSigned(imm_i, 10))
+                    return 0b011 << 13 | cbits(imm_i, 9, 9) << 12 | 2 << 7 | cbits(imm_i, 4, 4) << 6 |
+                        cbits(imm_i, 6, 6) << 5 | cbits(imm_i, 8, 7) << 3 | cbits(imm_i, 5, 5) << 2 | 0b01; // c.addi16sp
+                if (rs1 == 2 and isCReg(rd) and imm_i > 0 and imm_i <= 1020 and @mod(imm_i, 4) == 0)
+                    return cbits(imm_i, 5, 4) << 11 | cbits(imm_i, 9, 6) << 7 | cbits(imm_i, 2, 2) << 6 |
+                        cbits(imm_i, 3, 3) << 5 | c_rd_p << 2; // c.addi4spn
+                if (rd != 0 and rs1 != 0 and imm_i == 0)
+                    return 0b100 << 13 | c_rd << 7 | c_rs1 << 2 | 0b10; // c.mv
+            },
+            0b001 => {
+                if (funct7 == 0 and rd != 0 and rs1 == rd and rs2 != 0)
+                    return encodeCI(0b000, @intCast(rs2), c_rd, 0b10); // c.slli
+            },
+            0b101 => {
+                if ((funct7 == 0 or funct7 == 0x20) and isCReg(rd) and rs1 == rd and rs2 != 0)
+                    return 0b100 << 13 | @as(u16, if (funct7 == 0x20) 0b01 else 0b00) << 10 |
+                        c_rd_p << 7 | c_rs2 << 2 | 0b01; // c.srli / c.srai
+            },
+            0b111 => {
+                if (isCReg(rd) and rs1 == rd and fitsSigned(imm_i, 6))
+                    return 0b100 << 13 | cbits(imm_i, 5, 5) << 12 | 0b10 << 10 | c_rd_p << 7 |
+                        cbits(imm_i, 4, 0) << 2 | 0b01; // c.andi
+            },
+            else => {},
+        },
+
+        // lui: the 20-bit immediate must be a nonzero 6-bit signed value
+        0x37 => {
+            const upper = code >> 12;
+            if (rd != 0 and rd != 2 and ((upper >= 1 and upper <= 31) or upper >= 0xFFFE0))
+                return encodeCI(0b011, signed >> 12, c_rd, 0b01); // c.lui
+        },
+
+        0x33 => {
+            if (funct7 == 0 and funct3 == 0b000 and rd != 0) {
+                if (rs1 == 0 and rs2 != 0)
+                    return 0b100 << 13 | c_rd << 7 | c_rs2 << 2 | 0b10; // c.mv
+                if (rs1 == rd and rs2 != 0)
+                    return 0b100 << 13 | 1 << 12 | c_rd << 7 | c_rs2 << 2 | 0b10; // c.add
+                if (rs2 == rd and rs1 != 0)
+                    return 0b100 << 13 | 1 << 12 | c_rd << 7 | c_rs1 << 2 | 0b10; // c.add
+            }
+
+            // c.sub, c.xor, c.or, c.and: rd' = rd' op rs2' (all but sub commute)
+            const c_op: ?u16 = switch (funct3) {
+                0b000 => if (funct7 == 0x20) 0b00 else null, // sub
+                0b100 => if (funct7 == 0) 0b01 else null, // xor
+                0b110 => if (funct7 == 0) 0b10 else null, // or
+                0b111 => if (funct7 == 0) 0b11 else null, // and
+                else => null,
+            };
+            if (c_op) |op| {
+                if (isCReg(rd) and rs1 == rd and isCReg(rs2))
+                    return 0b100 << 13 | 0b11 << 10 | c_rd_p << 7 | op << 5 | c_rs2_p << 2 | 0b01;
+                if (op != 0b00 and isCReg(rd) and rs2 == rd and isCReg(rs1))
+                    return 0b100 << 13 | 0b11 << 10 | c_rd_p << 7 | op << 5 | c_rs1_p << 2 | 0b01;
+            }
+        },
+
+        0x03 => {
+            if (funct3 == 0b010 and rs1 == 2 and rd != 0 and imm_i >= 0 and imm_i <= 252 and @mod(imm_i, 4) == 0)
+                return 0b010 << 13 | cbits(imm_i, 5, 5) << 12 | c_rd << 7 | cbits(imm_i, 4, 2) << 4 |
+                    cbits(imm_i, 7, 6) << 2 | 0b10; // c.lwsp
+            if (funct3 == 0b010 and isCReg(rd) and isCReg(rs1) and imm_i >= 0 and imm_i <= 124 and @mod(imm_i, 4) == 0)
+                return 0b010 << 13 | cbits(imm_i, 5, 3) << 10 | c_rs1_p << 7 | cbits(imm_i, 2, 2) << 6 |
+                    cbits(imm_i, 6, 6) << 5 | c_rd_p << 2; // c.lw
+        },
+
+        0x23 => {
+            if (funct3 == 0b010 and rs1 == 2 and imm_s >= 0 and imm_s <= 252 and @mod(imm_s, 4) == 0)
+                return 0b110 << 13 | cbits(imm_s, 5, 2) << 9 | cbits(imm_s, 7, 6) << 7 | c_rs2 << 2 | 0b10; // c.swsp
+            if (funct3 == 0b010 and isCReg(rs2) and isCReg(rs1) and imm_s >= 0 and imm_s <= 124 and @mod(imm_s, 4) == 0)
+                return 0b110 << 13 | cbits(imm_s, 5, 3) << 10 | c_rs1_p << 7 | cbits(imm_s, 2, 2) << 6 |
+                    cbits(imm_s, 6, 6) << 5 | c_rs2_p << 2; // c.sw
+        },
+
+        // jal x0 / x1 within +-2 KiB
+        0x6F => {
+            if ((rd == 0 or rd == 1) and fitsSigned(imm_j, 12))
+                return @as(u16, if (rd == 0) 0b101 else 0b001) << 13 | cbits(imm_j, 11, 11) << 12 |
+                    cbits(imm_j, 4, 4) << 11 | cbits(imm_j, 9, 8) << 9 | cbits(imm_j, 10, 10) << 8 |
+                    cbits(imm_j, 6, 6) << 7 | cbits(imm_j, 7, 7) << 6 | cbits(imm_j, 3, 1) << 3 |
+                    cbits(imm_j, 5, 5) << 2 | 0b01; // c.j / c.jal
+        },
+
+        // jalr x0 / x1, 0(rs1)
+        0x67 => {
+            if (funct3 == 0b000 and imm_i == 0 and rs1 != 0 and (rd == 0 or rd == 1))
+                return 0b100 << 13 | c_rd << 12 | c_rs1 << 7 | 0b10; // c.jr / c.jalr
+        },
+
+        // beq / bne rs1', x0 within +-256 bytes
+        0x63 => {
+            if ((funct3 == 0b000 or funct3 == 0b001) and rs2 == 0 and isCReg(rs1) and fitsSigned(imm_b, 9))
+                return (0b110 + @as(u16, @truncate(funct3))) << 13 | cbits(imm_b, 8, 8) << 12 |
+                    cbits(imm_b, 4, 3) << 10 | c_rs1_p << 7 | cbits(imm_b, 7, 6) << 5 |
+                    cbits(imm_b, 2, 1) << 3 | cbits(imm_b, 5, 5) << 2 | 0b01; // c.beqz / c.bnez
+        },
+
+        else => {},
+    }
+
+    return null;
+}
+
 // ============================================================================
 // PSEUDO-INSTRUCTION EXPANSION
 // ============================================================================
@@ -474,6 +770,13 @@ fn expandPseudo(tokens: *[8][]const u8, count: usize) usize {
 // ============================================================================
 // Pass 1: Scan for labels, record their addresses (PC values)
 // Pass 2: Encode each instruction into 32-bit machine code
+//
+// With compression, instructions are 2 or 4 bytes long, and whether a
+// branch or jump fits in 16 bits depends on where its label ends up. To
+// settle that without iterating, the decision is made against the
+// uncompressed layout: compressing can only bring a label closer, so an
+// offset that fits there still fits afterwards. A second label pass then
+// lays the code out with the chosen sizes.
 // ============================================================================
 
 const AssemblerError = error{
@@ -481,15 +784,81 @@ const AssemblerError = error{
     NotEnoughOperands,
     InvalidRegister,
     InvalidImmediate,
+    InvalidCsr,
     OutOfMemory,
 };
 
-fn assemble(source: []const u8, allocator: std.mem.Allocator) ![]u32 {
+// Splits a line into its label (if any) and instruction tokens, with
+// pseudo-instructions expanded. Returns the instruction's token count,
+// 0 for a line without one.
+fn parseLine(line: []const u8, tokens: *[8][]const u8, label: *?[]const u8) usize {
+    label.* = null;
+    var count = tokenizeLine(line, tokens);
+    if (count == 0) return 0;
+
+    // Check if the first token is a label (ends with ':'). If there's an
+    // instruction after it on the same line, shift tokens left.
+    if (tokens[0].len > 0 and tokens[0][tokens[0].len - 1] == ':') {
+        label.* = tokens[0][0 .. tokens[0].len - 1];
+        for (1..count) |j| {
+            tokens[j - 1] = tokens[j];
+        }
+        count -= 1;
+        if (count == 0) return 0; // Label-only line, no instruction
+    }
+
+    // Expand pseudo-instructions (nop, mv, li, j, ret)
+    return expandPseudo(tokens, count);
+}
+
+// A label used as a plain value (e.g. "li x5, table") isn't the same
+// number in the compressed layout, so those lines always stay 32-bit.
+fn usesLabelValue(
+    info: InsnInfo,
+    tokens: [8][]const u8,
+    token_count: usize,
+    labels: *const std.StringHashMap(u32),
+) bool {
+    if (info.format == .B or info.format == .J) return false;
+    for (tokens[1..token_count]) |token| {
+        if (labels.contains(token)) return true;
+    }
+    return false;
+}
+
+// Whether an instruction gets its 16-bit form, judged in the uncompressed
+// layout (wide_labels, wide_pc)
+fn shouldCompress(
+    info: InsnInfo,
+    tokens: [8][]const u8,
+    token_count: usize,
+    wide_labels: *const std.StringHashMap(u32),
+    wide_pc: u32,
+) !bool {
+    if (usesLabelValue(info, tokens, token_count, wide_labels)) return false;
+    const code = try encodeInstruction(info, tokens, token_count, wide_labels, wide_pc);
+    return compressInstruction(code) != null;
+}
+
+fn lookupOrFail(name: []const u8, pc: u32) !InsnInfo {
+    return lookupInsn(name) orelse {
+        std.debug.print("error: unknown instruction '{s}' at PC=0x{x:0>8}\n", .{ name, pc });
+        return AssemblerError.UnknownInstruction;
+    };
+}
+
+// With a listing buffer, every instruction (and label) line is also
+// written there after its address and encoding, so PCs reported by the
+// simulations can be matched back to the source.
+fn assemble(
+    source: []const u8,
+    allocator: std.mem.Allocator,
+    compress: bool,
+    listing: ?*std.ArrayList(u8),
+) ![]u32 {
     var labels = std.StringHashMap(u32).init(allocator);
     defer labels.deinit();
 
-    var output = std.ArrayList(u32).init(allocator);
-
     // ---- PASS 1: Collect labels ----
     // Walk every line. If a line has "label:", record that label's PC.
     // PC increments by 4 for each real instruction (not labels, not blank lines).
@@ -498,78 +867,101 @@ fn assemble(source: []const u8, allocator: std.mem.Allocator) ![]u32 {
         var lines = std.mem.splitScalar(u8, source, '\n');
         while (lines.next()) |line| {
             var tokens: [8][]const u8 = undefined;
-            var count = tokenizeLine(line, &tokens);
-            if (count == 0) continue;
-
-            // Check if the first token is a label (ends with ':')
-            if (tokens[0].len > 0 and tokens[0][tokens[0].len - 1] == ':') {
-                const label_name = tokens[0][0 .. tokens[0].len - 1];
-                try labels.put(label_name, pc);
-
-                // If there's an instruction after the label on the same line,
-                // shift tokens left and process it
-                if (count > 1) {
-                    for (1..count) |j| {
-                        tokens[j - 1] = tokens[j];
-                    }
-                    count -= 1;
-                } else {
-                    continue; // Label-only line, no instruction
-                }
-            }
+            var label: ?[]const u8 = null;
+            const count = parseLine(line, &tokens, &label);
+            if (label) |name| try labels.put(name, pc);
 
             // This line has an instruction, so advance PC by 4 bytes
-            pc += 4;
+            if (count > 0) pc += 4;
         }
     }
 
-    // ---- PASS 2: Encode instructions ----
-    {
+    // Labels in the uncompressed layout, for the compression decisions
+    var wide_labels = try labels.clone();
+    defer wide_labels.deinit();
+
+    // ---- PASS 1b (compressing): Collect labels again with real sizes ----
+    if (compress) {
         var pc: u32 = 0;
+        var wide_pc: u32 = 0;
         var lines = std.mem.splitScalar(u8, source, '\n');
         while (lines.next()) |line| {
             var tokens: [8][]const u8 = undefined;
-            var count = tokenizeLine(line, &tokens);
+            var label: ?[]const u8 = null;
+            const count = parseLine(line, &tokens, &label);
+            if (label) |name| try labels.put(name, pc);
             if (count == 0) continue;
 
-            // Skip label prefix if present
-            if (tokens[0].len > 0 and tokens[0][tokens[0].len - 1] == ':') {
-                if (count > 1) {
-                    for (1..count) |j| {
-                        tokens[j - 1] = tokens[j];
-                    }
-                    count -= 1;
-                } else {
-                    continue;
+            const info = try lookupOrFail(tokens[0], pc);
+            pc += if (try shouldCompress(info, tokens, count, &wide_labels, wide_pc)) 2 else 4;
+            wide_pc += 4;
+        }
+    }
+
+    // ---- PASS 2: Encode instructions ----
+    // Instructions go out as halfwords, low half first, and are packed
+    // into 32-bit words at the end
+    var halves = std.ArrayList(u16).init(allocator);
+    defer halves.deinit();
+    {
+        var pc: u32 = 0;
+        var wide_pc: u32 = 0;
+        var lines = std.mem.splitScalar(u8, source, '\n');
+        while (lines.next()) |line| {
+            var tokens: [8][]const u8 = undefined;
+            var label: ?[]const u8 = null;
+            const count = parseLine(line, &tokens, &label);
+            const text = std.mem.trim(u8, line, " \t\r");
+            if (count == 0) {
+                if (listing) |out| {
+                    if (label != null) try out.writer().print("{x:0>8}            {s}\n", .{ pc, text });
                 }
+                continue;
             }
 
-            // Expand pseudo-instructions (nop, mv, li, j, ret)
-            count = expandPseudo(&tokens, count);
-
             // Look up the instruction in our table
-            const info = lookupInsn(tokens[0]) orelse {
-                std.debug.print("error: unknown instruction '{s}' at PC=0x{x:0>8}\n", .{ tokens[0], pc });
-                return AssemblerError.UnknownInstruction;
-            };
+            const info = try lookupOrFail(tokens[0], pc);
 
             // Encode it!
             const machine_code = try encodeInstruction(info, tokens, count, &labels, pc);
-            try output.append(machine_code);
-            pc += 4;
+            if (compress and try shouldCompress(info, tokens, count, &wide_labels, wide_pc)) {
+                const half = compressInstruction(machine_code) orelse return AssemblerError.InvalidImmediate;
+                try halves.append(half);
+                if (listing) |out| try out.writer().print("{x:0>8}      {x:0>4}  {s}\n", .{ pc, half, text });
+                pc += 2;
+            } else {
+                try halves.append(@truncate(machine_code));
+                try halves.append(@truncate(machine_code >> 16));
+                if (listing) |out| try out.writer().print("{x:0>8}  {x:0>8}  {s}\n", .{ pc, machine_code, text });
+                pc += 4;
+            }
+            wide_pc += 4;
         }
     }
 
+    // An odd halfword at the end is padded with c.nop
+    if (halves.items.len % 2 != 0) try halves.append(0x0001);
+
+    var output = std.ArrayList(u32).init(allocator);
+    var i: usize = 0;
+    while (i < halves.items.len) : (i += 2) {
+        try output.append(@as(u32, halves.items[i + 1]) << 16 | halves.items[i]);
+    }
+
     return output.toOwnedSlice();
 }
 
 // ============================================================================
 // MAIN — CLI ENTRY POINT
 // ============================================================================
-// Usage: riscv-asm input.asm [-o output.hex]
+// Usage: riscv-asm input.asm [-c] [-l] [-o output.hex]
 //
 // Reads the .asm file, assembles it, and writes a .hex file that your
-// CPU's instruction_memory.sv can load with $readmemh.
+// CPU's instruction_memory.sv can load with $readmemh. -c emits 16-bit
+// compressed instructions wherever possible (the pipelined CPU runs them).
+// -l also writes a listing (output.lst): address, encoding and source
+// line for each instruction, to read the testbenches' per-PC profiles
+// against.
 // ============================================================================
 
 pub fn main() !void {
@@ -583,14 +975,23 @@ pub fn main() !void {
 
     if (args.len < 2) {
         std.debug.print("RISC-V RV32I Assembler\n", .{});
-        std.debug.print("Usage: riscv-asm <input.asm> [-o output.hex]\n\n", .{});
+        std.debug.print("Usage: riscv-asm <input.asm> [-c] [-l] [-o output.hex]\n\n", .{});
         std.debug.print("Assembles RISC-V assembly into hex machine code.\n", .{});
         std.debug.print("Output format is compatible with $readmemh (Verilog).\n", .{});
+        std.debug.print("  -c  use compressed (RV32C) instructions where possible\n", .{});
+        std.debug.print("  -l  also write a listing (.lst) next to the output\n", .{});
         std.process.exit(1);
     }
 
     const input_path = args[1];
 
+    var compress = false;
+    var list = false;
+    for (args[2..]) |arg| {
+        if (std.mem.eql(u8, arg, "-c")) compress = true;
+        if (std.mem.eql(u8, arg, "-l")) list = true;
+    }
+
     // Determine output path: use -o flag if provided, otherwise replace .asm with .hex
     var output_path: []const u8 = undefined;
     var custom_output = false;
@@ -620,7 +1021,9 @@ pub fn main() !void {
     defer allocator.free(source);
 
     // Assemble!
-    const machine_code = try assemble(source, allocator);
+    var listing = std.ArrayList(u8).init(allocator);
+    defer listing.deinit();
+    const machine_code = try assemble(source, allocator, compress, if (list) &listing else null);
     defer allocator.free(machine_code);
 
     // Write the output .hex file
@@ -638,11 +1041,24 @@ pub fn main() !void {
     }
 
     // Print summary
-    std.debug.print("Assembled {d} instructions: {s} -> {s}\n", .{
+    std.debug.print("Assembled {d} words ({d} bytes): {s} -> {s}\n", .{
         machine_code.len,
+        machine_code.len * 4,
         input_path,
         output_path,
     });
+
+    // Write the listing next to the .hex file
+    if (list) {
+        const base = if (std.mem.endsWith(u8, output_path, ".hex")) output_path[0 .. output_path.len - 4] else output_path;
+        const listing_path = try std.fmt.allocPrint(allocator, "{s}.lst", .{base});
+        defer allocator.free(listing_path);
+        std.fs.cwd().writeFile(.{ .sub_path = listing_path, .data = listing.items }) catch |err| {
+            std.debug.print("error: failed to write listing: {}\n", .{err});
+            std.process.exit(1);
+        };
+        std.debug.print("Listing: {s}\n", .{listing_path});
+    }
 }
 
 // ============================================================================
@@ -689,6 +1105,34 @@ test "encode add x3, x1, x2 = 0x002081b3" {
     try std.testing.expectEqual(@as(u32, 0x002081b3), result);
 }
 
+test "encode Zba/Zbb ops" {
+    var labels = std.StringHashMap(u32).init(std.testing.allocator);
+    defer labels.deinit();
+    const sh2add = [8][]const u8{ "sh2add", "x3", "x1", "x2", "", "", "", "" };
+    try std.testing.expectEqual(@as(u32, 0x2020c1b3), try encodeInstruction(lookupInsn("sh2add").?, sh2add, 4, &labels, 0));
+    const rori = [8][]const u8{ "rori", "x3", "x1", "7", "", "", "", "" };
+    try std.testing.expectEqual(@as(u32, 0x6070d193), try encodeInstruction(lookupInsn("rori").?, rori, 4, &labels, 0));
+    const cpop = [8][]const u8{ "cpop", "x3", "x1", "", "", "", "", "" };
+    try std.testing.expectEqual(@as(u32, 0x60209193), try encodeInstruction(lookupInsn("cpop").?, cpop, 3, &labels, 0));
+    const rev8 = [8][]const u8{ "rev8", "x3", "x1", "", "", "", "", "" };
+    try std.testing.expectEqual(@as(u32, 0x6980d193), try encodeInstruction(lookupInsn("rev8").?, rev8, 3, &labels, 0));
+}
+
+test "encode counter CSR reads" {
+    var labels = std.StringHashMap(u32).init(std.testing.allocator);
+    defer labels.deinit();
+    const info = lookupInsn("csrr").?;
+    const cycle = [8][]const u8{ "csrr", "x1", "cycle", "", "", "", "", "" };
+    try std.testing.expectEqual(@as(u32, 0xc00020f3), try encodeInstruction(info, cycle, 3, &labels, 0));
+    const instreth = [8][]const u8{ "csrr", "x2", "instreth", "", "", "", "", "" };
+    try std.testing.expectEqual(@as(u32, 0xc8202173), try encodeInstruction(info, instreth, 3, &labels, 0));
+    const hpm = [8][]const u8{ "csrr", "x3", "hpmcounter4", "", "", "", "", "" };
+    try std.testing.expectEqual(@as(u32, 0xc04021f3), try encodeInstruction(info, hpm, 3, &labels, 0));
+    const event = [8][]const u8{ "csrr", "x4", "mhpmevent3", "", "", "", "", "" };
+    try std.testing.expectEqual(@as(u32, 0x32302273), try encodeInstruction(info, event, 3, &labels, 0));
+    try std.testing.expectEqual(@as(u12, 0xC03), try parseCsr("0xC03"));
+}
+
 test "full assembly of program_single" {
     const source =
         \\addi x1, x0, 5
@@ -700,7 +1144,7 @@ test "full assembly of program_single" {
         \\nop
         \\nop
     ;
-    const result = try assemble(source, std.testing.allocator);
+    const result = try assemble(source, std.testing.allocator, false, null);
     defer std.testing.allocator.free(result);
 
     // These are the exact values from your program_single.hex
@@ -709,3 +1153,44 @@ test "full assembly of program_single" {
     try std.testing.expectEqual(@as(u32, 0x002081b3), result[2]);
     try std.testing.expectEqual(@as(u32, 0x00000013), result[3]); // nop
 }
+
+test "compress common forms" {
+    try std.testing.expectEqual(@as(?u16, 0x0405), compressInstruction(0x00140413)); // addi x8, x8, 1
+    try std.testing.expectEqual(@as(?u16, 0x4095), compressInstruction(0x00500093)); // li x1, 5
+    try std.testing.expectEqual(@as(?u16, 0x8082), compressInstruction(0x00008067)); // ret
+    try std.testing.expectEqual(@as(?u16, 0x0001), compressInstruction(0x00000013)); // nop
+    try std.testing.expectEqual(@as(?u16, null), compressInstruction(0x002081b3)); // add x3, x1, x2
+}
+
+test "assembly with compression packs halfwords" {
+    const source =
+        \\addi x1, x0, 5
+        \\add  x3, x1, x2
+    ;
+    const result = try assemble(source, std.testing.allocator, true, null);
+    defer std.testing.allocator.free(result);
+
+    // c.li x1, 5 then a 32-bit add split across two words, padded with c.nop
+    try std.testing.expectEqual(@as(usize, 2), result.len);
+    try std.testing.expectEqual(@as(u32, 0x81b34095), result[0]);
+    try std.testing.expectEqual(@as(u32, 0x00010020), result[1]);
+}
+
+test "listing shows each instruction's address and encoding" {
+    const source =
+        \\    addi x1, x0, 5
+        \\loop:
+        \\    add  x3, x1, x2   # not compressible
+    ;
+    var listing = std.ArrayList(u8).init(std.testing.allocator);
+    defer listing.deinit();
+    const result = try assemble(source, std.testing.allocator, true, &listing);
+    defer std.testing.allocator.free(result);
+
+    try std.testing.expectEqualStrings(
+        \\00000000      4095  addi x1, x0, 5
+        \\00000002            loop:
+        \\00000002  002081b3  add  x3, x1, x2   # not compressible
+        \\
+    , listing.items);
+}
@@ -0,0 +1,39 @@
+# program_bitmanip_bench.asm — Hashing/bit-count kernel using Zba and Zbb
+# Fills a 16-word array, then walks it once computing a rotate-xor hash,
+# the total number of set bits and the largest value. Indexing is one
+# sh2add, the rotate one rori, the bit count one cpop and the running
+# maximum one maxu. program_bitmanip_bench_rv32i.asm is the same kernel
+# in plain RV32I: it gets the same results in 532 instructions to this
+# one's 251 (the kernel loop is 9 instructions per word instead of 26-27).
+# Expected: x10 = 0xE382D765 (hash), x11 = 259 (set bits),
+#           x12 = 0xF1BBCDC8 (max)
+addi x6, x0, 0x100     # array base
+addi x7, x0, 16        # n
+lui  x8, 0x9E378
+addi x8, x8, -0x647    # x8 = 0x9E3779B9
+addi x9, x0, 0         # v
+addi x5, x0, 0         # i
+fill:
+    add  x9, x9, x8    # a[i] = (i + 1) * 0x9E3779B9
+    slli x28, x5, 2
+    add  x28, x28, x6
+    sw   x9, 0(x28)
+    addi x5, x5, 1
+    bne  x5, x7, fill
+
+addi x10, x0, 0        # hash
+addi x11, x0, 0        # set bits
+addi x12, x0, 0        # max
+addi x5, x0, 0
+kernel:
+    sh2add x28, x5, x6 # &a[i]
+    lw   x29, 0(x28)
+    rori x10, x10, 27  # hash = rol(hash, 5) ^ a[i]
+    xor  x10, x10, x29
+    cpop x30, x29
+    add  x11, x11, x30
+    maxu x12, x12, x29
+    addi x5, x5, 1
+    bne  x5, x7, kernel
+done:
+    j done
@@ -0,0 +1,63 @@
+# program_bitmanip_bench_rv32i.asm — The program_bitmanip_bench kernel in RV32I
+# Same array, same results, without Zba/Zbb: indexing is slli + add, the
+# rotate is two shifts and an or, the bit count is a 15-instruction SWAR
+# sequence (its masks loaded once, outside the loop), and the running
+# maximum is a branch around a move. 532 instructions in all, against
+# 251 with Zba/Zbb.
+# Expected: x10 = 0xE382D765 (hash), x11 = 259 (set bits),
+#           x12 = 0xF1BBCDC8 (max)
+addi x6, x0, 0x100     # array base
+addi x7, x0, 16        # n
+lui  x8, 0x9E378
+addi x8, x8, -0x647    # x8 = 0x9E3779B9
+addi x9, x0, 0         # v
+addi x5, x0, 0         # i
+fill:
+    add  x9, x9, x8    # a[i] = (i + 1) * 0x9E3779B9
+    slli x28, x5, 2
+    add  x28, x28, x6
+    sw   x9, 0(x28)
+    addi x5, x5, 1
+    bne  x5, x7, fill
+
+lui  x20, 0x55555
+addi x20, x20, 0x555   # 0x55555555
+lui  x21, 0x33333
+addi x21, x21, 0x333   # 0x33333333
+lui  x22, 0x0F0F1
+addi x22, x22, -0xF1   # 0x0F0F0F0F
+addi x10, x0, 0        # hash
+addi x11, x0, 0        # set bits
+addi x12, x0, 0        # max
+addi x5, x0, 0
+kernel:
+    slli x28, x5, 2    # &a[i]
+    add  x28, x28, x6
+    lw   x29, 0(x28)
+    slli x30, x10, 5   # hash = rol(hash, 5) ^ a[i]
+    srli x10, x10, 27
+    or   x10, x10, x30
+    xor  x10, x10, x29
+    srli x30, x29, 1   # bit count: 2-bit sums
+    and  x30, x30, x20
+    sub  x30, x29, x30
+    srli x31, x30, 2   # 4-bit sums
+    and  x31, x31, x21
+    and  x30, x30, x21
+    add  x30, x30, x31
+    srli x31, x30, 4   # 8-bit sums
+    add  x30, x30, x31
+    and  x30, x30, x22
+    srli x31, x30, 8   # add up the bytes
+    add  x30, x30, x31
+    srli x31, x30, 16
+    add  x30, x30, x31
+    andi x30, x30, 0x3F
+    add  x11, x11, x30
+    bgeu x12, x29, no_max
+    add  x12, x29, x0
+no_max:
+    addi x5, x5, 1
+    bne  x5, x7, kernel
+done:
+    j done
@@ -0,0 +1,58 @@
+# program_bitmanip_test.asm — Tests the Zba and Zbb extensions
+# Runs every op once, including the corner cases: clz/ctz of zero, a
+# rotate by zero, a rotate amount taken from the low five bits only, and
+# sign/zero extension of values with the sign bit set. cpop reads the
+# xnor result straight off the bypass.
+# Expected: x3 = 32, x4 = 0x12345678, x9 = 32, x10 = 0x12345858,
+#           x11 = 0x12345A38, x12 = 0x12345DF8, x13 = 0x12345608,
+#           x14 = 0xF4, x15 = 0xFFFFFFFF, x16 = -5, x17 = 0x12345678,
+#           x18 = 0x12345678, x19 = 0xFFFFFFFB, x20 = 0x56781234,
+#           x21 = 0x81234567, x22 = 0x78123456, x23 = 24, x24 = 4,
+#           x25 = 13, x26 = 0xFFFFFFF0, x27 = 0xFFFF80F0, x29 = 0x78563412,
+#           x30 = 0x0000FFFF, x31 = 32, x1 = 0xFFFB
+lui  x5, 0x12345
+addi x5, x5, 0x678     # x5 = 0x12345678
+addi x6, x0, -5        # x6 = 0xFFFFFFFB
+addi x7, x0, 0xF0      # x7 = 0xF0
+addi x8, x0, 4
+lui  x28, 0x8
+addi x28, x28, 0xF0    # x28 = 0x80F0
+
+# Zba: shift-and-add
+sh1add x10, x7, x5     # 0x1E0 + x5
+sh2add x11, x7, x5     # 0x3C0 + x5
+sh3add x12, x7, x5     # 0x780 + x5
+
+# Zbb: logic with a negated operand
+andn x13, x5, x7       # clears bits 4-7
+orn  x14, x7, x6       # 0xF0 | 4
+xnor x15, x5, x5       # all ones
+cpop x3, x15           # 32 (forwarded)
+
+# Zbb: min/max
+min  x16, x5, x6       # -5
+minu x17, x5, x6       # 0x12345678
+max  x18, x5, x6       # 0x12345678
+maxu x19, x5, x6       # 0xFFFFFFFB
+
+# Zbb: rotates
+rol  x20, x5, x7       # by 0xF0 & 31 = 16
+ror  x21, x5, x8       # by 4
+rori x22, x5, 8
+rol  x4, x5, x0        # by 0: unchanged
+
+# Zbb: bit counts
+clz  x23, x7           # 24
+ctz  x24, x7           # 4
+cpop x25, x5           # 13
+clz  x31, x0           # 32
+ctz  x9, x0            # 32
+
+# Zbb: extension and byte ops
+sext.b x26, x28        # 0xF0 -> 0xFFFFFFF0
+sext.h x27, x28        # 0x80F0 -> 0xFFFF80F0
+zext.h x1, x6          # 0xFFFB
+rev8   x29, x5         # 0x78563412
+orc.b  x30, x28        # 0x0000FFFF
+done:
+    j done
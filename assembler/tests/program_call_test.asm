@@ -0,0 +1,18 @@
+# program_call_test.asm — Tests call/return prediction
+# Calls the same function from two call sites, three times each.
+# The BTB alone predicts every return to the last call site it saw;
+# the return address stack gets them right.
+# Expected: x10 = 6, x12 = 42
+addi x10, x0, 0     # x10 = accumulator
+addi x11, x0, 3     # x11 = loop counter
+loop:
+    jal  ra, add_one   # call site 1
+    jal  ra, add_one   # call site 2
+    addi x11, x11, -1
+    bne  x11, x0, loop
+addi x12, x0, 42    # x12 = 42 (reached after loop ends)
+done:
+    j done
+add_one:
+    addi x10, x10, 1
+    ret
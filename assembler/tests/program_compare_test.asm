@@ -0,0 +1,29 @@
+# program_compare_test.asm — Tests every branch condition
+# Each branch that behaves correctly adds 1 to x10. The unsigned
+# compares use -1 (0xFFFFFFFF), which is less than 1 signed but
+# greater than 1 unsigned.
+# Expected: x10 = 6, x12 = 42
+addi x10, x0, 0     # x10 = passed checks
+addi x5, x0, 1      # x5 = 1
+addi x6, x0, -1     # x6 = -1 / 0xFFFFFFFF
+beq  x5, x5, t1
+j    f1
+t1: addi x10, x10, 1
+f1: bne  x5, x6, t2
+j    f2
+t2: addi x10, x10, 1
+f2: blt  x6, x5, t3
+j    f3
+t3: addi x10, x10, 1
+f3: bge  x5, x6, t4
+j    f4
+t4: addi x10, x10, 1
+f4: bltu x5, x6, t5
+j    f5
+t5: addi x10, x10, 1
+f5: bgeu x6, x5, t6
+j    f6
+t6: addi x10, x10, 1
+f6: addi x12, x0, 42
+done:
+    j done
@@ -0,0 +1,54 @@
+# program_compressed_test.asm — Tests the C extension (assemble with -c)
+# Almost everything here has a 16-bit form, so most instructions sit at
+# halfword addresses and the 32-bit ones left over end up split across
+# two words, two of them across a cache line. Covers the register,
+# immediate, stack-pointer and memory forms, c.beqz/c.bnez loops, c.j,
+# a c.jal call with c.jr return, and c.jalr through a register.
+# Expected: x8 = 55, x9 = 0, x10 = 0x12345, x11 = 40, x12 = 0x1F0,
+#           x13 = 21, x14 = 3, x15 = 2, x1 = 0x4E (link of the c.jalr),
+#           x2 = 0x200, x16 = 0x1234, x17 = 0x4E, x18 = 0xE, x19 = 5
+addi x2, x0, 0x100     # sp = 0x100 (32-bit: immediate too big)
+addi x2, x2, 0x100     # c.addi16sp: sp = 0x200
+addi x8, x0, 0         # c.li: sum = 0
+addi x9, x0, 10        # c.li: i = 10
+sum_loop:
+    add  x8, x8, x9    # c.add
+    addi x9, x9, -1    # c.addi
+    bne  x9, x0, sum_loop  # c.bnez: sum = 55
+lui  x10, 0x12         # c.lui: 0x12000
+addi x10, x10, 0x345   # 32-bit (lui + addi pair): 0x12345
+addi x12, x2, 16       # c.addi4spn: x12 = 0x210
+sw   x8, 0(x2)         # c.swsp
+sw   x10, 4(x2)        # c.swsp
+lw   x13, 0(x2)        # c.lwsp: 55
+addi x16, x0, 0x234    # 32-bit at a halfword address, split across a cache line
+sw   x13, 8(x12)       # c.sw
+lw   x11, 8(x12)       # c.lw: 55
+addi x11, x11, -15     # c.addi: 40
+lui  x17, 0x1          # c.lui
+or   x16, x16, x17     # 32-bit (x16 isn't x8-x15): 0x1234
+srli x13, x13, 1       # c.srli: 27
+addi x14, x0, -6       # c.li
+srai x14, x14, 1       # c.srai: -3
+sub  x13, x13, x14     # c.sub: 30
+xor  x14, x14, x13     # c.xor
+andi x14, x14, 3       # c.andi: (-3 ^ 30) & 3 = 3
+addi x15, x0, 1        # c.li
+slli x15, x15, 1       # c.slli: 2
+mv   x12, x2           # c.mv: 0x200
+addi x12, x12, -16     # c.addi: 0x1F0
+jal  x1, func          # c.jal
+addi x13, x13, -9      # runs after the return: 21
+auipc x17, 0           # x17 = this PC
+addi x17, x17, 8       # x17 = target
+jalr x1, x17, 0        # c.jalr: x1 = link (PC + 2)
+target:
+    or   x9, x9, x0    # 32-bit no-op: x9 still 0
+    beq  x9, x0, done  # c.beqz
+    addi x19, x0, 99   # skipped
+func:
+    addi x19, x0, 5    # c.li
+    addi x18, x0, 14   # c.li
+    ret                # c.jr
+done:
+    j done             # c.j
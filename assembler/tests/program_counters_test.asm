@@ -0,0 +1,37 @@
+# program_counters_test.asm — Tests the counter CSRs (csrr)
+# instret counts the instructions before the csrr in program order, on
+# every core: fused pairs count as two, and so do the NOPs and x0 writes
+# the OoO core drops at decode. The cycle and event counts depend on the
+# core, so only their sanity is checked; the tb prints them all.
+# Expected: x10 = 0, x11 = 23 (instret after the loop), x12 = 23,
+#           x13 = 0 (at least one cycle per loop iteration), x14 = 29,
+#           x15 = 34 (three NOPs and an x0 write before it), x16 = 37
+#           (a lui+addi pair before it), x17 = 0 (instreth), x18 = 1,
+#           x19 = 8 (mhpmevent3/10: default events), x20 = 0 (unknown CSR)
+csrr x10, instret      # 0: nothing before it
+csrr x8, cycle
+addi x5, x0, 10
+loop:
+    addi x5, x5, -1
+    bne  x5, x0, loop  # 10 iterations, 20 instructions
+csrr x11, instret      # 23
+csrr x9, cycle
+sub  x12, x11, x10
+sub  x13, x9, x8       # cycles the loop took
+sltiu x13, x13, 10     # 0: the loop took at least 10
+addi x6, x0, 5         # same fetch group as the next csrr
+csrr x14, instret      # 29
+nop
+nop
+nop
+add  x0, x6, x6        # written to x0: dropped like the NOPs
+csrr x15, instret      # 34
+lui  x7, 0x12
+addi x7, x7, 0x345     # fused with the lui
+csrr x16, instret      # 37
+csrr x17, instreth
+csrr x18, mhpmevent3
+csrr x19, mhpmevent10
+csrr x20, 0x7C0
+done:
+    j done
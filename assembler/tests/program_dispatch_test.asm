@@ -0,0 +1,35 @@
+# program_dispatch_test.asm — Interpreter-style dispatch loop
+# An "opcode" in x5 cycles 0,1,2,0,1,2,... and each step jumps through a
+# computed address (jalr) into one of three handlers. The JALR target
+# changes every time, but follows the branch history before it.
+# Expected: x10 = 4, x11 = 4, x12 = 4
+addi x10, x0, 0     # x10 = op0 count
+addi x11, x0, 0     # x11 = op1 count
+addi x12, x0, 0     # x12 = op2 count
+addi x5, x0, 0      # x5 = current op
+addi x6, x0, 12     # x6 = steps remaining
+auipc x7, 0         # x7 = 0x14
+addi x7, x7, 20     # x7 = handler table (0x28)
+dispatch:
+    slli x28, x5, 3    # each handler is 8 bytes
+    add  x28, x28, x7
+    jalr x0, x28, 0    # indirect jump into the handler
+op0:
+    addi x10, x10, 1
+    j next
+op1:
+    addi x11, x11, 1
+    j next
+op2:
+    addi x12, x12, 1
+    j next
+next:
+    addi x5, x5, 1
+    addi x29, x0, 3
+    bne  x5, x29, skip
+    addi x5, x0, 0     # wrap op back to 0
+skip:
+    addi x6, x6, -1
+    bne  x6, x0, dispatch
+done:
+    j done
@@ -0,0 +1,30 @@
+# program_fusion_test.asm — Tests macro-op fusion of instruction pairs
+# lui+addi builds 32-bit constants, auipc+jalr calls a function, and
+# slt/sltu followed by bne/beq on the result close a loop and skip a
+# block. The fused ops still write the compare result to its register.
+# Expected: x7 = 0, x8 = 0, x10 = 0x12345678, x11 = 4095, x12 = 45, x13 = 8
+lui  x10, 0x12345      # x10 = 0x12345000
+addi x10, x10, 0x678   # x10 = 0x12345678 (lui + addi)
+lui  x11, 0x1          # x11 = 0x1000
+addi x11, x11, -1      # x11 = 0xFFF (the low part is sign-extended)
+addi x5, x0, 0         # i = 0
+addi x6, x0, 10        # n = 10
+addi x12, x0, 0        # sum = 0
+loop:
+    add  x12, x12, x5  # sum += i
+    addi x5, x5, 1
+    slt  x7, x5, x6    # x7 = i < n
+    bne  x7, x0, loop  # (slt + bne) sum = 45, x7 = 0
+sltu x8, x6, x5        # x8 = 10 < 10 = 0
+beq  x8, x0, skip      # (sltu + beq) taken
+addi x12, x12, 100     # skipped
+skip:
+auipc x1, 0            # x1 = this PC
+jalr  x1, x1, 16       # (auipc + jalr) call func, x1 = return address
+addi  x13, x13, 1      # x13 = 8
+j done
+func:
+    addi x13, x0, 7    # x13 = 7
+    ret
+done:
+    j done
@@ -0,0 +1,18 @@
+# program_loop_test.asm — Tests loop exit prediction
+# An inner loop with a fixed trip count of 4, run 8 times.
+# Counters mispredict every inner-loop exit; once the loop predictor is
+# confident in the trip count, the exits are predicted too.
+# Expected: x10 = 32, x11 = 0, x12 = 42
+addi x10, x0, 0     # x10 = total inner iterations
+addi x11, x0, 8     # x11 = outer loop counter
+outer:
+    addi x5, x0, 4     # x5 = inner loop counter
+inner:
+    addi x10, x10, 1
+    addi x5, x5, -1
+    bne  x5, x0, inner
+    addi x11, x11, -1
+    bne  x11, x0, outer
+addi x12, x0, 42    # x12 = 42 (reached after both loops end)
+done:
+    j done
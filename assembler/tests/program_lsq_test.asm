@@ -0,0 +1,22 @@
+# program_lsq_test.asm — Tests the OoO load/store queue
+# The first two loads get their data forwarded from older stores.
+# The last store's address comes out of a dependent chain, so the load
+# from the same address runs first, reads the old value and is replayed.
+# Expected: x10 = 5, x11 = 7, x12 = 12, x13 = 9, x14 = 42
+addi x1, x0, 1024   # x1 = data base (0x400)
+addi x5, x0, 5
+sw   x5, 0(x1)      # mem[0x400] = 5
+lw   x10, 0(x1)     # x10 = 5 (forwarded)
+addi x6, x0, 7
+sw   x6, 4(x1)      # mem[0x404] = 7
+lw   x11, 4(x1)     # x11 = 7 (forwarded)
+add  x12, x10, x11  # x12 = 12
+addi x2, x0, 512
+addi x2, x2, 256
+addi x2, x2, 256    # x2 = 1024, three cycles late
+addi x7, x0, 9
+sw   x7, 8(x2)      # mem[0x408] = 9
+lw   x13, 8(x1)     # same address: must see 9
+addi x14, x0, 42    # x14 = 42
+done:
+    j done
@@ -0,0 +1,25 @@
+# program_move_elim_test.asm — Tests move and zero-idiom elimination
+# The Fibonacci loop shuffles its registers with moves every iteration,
+# so shared physical registers are freed and reused many times over. A
+# register freed while another architectural register still maps it
+# would corrupt the result.
+# Expected: x10 = 6765, x11 = 10946, x12 = 7, x13 = 0
+addi x1, x0, 0      # a = 0 (zero idiom)
+addi x2, x0, 1      # b = 1
+addi x5, x0, 20     # loop counter
+loop:
+    add  x3, x1, x2    # t = a + b
+    addi x1, x2, 0     # a = b (move)
+    addi x2, x3, 0     # b = t (move)
+    addi x5, x5, -1
+    bne  x5, x0, loop
+addi x10, x1, 0     # x10 = a = 6765 (move)
+addi x1, x0, 7      # overwrite the source: x10 still holds 6765
+addi x11, x2, 0     # x11 = b = 10946 (move)
+addi x11, x11, 0    # move onto itself
+addi x2, x0, 0      # overwrite with a zero idiom: x11 keeps its value
+addi x12, x0, 0     # x12 = 0 (zero idiom)
+add  x12, x12, x1   # x12 = 7
+add  x13, x2, x0    # x13 = 0 (reads the zero idiom's register 0)
+done:
+    j done
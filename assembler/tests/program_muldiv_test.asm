@@ -0,0 +1,47 @@
+# program_muldiv_test.asm — Tests the M extension (multiply/divide)
+# Covers every op, the divide-by-zero and overflow results, a chain of
+# dependent multiplies, and divides whose operands come from multiplies.
+# Expected: x10 = 3628800 (10!), x11 = 0xFFFFFFFF (7 / 0), x12 = 7 (7 % 0),
+#           x13 = 0x80000000 (-2^31 / -1), x14 = 0 (-2^31 % -1),
+#           x15 = -7 (-43 / 6), x16 = -1 (-43 % 6), x17 = 0xFFFFFFFE (mulh),
+#           x18 = 0xFFFFFFFF (mulhsu), x19 = 1 (mulhu), x20 = 0x2BC8D (divu),
+#           x21 = 0x205 (remu), x22 = 100
+addi x5, x0, 1         # f = 1
+addi x6, x0, 1         # i = 1
+addi x7, x0, 11
+fact:
+    mul  x5, x5, x6    # f *= i (each multiply waits for the last)
+    addi x6, x6, 1
+    bne  x6, x7, fact
+add  x10, x5, x0       # x10 = 10! = 3628800
+
+addi x8, x0, 7
+div  x11, x8, x0       # 7 / 0 = -1
+rem  x12, x8, x0       # 7 % 0 = 7
+lui  x9, 0x80000       # x9 = -2^31
+addi x8, x0, -1
+div  x13, x9, x8       # -2^31 / -1 = -2^31 (overflow)
+rem  x14, x9, x8       # -2^31 % -1 = 0
+addi x8, x0, -43
+addi x9, x0, 6
+div  x15, x8, x9       # -43 / 6 = -7 (rounds toward zero)
+rem  x16, x8, x9       # -43 % 6 = -1 (sign of the dividend)
+
+lui  x8, 0x80000       # x8 = 0x80000000
+addi x9, x0, 4
+mulh   x17, x8, x9     # -2^31 * 4 = -2^33 -> high word 0xFFFFFFFE
+addi x9, x0, 2
+mulhsu x18, x8, x9     # -2^31 * 2 (unsigned) -> high word 0xFFFFFFFF
+mulhu  x19, x8, x9     # 2^31 * 2 -> high word 1
+
+lui  x8, 0x12345       # x8 = 0x12345000
+mul  x9, x0, x0        # x9 = 0
+addi x9, x9, 0x6A7     # x9 = 0x6A7 (1703)
+divu x20, x8, x9       # 0x12345000 / 1703 = 0x2BC8D
+remu x21, x8, x9       # 0x12345000 % 1703 = 0x205
+mul  x22, x20, x9      # multiply back: x22 = x8 - x21
+add  x22, x22, x21
+sub  x22, x22, x8      # x22 = 0
+addi x22, x22, 100     # x22 = 100
+done:
+    j done
@@ -0,0 +1,21 @@
+# program_ooo_branch_test.asm — Tests branches and jumps in the OoO core
+# A counted loop, a call and a return, and a branch that skips a write.
+# The loop exit and the first return mispredict; checkpoint recovery
+# throws away the wrong-path work.
+# Expected: x10 = 55, x11 = 0, x12 = 7, x13 = 0, x14 = 42
+addi x10, x0, 0     # x10 = sum
+addi x11, x0, 10    # x11 = loop counter
+loop:
+    add  x10, x10, x11
+    addi x11, x11, -1
+    bne  x11, x0, loop # x10 = 10 + 9 + ... + 1
+jal  ra, func
+addi x14, x0, 42    # x14 = 42 (reached after the return)
+done:
+    j done
+func:
+    addi x12, x0, 7
+    bge  x12, x0, skip # always taken
+    addi x13, x0, 99   # skipped
+skip:
+    ret
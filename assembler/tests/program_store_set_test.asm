@@ -0,0 +1,22 @@
+# program_store_set_test.asm — Tests memory dependence prediction
+# Each iteration stores through a late address and then loads the same
+# word through an early one. The first load runs too early and replays;
+# after that the store-set predictor makes it wait for the store.
+# Expected: x10 = 4, x12 = 4, x13 = 10, x14 = 42
+addi x1, x0, 1024   # x1 = data base (0x400)
+addi x10, x0, 0     # x10 = value stored
+addi x11, x0, 4     # x11 = loop counter
+addi x13, x0, 0     # x13 = sum of loaded values
+loop:
+    addi x2, x1, 0
+    addi x2, x2, 0
+    addi x2, x2, 0     # x2 = x1, a few cycles late
+    addi x10, x10, 1
+    sw   x10, 0(x2)
+    lw   x12, 0(x1)    # must see the store above
+    add  x13, x13, x12 # x13 = 1 + 2 + 3 + 4
+    addi x11, x11, -1
+    bne  x11, x0, loop
+addi x14, x0, 42    # x14 = 42
+done:
+    j done
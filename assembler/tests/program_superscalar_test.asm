@@ -0,0 +1,28 @@
+# program_superscalar_test.asm — Tests multi-instruction rename groups
+# Neighbouring instructions are renamed in the same cycle. Several of them
+# read a register written just before (RAW), write the same register
+# (WAW) or read the old value of their own destination. Back-to-back
+# memory ops end up in different groups.
+# Expected: x10 = 12, x11 = 7, x12 = 20, x13 = 15, x14 = 42
+addi x1, x0, 5      # x1 = 5
+addi x2, x1, 2      # x2 = 7  (reads x1 from the slot before)
+addi x3, x0, 1      # x3 = 1
+addi x3, x0, 9      # x3 = 9  (same rd as the slot before)
+add  x10, x1, x2    # x10 = 12
+addi x11, x2, 0     # x11 = 7
+addi x4, x0, 3      # x4 = 3
+addi x4, x4, 1      # x4 = 4  (reads the old x4)
+addi x5, x0, 4      # x5 = loop counter
+addi x12, x0, 0     # x12 = sum
+loop:
+    addi x12, x12, 5   # x12 = 5 * 4
+    addi x5, x5, -1
+    bne  x5, x0, loop
+addi x6, x0, 1024   # x6 = data base (0x400)
+sw   x3, 0(x6)      # mem[0x400] = 9
+lw   x7, 0(x6)      # x7 = 9
+add  x13, x7, x4    # x13 = 13
+addi x13, x13, 2    # x13 = 15
+addi x14, x0, 42    # x14 = 42
+done:
+    j done
@@ -1,4 +1,4 @@
-// riscv_ref.zig - RISC-V RV32I Reference Model
+// riscv_ref.zig - RISC-V RV32IMC + Zba/Zbb + Zicntr Reference Model
 // A software implementation of the RISC-V ISA for verification
 
 const std = @import("std");
@@ -10,6 +10,8 @@ pub const RiscvCpu = extern struct {
     mem: [*]u8,
     mem_size: u32,
     halted: bool,
+    cycle: u64, // Counter CSRs: one instruction per cycle, like the single-cycle core
+    instret: u64,
 };
 
 // Opcode definitions
@@ -22,6 +24,11 @@ const OP_LOAD: u7 = 0b0000011;
 const OP_STORE: u7 = 0b0100011;
 const OP_OPIMM: u7 = 0b0010011;
 const OP_OP: u7 = 0b0110011;
+const OP_SYSTEM: u7 = 0b1110011;
+
+// Event each hpmcounter counts, a nibble per counter from hpmcounter3
+// (the RTL's default HPM_EVENTS)
+const HPM_EVENTS: u32 = 0x87654321;
 
 // Sign extend helper
 fn signExtend(value: u32, comptime num_bits: u6) i32 {
@@ -78,8 +85,216 @@ fn writeWord(cpu: *RiscvCpu, addr: u32, value: u32) void {
     ptr.* = value;
 }
 
-// Execute one instruction
-fn executeInstr(cpu: *RiscvCpu, instr: u32) void {
+// M extension (funct7 = 0000001): multiply, divide and remainder.
+// Divide by zero and signed overflow don't trap, they give fixed results.
+fn executeMulDiv(funct3: u3, a: u32, b: u32) u32 {
+    const a_signed: i32 = @bitCast(a);
+    const b_signed: i32 = @bitCast(b);
+    const overflow = a_signed == std.math.minInt(i32) and b_signed == -1;
+
+    return switch (funct3) {
+        0b000 => a *% b, // MUL
+        0b001 => @truncate(@as(u64, @bitCast(@as(i64, a_signed) * @as(i64, b_signed))) >> 32), // MULH
+        0b010 => @truncate(@as(u64, @bitCast(@as(i64, a_signed) * @as(i64, b))) >> 32), // MULHSU
+        0b011 => @truncate((@as(u64, a) * @as(u64, b)) >> 32), // MULHU
+        0b100 => if (b == 0) 0xFFFFFFFF else if (overflow) a else @bitCast(@divTrunc(a_signed, b_signed)), // DIV
+        0b101 => if (b == 0) 0xFFFFFFFF else a / b, // DIVU
+        0b110 => if (b == 0) a else if (overflow) 0 else @bitCast(@rem(a_signed, b_signed)), // REM
+        0b111 => if (b == 0) a else a % b, // REMU
+    };
+}
+
+// Zba/Zbb register-register ops. They share funct3 values with the base
+// ops and are told apart by funct7; returns null for anything else.
+fn executeBitManip(funct7: u7, funct3: u3, a: u32, b: u32) ?u32 {
+    const a_signed: i32 = @bitCast(a);
+    const b_signed: i32 = @bitCast(b);
+    const shamt: u5 = @truncate(b);
+
+    return switch (funct7) {
+        0b0010000 => switch (funct3) {
+            0b010 => (a << 1) +% b, // SH1ADD
+            0b100 => (a << 2) +% b, // SH2ADD
+            0b110 => (a << 3) +% b, // SH3ADD
+            else => null,
+        },
+        0b0100000 => switch (funct3) {
+            0b100 => ~(a ^ b), // XNOR
+            0b110 => a | ~b, // ORN
+            0b111 => a & ~b, // ANDN
+            else => null,
+        },
+        0b0000101 => switch (funct3) {
+            0b100 => @as(u32, @bitCast(@min(a_signed, b_signed))), // MIN
+            0b101 => @min(a, b), // MINU
+            0b110 => @as(u32, @bitCast(@max(a_signed, b_signed))), // MAX
+            0b111 => @max(a, b), // MAXU
+            else => null,
+        },
+        0b0110000 => switch (funct3) {
+            0b001 => std.math.rotl(u32, a, shamt), // ROL
+            0b101 => std.math.rotr(u32, a, shamt), // ROR
+            else => null,
+        },
+        0b0000100 => if (funct3 == 0b100) a & 0xFFFF else null, // ZEXT.H
+        else => null,
+    };
+}
+
+// Zbb ops in the OP-IMM space: the unary ops (the rs2 field picks the
+// op), RORI, REV8 and ORC.B. Returns null for the base I-type ops.
+fn executeBitManipImm(imm: u12, funct3: u3, a: u32) ?u32 {
+    const funct7 = imm >> 5;
+    const shamt: u5 = @truncate(imm);
+
+    if (funct3 == 0b001 and funct7 == 0b0110000) {
+        return switch (shamt) {
+            0b00000 => @clz(a), // CLZ
+            0b00001 => @ctz(a), // CTZ
+            0b00010 => @popCount(a), // CPOP
+            0b00100 => @as(u32, @bitCast(@as(i32, @as(i8, @bitCast(@as(u8, @truncate(a))))))), // SEXT.B
+            0b00101 => @as(u32, @bitCast(@as(i32, @as(i16, @bitCast(@as(u16, @truncate(a))))))), // SEXT.H
+            else => null,
+        };
+    }
+    if (funct3 == 0b101) {
+        if (funct7 == 0b0110000) return std.math.rotr(u32, a, shamt); // RORI
+        if (imm == 0x698) return @byteSwap(a); // REV8
+        if (imm == 0x287) { // ORC.B
+            var result: u32 = 0;
+            inline for (0..4) |i| {
+                if ((a >> (i * 8)) & 0xFF != 0) result |= @as(u32, 0xFF) << (i * 8);
+            }
+            return result;
+        }
+    }
+    return null;
+}
+
+// Counter CSRs (Zicntr/Zihpm), read-only. Nothing here raises hardware
+// events, so the hpmcounters stay at zero, like the single-cycle core's.
+fn readCsr(cpu: *RiscvCpu, csr: u12) u32 {
+    const index: u5 = @truncate(csr);
+    const value: u64 = switch (index) {
+        0, 1 => cpu.cycle, // cycle, time
+        2 => cpu.instret,
+        else => 0,
+    };
+    return switch (csr >> 5) {
+        0b1100000, 0b1011000 => if (csr == 0xB01) 0 else @truncate(value), // cycle.., mcycle..
+        0b1100100, 0b1011100 => if (csr == 0xB81) 0 else @truncate(value >> 32), // Upper halves
+        0b0011001 => if (index >= 3 and index < 11) // mhpmevent3-10
+            (HPM_EVENTS >> (@as(u5, index - 3) * 4)) & 0xF
+        else
+            0,
+        else => 0,
+    };
+}
+
+// Instruction encoders, for expanding compressed instructions
+fn encodeR(funct7: u32, rs2: u32, rs1: u32, funct3: u32, rd: u32, opcode: u32) u32 {
+    return funct7 << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+fn encodeI(imm: u32, rs1: u32, funct3: u32, rd: u32, opcode: u32) u32 {
+    return (imm & 0xFFF) << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+fn encodeS(imm: u32, rs2: u32, rs1: u32) u32 {
+    return ((imm >> 5) & 0x7F) << 25 | rs2 << 20 | rs1 << 15 | 0b010 << 12 |
+        (imm & 0x1F) << 7 | OP_STORE;
+}
+
+fn encodeB(imm: u32, rs1: u32, funct3: u32) u32 {
+    return ((imm >> 12) & 0x1) << 31 | ((imm >> 5) & 0x3F) << 25 | rs1 << 15 |
+        funct3 << 12 | ((imm >> 1) & 0xF) << 8 | ((imm >> 11) & 0x1) << 7 | OP_BRANCH;
+}
+
+fn encodeJ(imm: u32, rd: u32) u32 {
+    return ((imm >> 20) & 0x1) << 31 | ((imm >> 1) & 0x3FF) << 21 | ((imm >> 11) & 0x1) << 20 |
+        ((imm >> 12) & 0xFF) << 12 | rd << 7 | OP_JAL;
+}
+
+// C extension: every 16-bit instruction is shorthand for a 32-bit one, so
+// it's expanded and executed as that. Encodings with no RV32 integer
+// equivalent (F/D loads and stores, RV64 ops, reserved) expand to 0,
+// which halts like any other unknown instruction. rd'/rs1'/rs2' are 3-bit
+// register fields naming x8-x15.
+fn expandCompressed(c: u32) u32 {
+    const quadrant = bits(c, 1, 0);
+    const funct3 = bits(c, 15, 13);
+    const rd = bits(c, 11, 7);
+    const rs2 = bits(c, 6, 2);
+    const rd_p = 8 + bits(c, 9, 7);
+    const rs2_p = 8 + bits(c, 4, 2);
+    const shamt = bits(c, 6, 2);
+
+    const imm6: u32 = @bitCast(signExtend(bits(c, 12, 12) << 5 | bits(c, 6, 2), 6));
+    const imm_addi4spn = bits(c, 10, 7) << 6 | bits(c, 12, 11) << 4 | bits(c, 5, 5) << 3 | bits(c, 6, 6) << 2;
+    const imm_addi16sp: u32 = @bitCast(signExtend(bits(c, 12, 12) << 9 | bits(c, 4, 3) << 7 |
+        bits(c, 5, 5) << 6 | bits(c, 2, 2) << 5 | bits(c, 6, 6) << 4, 10));
+    const imm_lw = bits(c, 5, 5) << 6 | bits(c, 12, 10) << 3 | bits(c, 6, 6) << 2;
+    const imm_lwsp = bits(c, 3, 2) << 6 | bits(c, 12, 12) << 5 | bits(c, 6, 4) << 2;
+    const imm_swsp = bits(c, 8, 7) << 6 | bits(c, 12, 9) << 2;
+    const imm_j: u32 = @bitCast(signExtend(bits(c, 12, 12) << 11 | bits(c, 8, 8) << 10 |
+        bits(c, 10, 9) << 8 | bits(c, 6, 6) << 7 | bits(c, 7, 7) << 6 | bits(c, 2, 2) << 5 |
+        bits(c, 11, 11) << 4 | bits(c, 5, 3) << 1, 12));
+    const imm_b: u32 = @bitCast(signExtend(bits(c, 12, 12) << 8 | bits(c, 6, 5) << 6 |
+        bits(c, 2, 2) << 5 | bits(c, 11, 10) << 3 | bits(c, 4, 3) << 1, 9));
+
+    return switch (quadrant) {
+        0b00 => switch (funct3) {
+            0b000 => if (imm_addi4spn != 0) encodeI(imm_addi4spn, 2, 0b000, rs2_p, OP_OPIMM) else 0, // C.ADDI4SPN
+            0b010 => encodeI(imm_lw, rd_p, 0b010, rs2_p, OP_LOAD), // C.LW
+            0b110 => encodeS(imm_lw, rs2_p, rd_p), // C.SW
+            else => 0,
+        },
+        0b01 => switch (funct3) {
+            0b000 => encodeI(imm6, rd, 0b000, rd, OP_OPIMM), // C.ADDI (C.NOP)
+            0b001 => encodeJ(imm_j, 1), // C.JAL
+            0b010 => encodeI(imm6, 0, 0b000, rd, OP_OPIMM), // C.LI
+            0b011 => if (rd == 2)
+                (if (imm_addi16sp != 0) encodeI(imm_addi16sp, 2, 0b000, 2, OP_OPIMM) else 0) // C.ADDI16SP
+            else if (imm6 != 0)
+                (imm6 & 0xFFFFF) << 12 | rd << 7 | OP_LUI // C.LUI
+            else
+                0,
+            0b100 => switch (bits(c, 11, 10)) {
+                0b00 => if (bits(c, 12, 12) == 0) encodeR(0b0000000, shamt, rd_p, 0b101, rd_p, OP_OPIMM) else 0, // C.SRLI
+                0b01 => if (bits(c, 12, 12) == 0) encodeR(0b0100000, shamt, rd_p, 0b101, rd_p, OP_OPIMM) else 0, // C.SRAI
+                0b10 => encodeI(imm6, rd_p, 0b111, rd_p, OP_OPIMM), // C.ANDI
+                else => if (bits(c, 12, 12) != 0) 0 else switch (bits(c, 6, 5)) {
+                    0b00 => encodeR(0b0100000, rs2_p, rd_p, 0b000, rd_p, OP_OP), // C.SUB
+                    0b01 => encodeR(0b0000000, rs2_p, rd_p, 0b100, rd_p, OP_OP), // C.XOR
+                    0b10 => encodeR(0b0000000, rs2_p, rd_p, 0b110, rd_p, OP_OP), // C.OR
+                    else => encodeR(0b0000000, rs2_p, rd_p, 0b111, rd_p, OP_OP), // C.AND
+                },
+            },
+            0b101 => encodeJ(imm_j, 0), // C.J
+            0b110 => encodeB(imm_b, rd_p, 0b000), // C.BEQZ
+            else => encodeB(imm_b, rd_p, 0b001), // C.BNEZ
+        },
+        0b10 => switch (funct3) {
+            0b000 => if (bits(c, 12, 12) == 0) encodeR(0b0000000, shamt, rd, 0b001, rd, OP_OPIMM) else 0, // C.SLLI
+            0b010 => if (rd != 0) encodeI(imm_lwsp, 2, 0b010, rd, OP_LOAD) else 0, // C.LWSP
+            0b100 => if (bits(c, 12, 12) == 0)
+                (if (rs2 == 0)
+                    (if (rd != 0) encodeI(0, rd, 0b000, 0, OP_JALR) else 0) // C.JR
+                else
+                    encodeR(0b0000000, rs2, 0, 0b000, rd, OP_OP)) // C.MV
+            else if (rs2 == 0)
+                (if (rd != 0) encodeI(0, rd, 0b000, 1, OP_JALR) else 0x00100073) // C.JALR / C.EBREAK
+            else
+                encodeR(0b0000000, rs2, rd, 0b000, rd, OP_OP), // C.ADD
+            0b110 => encodeS(imm_swsp, rs2, 2), // C.SWSP
+            else => 0,
+        },
+        else => c, // Not compressed
+    };
+}
+
+// Execute one instruction, length bytes long (2 if it was compressed)
+fn executeInstr(cpu: *RiscvCpu, instr: u32, length: u32) void {
     const opcode: u7 = @truncate(bits(instr, 6, 0));
     const rd: u5 = @truncate(bits(instr, 11, 7));
     const funct3: u3 = @truncate(bits(instr, 14, 12));
@@ -93,7 +308,7 @@ fn executeInstr(cpu: *RiscvCpu, instr: u32) void {
     const rs1_signed: i32 = @bitCast(rs1_val);
     const rs2_signed: i32 = @bitCast(rs2_val);
 
-    var next_pc: u32 = cpu.pc + 4;
+    var next_pc: u32 = cpu.pc + length;
     var rd_val: ?u32 = null;
 
     switch (opcode) {
@@ -106,12 +321,12 @@ fn executeInstr(cpu: *RiscvCpu, instr: u32) void {
         },
 
         OP_JAL => {
-            rd_val = cpu.pc + 4;
+            rd_val = cpu.pc + length;
             next_pc = @bitCast(@as(i32, @bitCast(cpu.pc)) +% decodeImmJ(instr));
         },
 
         OP_JALR => {
-            rd_val = cpu.pc + 4;
+            rd_val = cpu.pc + length;
             next_pc = @bitCast((rs1_signed +% decodeImmI(instr)) & ~@as(i32, 1));
         },
 
@@ -152,7 +367,7 @@ fn executeInstr(cpu: *RiscvCpu, instr: u32) void {
             const imm_u: u32 = @bitCast(imm);
             const shamt: u5 = @truncate(imm_u);
 
-            rd_val = switch (funct3) {
+            rd_val = executeBitManipImm(@truncate(imm_u), funct3, rs1_val) orelse switch (funct3) {
                 0b000 => @bitCast(rs1_signed +% imm), // ADDI
                 0b010 => if (rs1_signed < imm) @as(u32, 1) else @as(u32, 0), // SLTI
                 0b011 => if (rs1_val < imm_u) @as(u32, 1) else @as(u32, 0), // SLTIU
@@ -170,7 +385,9 @@ fn executeInstr(cpu: *RiscvCpu, instr: u32) void {
         OP_OP => {
             const shamt: u5 = @truncate(rs2_val);
 
-            rd_val = switch (funct3) {
+            rd_val = if (funct7 == 0b0000001)
+                executeMulDiv(funct3, rs1_val, rs2_val)
+            else executeBitManip(funct7, funct3, rs1_val, rs2_val) orelse switch (funct3) {
                 0b000 => if (funct7 & 0x20 != 0)
                     @bitCast(rs1_signed -% rs2_signed) // SUB
                 else
@@ -188,6 +405,16 @@ fn executeInstr(cpu: *RiscvCpu, instr: u32) void {
             };
         },
 
+        OP_SYSTEM => {
+            // csrrw/csrrs/csrrc(i) only read: the counters are read-only.
+            // ecall/ebreak (funct3 = 0) halt.
+            if (funct3 != 0) {
+                rd_val = readCsr(cpu, @truncate(bits(instr, 31, 20)));
+            } else {
+                cpu.halted = true;
+            }
+        },
+
         else => {
             // Unknown opcode - halt
             cpu.halted = true;
@@ -211,6 +438,8 @@ export fn riscv_init(cpu: *RiscvCpu, mem: [*]u8, mem_size: u32) void {
     cpu.mem = mem;
     cpu.mem_size = mem_size;
     cpu.halted = false;
+    cpu.cycle = 0;
+    cpu.instret = 0;
     for (&cpu.regs) |*r| {
         r.* = 0;
     }
@@ -218,8 +447,16 @@ export fn riscv_init(cpu: *RiscvCpu, mem: [*]u8, mem_size: u32) void {
 
 export fn riscv_step(cpu: *RiscvCpu) void {
     if (cpu.halted) return;
+    // The low two bits of a 32-bit instruction are always 11; anything else
+    // is a compressed instruction in the low halfword
     const instr = readWord(cpu, cpu.pc);
-    executeInstr(cpu, instr);
+    if ((instr & 0x3) != 0x3) {
+        executeInstr(cpu, expandCompressed(instr & 0xFFFF), 2);
+    } else {
+        executeInstr(cpu, instr, 4);
+    }
+    cpu.cycle += 1;
+    cpu.instret += 1;
 }
 
 export fn riscv_get_pc(cpu: *RiscvCpu) u32 {
@@ -244,6 +481,10 @@ export fn riscv_load_program(cpu: *RiscvCpu, program: [*]const u8, size: u32) vo
     }
 }
 
+export fn riscv_get_csr(cpu: *RiscvCpu, csr: u32) u32 {
+    return readCsr(cpu, @truncate(csr));
+}
+
 export fn riscv_is_halted(cpu: *RiscvCpu) bool {
     return cpu.halted;
 }
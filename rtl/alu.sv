@@ -1,38 +1,110 @@
 // alu.sv - Arithmetic Logic Unit
+//
+// Besides the RV32I operations, the ALU implements the Zba address
+// generation ops (shift-and-add) and the Zbb basic bit manipulation ops:
+// logic with a negated operand, min/max, rotates, bit counts, sign/zero
+// extension and byte ops. The unary ops (CLZ through ORC.B) only use a.
 
 module alu (
     input  logic [31:0] a,          // First operand
     input  logic [31:0] b,          // Second operand
-    input  logic [3:0]  alu_op,     // Operation to perform
+    input  logic [4:0]  alu_op,     // Operation to perform
     output logic [31:0] result,     // Result
     output logic        zero        // 1 if result is zero (for branches)
 );
 
     // ALU operation codes
-    localparam ALU_ADD  = 4'b0000;
-    localparam ALU_SUB  = 4'b0001;
-    localparam ALU_AND  = 4'b0010;
-    localparam ALU_OR   = 4'b0011;
-    localparam ALU_XOR  = 4'b0100;
-    localparam ALU_SLT  = 4'b0101;  // Set less than (signed)
-    localparam ALU_SLTU = 4'b0110;  // Set less than (unsigned)
-    localparam ALU_SLL  = 4'b0111;  // Shift left logical
-    localparam ALU_SRL  = 4'b1000;  // Shift right logical
-    localparam ALU_SRA  = 4'b1001;  // Shift right arithmetic
+    localparam ALU_ADD    = 5'b00000;
+    localparam ALU_SUB    = 5'b00001;
+    localparam ALU_AND    = 5'b00010;
+    localparam ALU_OR     = 5'b00011;
+    localparam ALU_XOR    = 5'b00100;
+    localparam ALU_SLT    = 5'b00101;  // Set less than (signed)
+    localparam ALU_SLTU   = 5'b00110;  // Set less than (unsigned)
+    localparam ALU_SLL    = 5'b00111;  // Shift left logical
+    localparam ALU_SRL    = 5'b01000;  // Shift right logical
+    localparam ALU_SRA    = 5'b01001;  // Shift right arithmetic
+    // Zba
+    localparam ALU_SH1ADD = 5'b01010;  // (a << 1) + b
+    localparam ALU_SH2ADD = 5'b01011;  // (a << 2) + b
+    localparam ALU_SH3ADD = 5'b01100;  // (a << 3) + b
+    // Zbb
+    localparam ALU_ANDN   = 5'b01101;  // a & ~b
+    localparam ALU_ORN    = 5'b01110;  // a | ~b
+    localparam ALU_XNOR   = 5'b01111;  // ~(a ^ b)
+    localparam ALU_MIN    = 5'b10000;
+    localparam ALU_MAX    = 5'b10001;
+    localparam ALU_MINU   = 5'b10010;
+    localparam ALU_MAXU   = 5'b10011;
+    localparam ALU_ROL    = 5'b10100;  // Rotate left
+    localparam ALU_ROR    = 5'b10101;  // Rotate right
+    localparam ALU_CLZ    = 5'b10110;  // Count leading zeros
+    localparam ALU_CTZ    = 5'b10111;  // Count trailing zeros
+    localparam ALU_CPOP   = 5'b11000;  // Count set bits
+    localparam ALU_SEXTB  = 5'b11001;  // Sign-extend byte
+    localparam ALU_SEXTH  = 5'b11010;  // Sign-extend halfword
+    localparam ALU_ZEXTH  = 5'b11011;  // Zero-extend halfword
+    localparam ALU_REV8   = 5'b11100;  // Reverse byte order
+    localparam ALU_ORCB   = 5'b11101;  // Each byte: 0xFF if nonzero, else 0x00
+
+    // Bit counts (32 when a is zero)
+    logic [5:0] lead_zeros;
+    logic [5:0] trail_zeros;
+    logic [5:0] pop_count;
+
+    always_comb begin
+        lead_zeros  = 6'd32;
+        trail_zeros = 6'd32;
+        pop_count   = 6'd0;
+        for (int i = 0; i < 32; i++) begin
+            if (a[i])
+                lead_zeros = 6'd31 - i[5:0];
+            if (a[31 - i])
+                trail_zeros = 6'd31 - i[5:0];
+            pop_count = pop_count + {5'd0, a[i]};
+        end
+    end
+
+    // Rotate amount and its complement (a shift by 32 gives zero)
+    logic [4:0] rot;
+    logic [5:0] rot_back;
+
+    assign rot      = b[4:0];
+    assign rot_back = 6'd32 - {1'b0, rot};
 
     always_comb begin
         case (alu_op)
-            ALU_ADD:  result = a + b;
-            ALU_SUB:  result = a - b;
-            ALU_AND:  result = a & b;
-            ALU_OR:   result = a | b;
-            ALU_XOR:  result = a ^ b;
-            ALU_SLT:  result = ($signed(a) < $signed(b)) ? 32'd1 : 32'd0;
-            ALU_SLTU: result = (a < b) ? 32'd1 : 32'd0;
-            ALU_SLL:  result = a << b[4:0];
-            ALU_SRL:  result = a >> b[4:0];
-            ALU_SRA:  result = $signed(a) >>> b[4:0];
-            default:  result = 32'd0;
+            ALU_ADD:    result = a + b;
+            ALU_SUB:    result = a - b;
+            ALU_AND:    result = a & b;
+            ALU_OR:     result = a | b;
+            ALU_XOR:    result = a ^ b;
+            ALU_SLT:    result = ($signed(a) < $signed(b)) ? 32'd1 : 32'd0;
+            ALU_SLTU:   result = (a < b) ? 32'd1 : 32'd0;
+            ALU_SLL:    result = a << b[4:0];
+            ALU_SRL:    result = a >> b[4:0];
+            ALU_SRA:    result = $signed(a) >>> b[4:0];
+            ALU_SH1ADD: result = {a[30:0], 1'b0} + b;
+            ALU_SH2ADD: result = {a[29:0], 2'b0} + b;
+            ALU_SH3ADD: result = {a[28:0], 3'b0} + b;
+            ALU_ANDN:   result = a & ~b;
+            ALU_ORN:    result = a | ~b;
+            ALU_XNOR:   result = ~(a ^ b);
+            ALU_MIN:    result = ($signed(a) < $signed(b)) ? a : b;
+            ALU_MAX:    result = ($signed(a) < $signed(b)) ? b : a;
+            ALU_MINU:   result = (a < b) ? a : b;
+            ALU_MAXU:   result = (a < b) ? b : a;
+            ALU_ROL:    result = (a << rot) | (a >> rot_back);
+            ALU_ROR:    result = (a >> rot) | (a << rot_back);
+            ALU_CLZ:    result = {26'd0, lead_zeros};
+            ALU_CTZ:    result = {26'd0, trail_zeros};
+            ALU_CPOP:   result = {26'd0, pop_count};
+            ALU_SEXTB:  result = {{24{a[7]}}, a[7:0]};
+            ALU_SEXTH:  result = {{16{a[15]}}, a[15:0]};
+            ALU_ZEXTH:  result = {16'd0, a[15:0]};
+            ALU_REV8:   result = {a[7:0], a[15:8], a[23:16], a[31:24]};
+            ALU_ORCB:   result = {{8{|a[31:24]}}, {8{|a[23:16]}}, {8{|a[15:8]}}, {8{|a[7:0]}}};
+            default:    result = 32'd0;
         endcase
     end
 
@@ -1,6 +1,11 @@
-// branch_predictor.sv - 2-bit saturating counter branch predictor
+// branch_predictor.sv - Dynamic branch direction predictor
 //
-// How it works:
+// Three flavours, selected with the PREDICTOR parameter:
+//   0 = bimodal:    table of 2-bit counters indexed by PC
+//   1 = gshare:     table of 2-bit counters indexed by PC XOR global history
+//   2 = tournament: bimodal + gshare, with a per-PC chooser picking one
+//
+// How the 2-bit counters work:
 // - Each branch gets a 2-bit counter that tracks its history
 // - Counter values: 00 = strongly not taken
 //                   01 = weakly not taken
@@ -12,9 +17,26 @@
 // This is called "saturating" because it doesn't wrap around:
 // - 11 + 1 stays at 11 (not 00)
 // - 00 - 1 stays at 00 (not 11)
+//
+// Global history register (GHR):
+// - Shift register of recent branch outcomes (1 = taken)
+// - Lets gshare learn branches whose outcome depends on earlier branches
+// - Updated speculatively at predict time with the predicted direction,
+//   so back-to-back branches see each other in the history. What goes in
+//   is the direction fetch actually followed (predict_final), which can
+//   differ from predict_taken when another predictor overrides it
+// - predict_history hands out the GHR used for each prediction. The CPU
+//   carries it down the pipeline and passes it back on update. On a
+//   misprediction the GHR is rebuilt from that checkpoint plus the actual
+//   outcome, throwing away the wrong-path history.
+// - Only conditional branches go into the history. When something else
+//   redirects fetch (IF's predecode, a mispredicted jump), the GHR is
+//   simply restored to that instruction's checkpoint.
 
 module branch_predictor #(
-    parameter INDEX_BITS = 6  // 2^6 = 64 entries in the table
+    parameter INDEX_BITS   = 6,  // 2^6 = 64 entries in each table
+    parameter HISTORY_BITS = 6,  // Global history length (max 32)
+    parameter PREDICTOR    = 0   // 0 = bimodal, 1 = gshare, 2 = tournament
 )(
     input  logic        clk,
     input  logic        rst,
@@ -22,54 +44,136 @@ module branch_predictor #(
     // Prediction interface (IF stage)
     input  logic [31:0] pc_if,           // PC to predict for
     output logic        predict_taken,   // Prediction: 1=taken, 0=not taken
+    input  logic        predict_en,      // Known branch leaving IF: shift prediction into GHR
+    input  logic        predict_final,   // Direction fetch followed (after any override)
+    output logic [31:0] predict_history, // GHR used for this prediction (checkpoint)
 
     // Update interface (when branch resolves in MEM/WB stage)
     input  logic        update_en,       // Update the predictor
     input  logic [31:0] update_pc,       // PC of the branch being updated
-    input  logic        actual_taken     // What actually happened
+    input  logic        actual_taken,    // What actually happened
+    input  logic [31:0] update_history,  // GHR checkpoint captured at predict time
+    input  logic        mispredict,      // Branch was mispredicted: repair the GHR
+
+    // Redirect by something other than a conditional branch (predecode, a
+    // mispredicted jump): roll the GHR back to that instruction's checkpoint
+    input  logic        restore_en,
+    input  logic [31:0] restore_history,
+
+    // Statistics
+    output logic [31:0] stat_branches,   // Branches resolved
+    output logic [31:0] stat_mispredicts // Branches mispredicted
 );
 
-    // Pattern History Table (PHT) - array of 2-bit counters
-    logic [1:0] pht [0:(1 << INDEX_BITS)-1];
+    localparam NUM_ENTRIES = (1 << INDEX_BITS);
+    localparam [31:0] HISTORY_MASK = (HISTORY_BITS >= 32) ? 32'hFFFFFFFF :
+                                     ((32'd1 << HISTORY_BITS) - 32'd1);
+
+    // Pattern History Tables - arrays of 2-bit counters
+    logic [1:0] pht        [0:NUM_ENTRIES-1];  // Bimodal (PC-indexed)
+    logic [1:0] gshare_pht [0:NUM_ENTRIES-1];  // Gshare (PC XOR history)
+    logic [1:0] choice     [0:NUM_ENTRIES-1];  // Tournament chooser (>= 2 means use gshare)
 
-    // Index into the table using lower bits of PC
+    // Global history register (only the low HISTORY_BITS are used)
+    logic [31:0] ghr;
+    logic [31:0] predict_hist_masked;
+    logic [31:0] update_hist_masked;
+
+    assign predict_hist_masked = ghr & HISTORY_MASK;
+    assign update_hist_masked  = update_history & HISTORY_MASK;
+    assign predict_history     = ghr;
+
+    // Index into the tables using lower bits of PC
     // We skip the bottom 2 bits since instructions are 4-byte aligned
     logic [INDEX_BITS-1:0] predict_index;
     logic [INDEX_BITS-1:0] update_index;
+    logic [INDEX_BITS-1:0] predict_gindex;
+    logic [INDEX_BITS-1:0] update_gindex;
 
-    assign predict_index = pc_if[INDEX_BITS+1:2];
-    assign update_index = update_pc[INDEX_BITS+1:2];
+    assign predict_index  = pc_if[INDEX_BITS+1:2];
+    assign update_index   = update_pc[INDEX_BITS+1:2];
+    assign predict_gindex = pc_if[INDEX_BITS+1:2] ^ predict_hist_masked[INDEX_BITS-1:0];
+    assign update_gindex  = update_pc[INDEX_BITS+1:2] ^ update_hist_masked[INDEX_BITS-1:0];
 
-    // Prediction: taken if counter >= 2 (i.e., top bit is 1)
-    assign predict_taken = pht[predict_index][1];
+    // Component predictions: taken if counter >= 2 (i.e., top bit is 1)
+    logic bimodal_taken;
+    logic gshare_taken;
+    logic use_gshare;
 
-    // Initialize all counters to weakly taken (10)
+    assign bimodal_taken = pht[predict_index][1];
+    assign gshare_taken  = gshare_pht[predict_gindex][1];
+    assign use_gshare    = choice[predict_index][1];
+
+    always_comb begin
+        case (PREDICTOR)
+            1:       predict_taken = gshare_taken;
+            2:       predict_taken = use_gshare ? gshare_taken : bimodal_taken;
+            default: predict_taken = bimodal_taken;
+        endcase
+    end
+
+    // Saturating counter step
+    function automatic logic [1:0] counter_next(input logic [1:0] ctr, input logic up);
+        if (up)
+            counter_next = (ctr == 2'b11) ? ctr : ctr + 2'b01;
+        else
+            counter_next = (ctr == 2'b00) ? ctr : ctr - 2'b01;
+    endfunction
+
+    // What each component would have predicted for the branch being updated
+    // (read from the current tables, used to train the chooser)
+    logic update_bimodal_correct;
+    logic update_gshare_correct;
+
+    assign update_bimodal_correct = (pht[update_index][1] == actual_taken);
+    assign update_gshare_correct  = (gshare_pht[update_gindex][1] == actual_taken);
+
+    // Initialize counters to weakly taken (10), chooser to weakly bimodal (01)
     initial begin
-        for (int i = 0; i < (1 << INDEX_BITS); i++) begin
-            pht[i] = 2'b10;  // Start with "weakly taken"
+        for (int i = 0; i < NUM_ENTRIES; i++) begin
+            pht[i]        = 2'b10;
+            gshare_pht[i] = 2'b10;
+            choice[i]     = 2'b01;
         end
+        ghr = 32'd0;
     end
 
     // Update logic
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
-            // Reset all counters to weakly taken
-            for (int i = 0; i < (1 << INDEX_BITS); i++) begin
-                pht[i] <= 2'b10;
+            for (int i = 0; i < NUM_ENTRIES; i++) begin
+                pht[i]        <= 2'b10;
+                gshare_pht[i] <= 2'b10;
+                choice[i]     <= 2'b01;
             end
-        end else if (update_en) begin
-            // Update the counter based on actual outcome
-            if (actual_taken) begin
-                // Branch was taken - increment counter (saturate at 11)
-                if (pht[update_index] != 2'b11) begin
-                    pht[update_index] <= pht[update_index] + 1;
+            ghr              <= 32'd0;
+            stat_branches    <= 32'd0;
+            stat_mispredicts <= 32'd0;
+        end else begin
+            if (update_en) begin
+                // Train both direction tables on the actual outcome
+                pht[update_index]         <= counter_next(pht[update_index], actual_taken);
+                gshare_pht[update_gindex] <= counter_next(gshare_pht[update_gindex], actual_taken);
+
+                // Chooser only learns when the components disagree
+                if (update_bimodal_correct != update_gshare_correct) begin
+                    choice[update_index] <= counter_next(choice[update_index], update_gshare_correct);
                 end
-            end else begin
-                // Branch was not taken - decrement counter (saturate at 00)
-                if (pht[update_index] != 2'b00) begin
-                    pht[update_index] <= pht[update_index] - 1;
+
+                stat_branches <= stat_branches + 1;
+                if (mispredict) begin
+                    stat_mispredicts <= stat_mispredicts + 1;
                 end
             end
+
+            // History: repair on misprediction, otherwise shift in predictions
+            if (update_en && mispredict) begin
+                ghr <= {update_history[30:0], actual_taken};
+            end else if (restore_en) begin
+                ghr <= restore_history;
+            end else if (predict_en) begin
+                ghr <= {ghr[30:0], predict_final};
+            end
         end
     end
 
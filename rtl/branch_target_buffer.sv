@@ -4,14 +4,47 @@
 // When we predict "taken", we need to know WHERE to jump.
 //
 // Structure:
-// - Indexed by PC (like a cache)
-// - Each entry stores: valid bit, tag (upper PC bits), target address
+// - Set-associative: PC picks a set, any of its WAYS ways can hold the branch
+// - Each entry stores: valid bit, partial tag, compressed target, type, LRU age
 // - On a hit: we know the target address
 // - On a miss: we don't know where to jump (assume not taken)
+//
+// Keeping entries small:
+// - Partial tags: only TAG_BITS of the PC above the set index are kept.
+//   Two PCs can alias; the front end checks the predecoded instruction and
+//   drops a taken prediction for something that isn't a branch.
+// - Compressed targets: an entry keeps the low OFFSET_BITS of the target
+//   word address plus a REGION_BITS pointer into a small shared table of
+//   upper address bits. Branch targets cluster in a few regions of code,
+//   so a handful of region entries covers them. One more bit says the
+//   target is the upper halfword of its word (compressed code). When a new
+//   region evicts one (round-robin), every entry still pointing at the old
+//   one is invalidated, so none decodes to a target in the new region.
+// - Compressed instructions: PC bit 1 is folded into the tag, so the two
+//   halves of a word don't alias each other.
+// - Direct JALs are never stored; IF computes their target from the
+//   instruction bits, so only branches and JALRs use BTB capacity.
+//
+// Storage: 1 + TAG_BITS + OFFSET_BITS + 1 + REGION_BITS + 2 + log2(WAYS)
+// bits per entry, plus (1 + 30 - OFFSET_BITS) per region; with the
+// defaults that's 26 bits per entry against 60 for full tags and targets.
+//
+// Replacement: true LRU within a set. Each way has an age (0 = most
+// recently trained); a new branch goes into an invalid way if there is
+// one, otherwise into the oldest way.
+//
+// The type lets IF treat the instruction correctly before it's decoded:
+//   00 = conditional branch (ask the direction predictor)
+//   01 = jump (always taken)
+//   10 = call (always taken, push return address)
+//   11 = return (always taken, target comes from the return address stack)
 
 module branch_target_buffer #(
-    parameter INDEX_BITS = 6,  // 2^6 = 64 entries
-    parameter TAG_BITS = 24   // Upper bits of PC for matching
+    parameter SET_BITS    = 4,   // 2^4 = 16 sets
+    parameter WAYS        = 4,   // 16 x 4 = 64 entries (power of 2, at least 2)
+    parameter TAG_BITS    = 8,   // Partial tag: PC bits above the set index
+    parameter OFFSET_BITS = 10,  // Target word-address bits kept per entry
+    parameter REGION_BITS = 2    // 2^2 = 4 shared upper-address regions
 )(
     input  logic        clk,
     input  logic        rst,
@@ -20,59 +53,225 @@ module branch_target_buffer #(
     input  logic [31:0] pc_if,           // PC to look up
     output logic        btb_hit,         // Found in BTB
     output logic [31:0] btb_target,      // Target address if hit
+    output logic [1:0]  btb_type,        // Control-flow type if hit
 
     // Update interface (when branch executes)
     input  logic        update_en,       // Update the BTB
     input  logic [31:0] update_pc,       // PC of the branch
     input  logic [31:0] update_target,   // Where the branch goes
-    input  logic        update_is_branch // Is this actually a branch instruction?
+    input  logic        update_is_branch,// Is this actually a branch instruction?
+    input  logic [1:0]  update_type,     // Control-flow type of the branch
+
+    // Invalidate an entry that aliased onto a non-branch (from predecode)
+    input  logic        invalidate_en,
+    input  logic [31:0] invalidate_pc
 );
 
-    localparam NUM_ENTRIES = (1 << INDEX_BITS);
+    localparam NUM_SETS    = (1 << SET_BITS);
+    localparam NUM_ENTRIES = NUM_SETS * WAYS;
+    localparam NUM_REGIONS = (1 << REGION_BITS);
+    localparam WAY_BITS    = $clog2(WAYS);
+    localparam ENTRY_BITS  = SET_BITS + WAY_BITS;
+    localparam HI_BITS     = 30 - OFFSET_BITS;   // Target bits [31:OFFSET_BITS+2]
+
+    // BTB storage - separate arrays instead of struct, entry = {set, way}
+    logic                   valid  [0:NUM_ENTRIES-1];
+    logic [TAG_BITS-1:0]    tags   [0:NUM_ENTRIES-1];
+    logic [OFFSET_BITS-1:0] offsets[0:NUM_ENTRIES-1];
+    logic                   halves [0:NUM_ENTRIES-1];  // Target bit 1
+    logic [REGION_BITS-1:0] regions[0:NUM_ENTRIES-1];
+    logic [1:0]             types  [0:NUM_ENTRIES-1];
+    logic [WAY_BITS-1:0]    ages   [0:NUM_ENTRIES-1];
+
+    // Region table: upper target bits shared by many entries
+    logic                   region_valid[0:NUM_REGIONS-1];
+    logic [HI_BITS-1:0]     region_hi   [0:NUM_REGIONS-1];
+    logic [REGION_BITS-1:0] region_next;  // Round-robin replacement
+
+    // Set and tag extraction
+    // Skip bottom 2 bits (instructions are 4-byte aligned); bit 1 of a
+    // compressed instruction's PC flips the bottom tag bit
+    logic [SET_BITS-1:0] lookup_set;
+    logic [TAG_BITS-1:0] lookup_tag;
+    logic [SET_BITS-1:0] update_set;
+    logic [TAG_BITS-1:0] update_tag;
+    logic [SET_BITS-1:0] inval_set;
+    logic [TAG_BITS-1:0] inval_tag;
+
+    assign lookup_set = pc_if[SET_BITS+1:2];
+    assign lookup_tag = pc_if[SET_BITS+TAG_BITS+1:SET_BITS+2] ^ {{(TAG_BITS-1){1'b0}}, pc_if[1]};
+    assign update_set = update_pc[SET_BITS+1:2];
+    assign update_tag = update_pc[SET_BITS+TAG_BITS+1:SET_BITS+2] ^ {{(TAG_BITS-1){1'b0}}, update_pc[1]};
+    assign inval_set  = invalidate_pc[SET_BITS+1:2];
+    assign inval_tag  = invalidate_pc[SET_BITS+TAG_BITS+1:SET_BITS+2] ^ {{(TAG_BITS-1){1'b0}}, invalidate_pc[1]};
+
+    // Lookup logic (combinational): search every way of the set
+    logic [WAY_BITS-1:0]   lookup_way;
+    logic [ENTRY_BITS-1:0] lookup_entry;
+
+    always_comb begin
+        btb_hit    = 1'b0;
+        lookup_way = '0;
+        for (int w = 0; w < WAYS; w++) begin
+            if (!btb_hit && valid[lookup_set * WAYS + w] &&
+                tags[lookup_set * WAYS + w] == lookup_tag) begin
+                btb_hit    = 1'b1;
+                lookup_way = w;
+            end
+        end
+    end
+
+    assign lookup_entry = {lookup_set, lookup_way};
+    assign btb_target   = {region_hi[regions[lookup_entry]], offsets[lookup_entry],
+                           halves[lookup_entry], 1'b0};
+    assign btb_type     = types[lookup_entry];
+
+    // Update: train the matching way, or replace the invalid/oldest one
+    logic                  update_hit;
+    logic [WAY_BITS-1:0]   update_hit_way;
+    logic                  update_has_free;
+    logic [WAY_BITS-1:0]   update_free_way;
+    logic [WAY_BITS-1:0]   update_lru_way;
+    logic [WAY_BITS-1:0]   update_way;
+    logic [ENTRY_BITS-1:0] update_entry;
+
+    always_comb begin
+        update_hit      = 1'b0;
+        update_hit_way  = '0;
+        update_has_free = 1'b0;
+        update_free_way = '0;
+        update_lru_way  = '0;
+        for (int w = 0; w < WAYS; w++) begin
+            if (!update_hit && valid[update_set * WAYS + w] &&
+                tags[update_set * WAYS + w] == update_tag) begin
+                update_hit     = 1'b1;
+                update_hit_way = w;
+            end
+            if (!update_has_free && !valid[update_set * WAYS + w]) begin
+                update_has_free = 1'b1;
+                update_free_way = w;
+            end
+            if (ages[update_set * WAYS + w] == WAYS - 1) begin
+                update_lru_way = w;
+            end
+        end
+        if (update_hit)
+            update_way = update_hit_way;
+        else if (update_has_free)
+            update_way = update_free_way;
+        else
+            update_way = update_lru_way;
+    end
+
+    assign update_entry = {update_set, update_way};
 
-    // BTB storage - separate arrays instead of struct
-    logic                valid  [0:NUM_ENTRIES-1];
-    logic [TAG_BITS-1:0] tags   [0:NUM_ENTRIES-1];
-    logic [31:0]         targets[0:NUM_ENTRIES-1];
+    // Region of the new target: reuse a matching region or claim the next one
+    logic [HI_BITS-1:0]     update_hi;
+    logic                   region_hit;
+    logic [REGION_BITS-1:0] region_hit_idx;
 
-    // Index and tag extraction
-    // Skip bottom 2 bits (instructions are 4-byte aligned)
-    logic [INDEX_BITS-1:0] lookup_index;
-    logic [TAG_BITS-1:0]   lookup_tag;
-    logic [INDEX_BITS-1:0] update_index;
-    logic [TAG_BITS-1:0]   update_tag;
+    assign update_hi = update_target[31:OFFSET_BITS+2];
 
-    assign lookup_index = pc_if[INDEX_BITS+1:2];
-    assign lookup_tag = pc_if[INDEX_BITS+TAG_BITS+1:INDEX_BITS+2];
-    assign update_index = update_pc[INDEX_BITS+1:2];
-    assign update_tag = update_pc[INDEX_BITS+TAG_BITS+1:INDEX_BITS+2];
+    always_comb begin
+        region_hit     = 1'b0;
+        region_hit_idx = '0;
+        for (int r = 0; r < NUM_REGIONS; r++) begin
+            if (!region_hit && region_valid[r] && region_hi[r] == update_hi) begin
+                region_hit     = 1'b1;
+                region_hit_idx = r;
+            end
+        end
+    end
 
-    // Lookup logic (combinational)
-    assign btb_hit = valid[lookup_index] && (tags[lookup_index] == lookup_tag);
-    assign btb_target = targets[lookup_index];
+    // Invalidate lookup
+    logic                inval_hit;
+    logic [WAY_BITS-1:0] inval_way;
 
-    // Initialize BTB to empty
+    always_comb begin
+        inval_hit = 1'b0;
+        inval_way = '0;
+        for (int w = 0; w < WAYS; w++) begin
+            if (!inval_hit && valid[inval_set * WAYS + w] &&
+                tags[inval_set * WAYS + w] == inval_tag) begin
+                inval_hit = 1'b1;
+                inval_way = w;
+            end
+        end
+    end
+
+    // Initialize BTB to empty, ages to a permutation within each set
     initial begin
         for (int i = 0; i < NUM_ENTRIES; i++) begin
-            valid[i] = 1'b0;
-            tags[i] = '0;
-            targets[i] = 32'd0;
+            valid[i]   = 1'b0;
+            tags[i]    = '0;
+            offsets[i] = '0;
+            regions[i] = '0;
+            types[i]   = 2'b00;
+            ages[i]    = i % WAYS;
+        end
+        for (int r = 0; r < NUM_REGIONS; r++) begin
+            region_valid[r] = 1'b0;
+            region_hi[r]    = '0;
         end
+        region_next = '0;
     end
 
     // Update logic
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
             for (int i = 0; i < NUM_ENTRIES; i++) begin
-                valid[i] <= 1'b0;
-                tags[i] <= '0;
-                targets[i] <= 32'd0;
+                valid[i]   <= 1'b0;
+                tags[i]    <= '0;
+                offsets[i] <= '0;
+                halves[i]  <= 1'b0;
+                regions[i] <= '0;
+                types[i]   <= 2'b00;
+                ages[i]    <= i % WAYS;
+            end
+            for (int r = 0; r < NUM_REGIONS; r++) begin
+                region_valid[r] <= 1'b0;
+                region_hi[r]    <= '0;
+            end
+            region_next <= '0;
+        end else begin
+            if (update_en && update_is_branch) begin
+                // A new region replaces one that live entries may still
+                // point at: drop them (the entry written below stays valid)
+                if (!region_hit) begin
+                    for (int i = 0; i < NUM_ENTRIES; i++) begin
+                        if (regions[i] == region_next)
+                            valid[i] <= 1'b0;
+                    end
+                end
+
+                // Store/update the branch target
+                valid[update_entry]   <= 1'b1;
+                tags[update_entry]    <= update_tag;
+                offsets[update_entry] <= update_target[OFFSET_BITS+1:2];
+                halves[update_entry]  <= update_target[1];
+                types[update_entry]   <= update_type;
+
+                if (region_hit) begin
+                    regions[update_entry] <= region_hit_idx;
+                end else begin
+                    regions[update_entry]     <= region_next;
+                    region_valid[region_next] <= 1'b1;
+                    region_hi[region_next]    <= update_hi;
+                    region_next               <= region_next + 1'b1;
+                end
+
+                // LRU: this way becomes the youngest, younger ones age by one
+                for (int w = 0; w < WAYS; w++) begin
+                    if (w == update_way)
+                        ages[update_set * WAYS + w] <= '0;
+                    else if (ages[update_set * WAYS + w] < ages[update_entry])
+                        ages[update_set * WAYS + w] <= ages[update_set * WAYS + w] + 1'b1;
+                end
+            end
+
+            if (invalidate_en && inval_hit) begin
+                valid[{inval_set, inval_way}] <= 1'b0;
             end
-        end else if (update_en && update_is_branch) begin
-            // Store/update the branch target
-            valid[update_index] <= 1'b1;
-            tags[update_index] <= update_tag;
-            targets[update_index] <= update_target;
         end
     end
 
@@ -15,6 +15,23 @@
 // Parameters:
 //   CACHE_SIZE_BYTES = total cache size
 //   LINE_SIZE_BYTES  = bytes per cache line (block size)
+//
+// Prefetch:
+// - When idle, a line named by prefetch_addr is fetched in the background
+//   if it isn't already cached (the I-cache points this at the fetch
+//   target queue, the D-cache ties it off)
+// - Hits are still served while a prefetch fills; a miss waits for it
+// - Fills write the line named by the latched fill address, not by
+//   whatever cpu_addr is doing in the meantime
+//
+// Write-through:
+// - A write hit latches its address and data and sends them to memory in
+//   the background, so the CPU can move on to other accesses
+//
+// Events (one-cycle pulses for the performance counters):
+// - event_miss: a demand miss starts its fill
+// - event_hit:  an access is served without having missed. The access
+//   that missed is served again once its line is in, which isn't a hit.
 
 module cache #(
     parameter CACHE_SIZE_BYTES = 256,       // 256 bytes total cache
@@ -31,6 +48,12 @@ module cache #(
     input  logic                  cpu_write_en,   // CPU wants to write
     output logic [31:0]           cpu_read_data,  // Data returned to CPU
     output logic                  cpu_stall,      // Stall CPU (cache miss)
+    output logic                  event_hit,      // Access served from the cache
+    output logic                  event_miss,     // Demand miss starting a fill
+
+    // Prefetch hint
+    input  logic                  prefetch_en,
+    input  logic [ADDR_WIDTH-1:0] prefetch_addr,
 
     // Memory interface (for cache misses)
     output logic [ADDR_WIDTH-1:0] mem_addr,       // Address to main memory
@@ -67,6 +90,15 @@ module cache #(
     logic cache_hit;
     assign cache_hit = valid[addr_index] && (tags[addr_index] == addr_tag);
 
+    // Prefetch hit detection
+    logic [TAG_BITS-1:0]           pf_tag;
+    logic [INDEX_BITS-1:0]         pf_index;
+    logic                          pf_hit;
+
+    assign pf_tag   = prefetch_addr[ADDR_WIDTH-1 -: TAG_BITS];
+    assign pf_index = prefetch_addr[OFFSET_BITS +: INDEX_BITS];
+    assign pf_hit   = valid[pf_index] && (tags[pf_index] == pf_tag);
+
     // State machine for handling cache misses
     typedef enum logic [1:0] {
         IDLE,           // Normal operation
@@ -77,20 +109,53 @@ module cache #(
     state_t state, next_state;
     logic [$clog2(WORDS_PER_LINE)-1:0] fetch_word_count;
     logic [ADDR_WIDTH-1:0] fetch_addr;
+    logic                  prefetching;   // Current fill is a prefetch
+    logic [31:0]           wt_data;       // Store data being written through
+
+    // Line being filled (fetch_addr stays inside it for the whole fill)
+    logic [TAG_BITS-1:0]           fill_tag;
+    logic [INDEX_BITS-1:0]         fill_index;
+
+    assign fill_tag   = fetch_addr[ADDR_WIDTH-1 -: TAG_BITS];
+    assign fill_index = fetch_addr[OFFSET_BITS +: INDEX_BITS];
+
+    logic demand_miss;
+    assign demand_miss = (cpu_read_en || cpu_write_en) && !cache_hit;
 
     // Read data output (from cache on hit)
     assign cpu_read_data = data[addr_index][addr_word_offset];
 
-    // Stall CPU when we have a miss and need to fetch
-    assign cpu_stall = (cpu_read_en || cpu_write_en) && !cache_hit && (state == IDLE) ||
-                       (state == FETCH);
+    // Stall CPU when we have a miss and need to fetch. A prefetch fill only
+    // stalls accesses that miss. While a write-through is still going out,
+    // read hits are served but misses and further writes have to wait.
+    assign cpu_stall = demand_miss && (state == IDLE) ||
+                       (state == FETCH) && (!prefetching || demand_miss) ||
+                       (state == WRITE_THROUGH) && (demand_miss || cpu_write_en);
+
+    // Performance events. missed marks the access being waited on, so its
+    // retry after the fill doesn't also count as a hit.
+    logic access_served;
+    logic missed;
+
+    assign access_served = (cpu_read_en || cpu_write_en) && !cpu_stall;
+    assign event_miss    = demand_miss && (state == IDLE);
+    assign event_hit     = access_served && !missed;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst)
+            missed <= 1'b0;
+        else if (event_miss)
+            missed <= 1'b1;
+        else if (access_served)
+            missed <= 1'b0;
+    end
 
     // Memory interface signals
     always_comb begin
         mem_addr = fetch_addr;
         mem_read_en = (state == FETCH);
         mem_write_en = (state == WRITE_THROUGH);
-        mem_write_data = cpu_write_data;
+        mem_write_data = wt_data;
     end
 
     // Initialize cache
@@ -110,34 +175,48 @@ module cache #(
             state <= IDLE;
             fetch_word_count <= '0;
             fetch_addr <= '0;
+            prefetching <= 1'b0;
+            wt_data <= 32'd0;
         end else begin
             case (state)
                 IDLE: begin
-                    if ((cpu_read_en || cpu_write_en) && !cache_hit) begin
+                    if (demand_miss) begin
                         // Cache miss - start fetching the line
                         state <= FETCH;
                         fetch_word_count <= '0;
+                        prefetching <= 1'b0;
                         // Align address to line boundary
                         fetch_addr <= {cpu_addr[ADDR_WIDTH-1:OFFSET_BITS], {OFFSET_BITS{1'b0}}};
+                        // Old contents are about to be overwritten
+                        valid[addr_index] <= 1'b0;
                     end else if (cpu_write_en && cache_hit) begin
                         // Write hit - update cache (write-through)
                         data[addr_index][addr_word_offset] <= cpu_write_data;
                         // Also write to memory
                         state <= WRITE_THROUGH;
                         fetch_addr <= cpu_addr;
+                        wt_data <= cpu_write_data;
+                    end else if (prefetch_en && !pf_hit) begin
+                        // Nothing else to do - fetch the hinted line early
+                        state <= FETCH;
+                        fetch_word_count <= '0;
+                        prefetching <= 1'b1;
+                        fetch_addr <= {prefetch_addr[ADDR_WIDTH-1:OFFSET_BITS], {OFFSET_BITS{1'b0}}};
+                        valid[pf_index] <= 1'b0;
                     end
                 end
 
                 FETCH: begin
                     if (mem_ready) begin
                         // Store the word from memory into cache
-                        data[addr_index][fetch_word_count] <= mem_read_data;
+                        data[fill_index][fetch_word_count] <= mem_read_data;
 
                         if (fetch_word_count == WORDS_PER_LINE - 1) begin
                             // Done fetching entire line
-                            valid[addr_index] <= 1'b1;
-                            tags[addr_index] <= addr_tag;
+                            valid[fill_index] <= 1'b1;
+                            tags[fill_index] <= fill_tag;
                             state <= IDLE;
+                            prefetching <= 1'b0;
                         end else begin
                             fetch_word_count <= fetch_word_count + 1;
                             fetch_addr <= fetch_addr + 4;
@@ -1,17 +1,145 @@
 // cpu_ooo.sv - Out-of-Order RISC-V CPU
 // Implements: Fetch → Decode/Rename/Dispatch → Issue → Execute → Complete → Commit
-// Features: Register renaming, ROB, Issue Queue, in-order commit
+// Features: Register renaming, ROB, Issue Queue, in-order commit,
+//           branch prediction with checkpointed recovery
+//
+// Front end width:
+// - Fetch, decode, rename and dispatch handle a group of up to WIDTH
+//   sequential instructions per cycle. A group ends after a control-flow
+//   instruction and before a second load/store, so each group needs at
+//   most one prediction, one checkpoint and one LSQ entry.
+// - Rename checks dependences inside the group: a slot reading a register
+//   written by an older slot gets that slot's new physical register.
+// - Moves ("addi rd, rs, 0") and zero idioms ("addi rd, x0, 0") are
+//   eliminated at rename: rd is mapped to the source's physical register
+//   (x0's is register 0) and the instruction goes into the ROB already
+//   done, skipping the issue queue and execution ports. The free list
+//   counts how many committed mappings share a register.
+// - Macro-op fusion: lui+addi, auipc+jalr and slt+beq/bne pairs in
+//   neighbouring slots become one op in the second slot (see
+//   macro_fusion.sv), taking one ROB entry, IQ entry and ALU pass.
+// - A group dispatches as a whole; if the free list, ROB, issue queue,
+//   checkpoints or LSQ can't take all of it, it waits.
+//
+// Execution ports:
+// - ISSUE_WIDTH instructions can issue per cycle. Port 0 has the ALU,
+//   the branch comparator and the LSQ address path; the other ports are
+//   ALU-only. Each port has its own register-file read/write ports,
+//   complete register and wakeup bus.
+// - Multiplies and divides (RV32M) issue on the last port, MD_PORT, into
+//   a separate unit: a 3-stage pipelined multiplier (one new multiply per
+//   cycle) and an iterative divider (33 cycles, one divide at a time).
+//   Each has its own complete port and wakeup bus, so a long divide never
+//   holds up the ALUs.
+// - Wakeup is speculative: ALU ops take exactly one cycle, so their
+//   destination is broadcast as they issue. A dependent instruction
+//   issues in the next cycle and gets the value from the bypass network
+//   (the complete registers) before it reaches the register file. Loads
+//   wake their dependents when the LSQ hands over the data, multiplies
+//   and divides when they are one cycle from their result.
+//
+// Retire:
+// - Up to RETIRE_WIDTH finished instructions leave the ROB head per cycle,
+//   each updating the committed RAT and freeing its old register. The LSQ
+//   commits one load/store per cycle, so a second memory op waits for the
+//   next cycle, and a load that has to be replayed stops retirement just
+//   before it.
+//
+// Control flow:
+// - Fetch predecodes each instruction. JAL targets are computed directly;
+//   branches and JALRs are predicted with the direction predictor BP_TYPE
+//   picks + BTB.
+// - Every branch and JALR takes a checkpoint tag at dispatch. The RAT and
+//   free list snapshot their state under that tag.
+// - Branches resolve out of order in execute. On a misprediction (seen in
+//   the complete stage) the RAT and free list restore the branch's
+//   checkpoint, the ROB and issue queue squash only the younger entries,
+//   and fetch restarts at the correct PC, all in the same cycle.
+//
+// Memory:
+// - Loads and stores go into a load/store queue in program order. Their
+//   addresses are computed out of order; loads run speculatively past
+//   older stores with unknown addresses, forwarding from older stores.
+// - Stores write the D-cache only after commit. A D-cache miss only holds
+//   up the LSQ, so independent ALU work keeps issuing meanwhile.
+// - A load that turns out to have read too early is replayed: when it
+//   reaches the ROB head, everything is flushed and fetch restarts there.
+// - A store-set predictor learns from those violations and makes just the
+//   loads that collided before wait for their store's address.
+//
+// Performance counters (see perf_counters.sv):
+// - csrr is read in decode, like LUI: the counter value becomes the
+//   immediate. instret counts what retired before it in program order -
+//   what has committed, what's still in the ROB, and older slots of its
+//   own group.
+// - Decode drops NOPs, writes to x0 and JAL x0 without a ROB entry, so the
+//   next dispatched instruction's entry counts them for it (as a fused
+//   pair's entry counts two). Drops with nothing older in flight count
+//   straight away.
+// - Top-down accounting splits the WIDTH dispatch slots of every cycle
+//   into front end, bad speculation, memory or core back end, and
+//   retiring.
 
-module cpu_ooo (
+module cpu_ooo #(
+    parameter BP_TYPE = 2,  // Direction predictor: 0 = bimodal, 1 = gshare, 2 = tournament, 3 = TAGE
+    parameter [31:0] HPM_EVENTS = 32'h87654321  // Event per hpmcounter
+)(
     input  logic clk,
     input  logic rst
 );
 
     // Parameters
+    localparam WIDTH         = 2;    // Fetch/decode/rename/dispatch group size
+    localparam ISSUE_WIDTH   = 2;    // Execution ports (port 0 + ALU-only ports)
+    localparam MD_PORT       = ISSUE_WIDTH - 1;  // Port feeding the multiply/divide unit
+    localparam COMPLETE_PORTS = ISSUE_WIDTH + 2; // One per port + multiplier + divider
+    localparam WAKEUP_PORTS  = ISSUE_WIDTH + 3;  // One per port + LSQ loads + multiplier + divider
+    localparam RETIRE_WIDTH  = 2;    // Commits per cycle
     localparam PHYS_REG_BITS = 6;
     localparam NUM_PHYS_REGS = 64;
     localparam ROB_IDX_BITS  = 4;
     localparam ROB_SIZE      = 16;
+    localparam NUM_CKPTS     = 4;    // Branches in flight
+    localparam CKPT_BITS     = 2;
+    localparam LSQ_SIZE      = 8;
+    localparam LSQ_IDX_BITS  = 3;
+
+    // Control-flow kinds (what execute has to resolve)
+    localparam logic [1:0] BR_NONE = 2'b00;
+    localparam logic [1:0] BR_COND = 2'b01;  // Conditional branch
+    localparam logic [1:0] BR_JALR = 2'b10;  // Indirect jump
+
+    // Memory operation kinds
+    localparam logic [1:0] MEM_NONE  = 2'b00;
+    localparam logic [1:0] MEM_LOAD  = 2'b01;
+    localparam logic [1:0] MEM_STORE = 2'b10;
+
+    // Functional units
+    localparam logic [1:0] FU_ALU = 2'b00;
+    localparam logic [1:0] FU_MUL = 2'b01;  // Multiplier (MUL/MULH/MULHSU/MULHU)
+    localparam logic [1:0] FU_DIV = 2'b10;  // Divider (DIV/DIVU/REM/REMU)
+
+    // Is ROB index a younger than b? Age is distance from the ROB head.
+    function automatic logic rob_younger(input logic [ROB_IDX_BITS-1:0] a,
+                                         input logic [ROB_IDX_BITS-1:0] b,
+                                         input logic [ROB_IDX_BITS-1:0] head);
+        logic [ROB_IDX_BITS-1:0] age_a;
+        logic [ROB_IDX_BITS-1:0] age_b;
+        age_a = a - head;
+        age_b = b - head;
+        rob_younger = (age_a > age_b);
+    endfunction
+
+    // Branch recovery (driven from the complete stage, used everywhere)
+    logic        recover;          // Mispredicted branch: restore its checkpoint
+    logic        resolve_en;       // A branch/JALR finished executing
+    logic [31:0] resolve_pc;
+    logic [31:0] resolve_history;
+    logic [ROB_IDX_BITS-1:0] rob_head;
+
+    // Memory-order replay (from the ROB head)
+    logic        replay;           // Head load read stale data: flush and refetch
+    logic [31:0] commit_pc_out;
 
     // ========================================================================
     // Ready Table - tracks which physical registers have valid values
@@ -19,22 +147,179 @@ module cpu_ooo (
     logic [NUM_PHYS_REGS-1:0] ready_table;
 
     // ========================================================================
-    // FETCH STAGE
+    // FETCH STAGE - Up to WIDTH sequential instructions per cycle
     // ========================================================================
     logic [31:0] pc;
     logic [31:0] pc_next;
-    logic [31:0] fetch_instruction;
+    logic [WIDTH-1:0][31:0] fetch_instruction;
     logic        fetch_valid;
     logic        frontend_stall;
 
-    // Simple instruction memory (reuse existing module)
-    instruction_memory imem (
-        .addr        (pc),
-        .instruction (fetch_instruction)
+    // Simple instruction memory (reuse existing module), one read port per
+    // slot: slot k reads pc + 4k
+    genvar g;
+    generate
+        for (g = 0; g < WIDTH; g++) begin : fetch_slot
+            instruction_memory imem (
+                .addr        (pc + 4 * g),
+                .instruction (fetch_instruction[g])
+            );
+        end
+    endgenerate
+
+    // Predecode: the instructions arrive in the same cycle as their PC, so
+    // fetch knows exactly which ones are control flow. Only those may use
+    // a BTB hit (a stale entry can't redirect an ALU op).
+    logic [WIDTH-1:0]       f_is_jal;
+    logic [WIDTH-1:0]       f_is_jalr;
+    logic [WIDTH-1:0]       f_is_branch;
+    logic [WIDTH-1:0]       f_is_mem;
+    logic [WIDTH-1:0][31:0] f_jal_target;
+
+    always_comb begin
+        for (int k = 0; k < WIDTH; k++) begin
+            f_is_jal[k]     = (fetch_instruction[k][6:0] == 7'b1101111);
+            f_is_jalr[k]    = (fetch_instruction[k][6:0] == 7'b1100111);
+            f_is_branch[k]  = (fetch_instruction[k][6:0] == 7'b1100011);
+            f_is_mem[k]     = (fetch_instruction[k][6:0] == 7'b0000011) ||
+                              (fetch_instruction[k][6:0] == 7'b0100011);
+            f_jal_target[k] = pc + 4 * k +
+                              {{12{fetch_instruction[k][31]}}, fetch_instruction[k][19:12],
+                               fetch_instruction[k][20], fetch_instruction[k][30:21], 1'b0};
+        end
+    end
+
+    // Group formation. A group ends:
+    // - after its first control-flow instruction (one prediction per cycle,
+    //   so a branch or JALR is always the youngest of its group)
+    // - before a second load/store (one LSQ allocation per cycle)
+    // Slots past the end are fetched again next cycle.
+    logic [WIDTH-1:0] f_slot_valid;
+    logic [31:0]      f_seq_next;      // PC after the group if nothing is taken
+    logic             f_cf_jal;        // The group ends in a JAL...
+    logic             f_cf_jalr;       // ...a JALR...
+    logic             f_cf_branch;     // ...or a conditional branch
+    logic [31:0]      f_cf_pc;
+    logic [31:0]      f_cf_jal_target;
+    logic             f_ended;
+    logic             f_mem_seen;
+
+    always_comb begin
+        f_ended         = 1'b0;
+        f_mem_seen      = 1'b0;
+        f_slot_valid    = '0;
+        f_seq_next      = pc;
+        f_cf_jal        = 1'b0;
+        f_cf_jalr       = 1'b0;
+        f_cf_branch     = 1'b0;
+        f_cf_pc         = pc;
+        f_cf_jal_target = 32'd0;
+
+        for (int k = 0; k < WIDTH; k++) begin
+            if (f_ended || (f_is_mem[k] && f_mem_seen)) begin
+                f_ended = 1'b1;
+            end else begin
+                f_slot_valid[k] = 1'b1;
+                f_seq_next      = pc + 4 * (k + 1);
+                f_mem_seen      = f_mem_seen || f_is_mem[k];
+                if (f_is_jal[k] || f_is_jalr[k] || f_is_branch[k]) begin
+                    f_ended         = 1'b1;
+                    f_cf_jal        = f_is_jal[k];
+                    f_cf_jalr       = f_is_jalr[k];
+                    f_cf_branch     = f_is_branch[k];
+                    f_cf_pc         = pc + 4 * k;
+                    f_cf_jal_target = f_jal_target[k];
+                end
+            end
+        end
+    end
+
+    // Branch prediction (for the group's control-flow instruction)
+    logic        bp_taken;
+    logic [31:0] bp_history;
+    logic        btb_hit;
+    logic [31:0] btb_target;
+    logic [31:0] f_predict_next;   // Predicted next PC
+    logic        fetch_advance;
+    logic [31:0] stat_branches;
+    logic [31:0] stat_mispredicts;
+
+    assign fetch_advance = !frontend_stall && !recover && !replay;
+
+    generate
+        if (BP_TYPE == 3) begin : g_tage
+            tage_predictor bp_inst (
+                .clk             (clk),
+                .rst             (rst),
+                .pc_if           (f_cf_pc),
+                .predict_taken   (bp_taken),
+                .predict_en      (f_cf_branch && btb_hit && fetch_advance),
+                .predict_final   (bp_taken),
+                .predict_history (bp_history),
+                .update_en       (resolve_en && ex_br_kind_r == BR_COND),
+                .update_pc       (resolve_pc),
+                .actual_taken    (ex_taken_r),
+                .update_history  (resolve_history),
+                .mispredict      (recover && ex_br_kind_r == BR_COND),
+                .restore_en      (recover && ex_br_kind_r == BR_JALR),
+                .restore_history (resolve_history),
+                .stat_branches   (stat_branches),
+                .stat_mispredicts(stat_mispredicts)
+            );
+        end else begin : g_counter
+            branch_predictor #(
+                .PREDICTOR(BP_TYPE)
+            ) bp_inst (
+                .clk             (clk),
+                .rst             (rst),
+                .pc_if           (f_cf_pc),
+                .predict_taken   (bp_taken),
+                .predict_en      (f_cf_branch && btb_hit && fetch_advance),
+                .predict_final   (bp_taken),
+                .predict_history (bp_history),
+                .update_en       (resolve_en && ex_br_kind_r == BR_COND),
+                .update_pc       (resolve_pc),
+                .actual_taken    (ex_taken_r),
+                .update_history  (resolve_history),
+                .mispredict      (recover && ex_br_kind_r == BR_COND),
+                .restore_en      (recover && ex_br_kind_r == BR_JALR),
+                .restore_history (resolve_history),
+                .stat_branches   (stat_branches),
+                .stat_mispredicts(stat_mispredicts)
+            );
+        end
+    endgenerate
+
+    branch_target_buffer btb_inst (
+        .clk             (clk),
+        .rst             (rst),
+        .pc_if           (f_cf_pc),
+        .btb_hit         (btb_hit),
+        .btb_target      (btb_target),
+        .btb_type        (),              // Predecode already knows the type
+        .update_en       (resolve_en),
+        .update_pc       (resolve_pc),
+        .update_target   (ex_target_r),
+        .update_is_branch(1'b1),
+        .update_type     (ex_br_kind_r == BR_COND ? 2'b00 : 2'b01),
+        .invalidate_en   (1'b0),
+        .invalidate_pc   (32'd0)
     );
 
-    // PC logic
-    assign pc_next = frontend_stall ? pc : pc + 4;
+    always_comb begin
+        if (f_cf_jal)
+            f_predict_next = f_cf_jal_target;
+        else if (btb_hit && ((f_cf_branch && bp_taken) || f_cf_jalr))
+            f_predict_next = btb_target;
+        else
+            f_predict_next = f_seq_next;
+    end
+
+    // PC logic: replay > recovery > stall > prediction
+    assign pc_next = replay         ? commit_pc_out :
+                     recover        ? ex_next_pc_r :
+                     frontend_stall ? pc :
+                     f_predict_next;
 
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
@@ -47,126 +332,437 @@ module cpu_ooo (
     end
 
     // ========================================================================
-    // FETCH/DECODE Pipeline Register
+    // FETCH/DECODE Pipeline Register (one fetch group)
     // ========================================================================
-    logic [31:0] fd_pc;
-    logic [31:0] fd_instruction;
-    logic        fd_valid;
+    logic [31:0]            fd_pc;            // PC of slot 0
+    logic [WIDTH-1:0][31:0] fd_instruction;
+    logic [WIDTH-1:0]       fd_valid;
+    logic [31:0]            fd_predict_next;  // Where the group goes next
+    logic [31:0]            fd_history;
 
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
-            fd_pc          <= 32'd0;
-            fd_instruction <= 32'h00000013; // NOP
-            fd_valid       <= 1'b0;
+            fd_pc           <= 32'd0;
+            fd_instruction  <= {WIDTH{32'h00000013}}; // NOP
+            fd_valid        <= '0;
+            fd_predict_next <= 32'd0;
+            fd_history      <= 32'd0;
+        end else if (recover || replay) begin
+            fd_instruction  <= {WIDTH{32'h00000013}}; // Wrong path
+            fd_valid        <= '0;
         end else if (!frontend_stall) begin
-            fd_pc          <= pc;
-            fd_instruction <= fetch_instruction;
-            fd_valid       <= 1'b1;
+            fd_pc           <= pc;
+            fd_instruction  <= fetch_instruction;
+            fd_valid        <= f_slot_valid;
+            fd_predict_next <= f_predict_next;
+            fd_history      <= bp_history;
         end
     end
 
     // ========================================================================
-    // DECODE STAGE
+    // DECODE STAGE - One decoder per slot
     // ========================================================================
-    logic [3:0]  dec_alu_op;
-    logic        dec_alu_src;
-    logic        dec_reg_write;
-    logic [31:0] dec_imm;
-    logic [4:0]  dec_rs1, dec_rs2, dec_rd;
-    logic        dec_is_nop;
+    logic [WIDTH-1:0][31:0] dec_pc;
+    logic [WIDTH-1:0][4:0]  dec_alu_op;
+    logic [WIDTH-1:0]       dec_alu_src;
+    logic [WIDTH-1:0]       dec_reg_write;
+    logic [WIDTH-1:0][31:0] dec_imm;
+    logic [WIDTH-1:0][4:0]  dec_rs1, dec_rs2, dec_rd;
+    logic [WIDTH-1:0][2:0]  dec_funct3;
+    logic [WIDTH-1:0]       dec_is_nop;
+    logic [WIDTH-1:0]       dec_no_rs1;     // JAL/LUI/AUIPC: rd = x0 + imm
+    logic [WIDTH-1:0][1:0]  dec_br_kind;
+    logic [WIDTH-1:0][1:0]  dec_mem_op;
+    logic [WIDTH-1:0][1:0]  dec_fu;
+    logic [WIDTH-1:0]       dec_writes_rd;
+    logic [WIDTH-1:0]       dec_elim;       // Move or zero idiom: rename only
+    logic [WIDTH-1:0]       dec_dispatch;
+    logic [WIDTH-1:0][1:0]  dec_fused;      // Slot holds a fused pair (kind)
+    logic [WIDTH-1:0]       dec_fused_away; // Slot was merged into the next one
+    logic [WIDTH-1:0]       dec_dropped;    // Valid, but takes no ROB entry
+    logic [WIDTH-1:0][3:0]  dec_insts;      // Instructions the slot's ROB entry stands for
+    logic [3:0]             group_drops;    // Dropped since the last dispatched slot
+    logic [3:0]             pending_drop;   // ...carried over from earlier groups
+    logic                   drop_stall;     // Too many drops waiting for an entry
+    logic [WIDTH-1:0][31:0] csr_rdata;      // Counter CSR read by each slot
 
-    // Extract fields from instruction
-    assign dec_rs1 = fd_instruction[19:15];
-    assign dec_rs2 = fd_instruction[24:20];
-    assign dec_rd  = fd_instruction[11:7];
+    // Fusion candidates: slot k with slot k + 1 (the last slot has no partner)
+    logic [WIDTH-1:0]        fu_fuse;
+    logic [WIDTH-1:0][1:0]   fu_kind;
+    logic [WIDTH-1:0][4:0]   fu_rs1, fu_rs2, fu_rd;
+    logic [WIDTH-1:0][31:0]  fu_imm;
+    logic [WIDTH-1:0][4:0]   fu_alu_op;
+    logic [WIDTH-1:0]        fu_alu_src;
+    logic [WIDTH-1:0][2:0]   fu_branch_type;
+    logic [WIDTH-1:0]        fu_pair_fuse;
 
-    // Decode logic (R-type and I-type ALU only for now)
+    generate
+        for (g = 0; g < WIDTH; g++) begin : fuse_slot
+            macro_fusion fusion (
+                .first      (fd_instruction[g]),
+                .second     (fd_instruction[(g + 1) % WIDTH]),
+                .first_pc   (fd_pc + 4 * g),
+                .fuse       (fu_pair_fuse[g]),
+                .kind       (fu_kind[g]),
+                .rs1        (fu_rs1[g]),
+                .rs2        (fu_rs2[g]),
+                .rd         (fu_rd[g]),
+                .imm        (fu_imm[g]),
+                .alu_op     (fu_alu_op[g]),
+                .alu_src    (fu_alu_src[g]),
+                .branch_type(fu_branch_type[g])
+            );
+
+            assign fu_fuse[g] = (g < WIDTH - 1) && fu_pair_fuse[g] &&
+                                fd_valid[g] && fd_valid[(g + 1) % WIDTH];
+        end
+    endgenerate
+
+    // Decode logic (ALU ops, loads/stores, branches and jumps)
     always_comb begin
-        dec_alu_op    = 4'd0;   // ADD
-        dec_alu_src   = 1'b0;   // Register
-        dec_reg_write = 1'b0;
-        dec_imm       = 32'd0;
-        dec_is_nop    = 1'b0;
-
-        case (fd_instruction[6:0])
-            7'b0110011: begin // R-type
-                dec_reg_write = 1'b1;
-                dec_alu_src   = 1'b0;
-                case (fd_instruction[14:12])
-                    3'b000: dec_alu_op = fd_instruction[30] ? 4'd1 : 4'd0; // SUB/ADD
-                    3'b001: dec_alu_op = 4'd7;  // SLL
-                    3'b010: dec_alu_op = 4'd5;  // SLT
-                    3'b011: dec_alu_op = 4'd6;  // SLTU
-                    3'b100: dec_alu_op = 4'd4;  // XOR
-                    3'b101: dec_alu_op = fd_instruction[30] ? 4'd9 : 4'd8; // SRA/SRL
-                    3'b110: dec_alu_op = 4'd3;  // OR
-                    3'b111: dec_alu_op = 4'd2;  // AND
-                endcase
-            end
+        for (int k = 0; k < WIDTH; k++) begin
+            dec_pc[k]        = fd_pc + 4 * k;
+            dec_alu_op[k]    = 5'd0;   // ADD
+            dec_alu_src[k]   = 1'b0;   // Register
+            dec_reg_write[k] = 1'b0;
+            dec_imm[k]       = 32'd0;
+            dec_is_nop[k]    = 1'b0;
+            dec_no_rs1[k]    = 1'b0;
+            dec_br_kind[k]   = BR_NONE;
+            dec_mem_op[k]    = MEM_NONE;
+            dec_fu[k]        = FU_ALU;
 
-            7'b0010011: begin // I-type ALU
-                dec_reg_write = 1'b1;
-                dec_alu_src   = 1'b1;
-                dec_imm       = {{20{fd_instruction[31]}}, fd_instruction[31:20]};
-                case (fd_instruction[14:12])
-                    3'b000: dec_alu_op = 4'd0;  // ADDI
-                    3'b001: dec_alu_op = 4'd7;  // SLLI
-                    3'b010: dec_alu_op = 4'd5;  // SLTI
-                    3'b011: dec_alu_op = 4'd6;  // SLTIU
-                    3'b100: dec_alu_op = 4'd4;  // XORI
-                    3'b101: dec_alu_op = fd_instruction[30] ? 4'd9 : 4'd8; // SRAI/SRLI
-                    3'b110: dec_alu_op = 4'd3;  // ORI
-                    3'b111: dec_alu_op = 4'd2;  // ANDI
-                endcase
-            end
+            case (fd_instruction[k][6:0])
+                7'b0110011: begin // R-type (funct7 = 1: M extension, funct3 picks the op)
+                    dec_reg_write[k] = 1'b1;
+                    dec_alu_src[k]   = 1'b0;
+                    if (fd_instruction[k][31:25] == 7'b0000001)
+                        dec_fu[k] = fd_instruction[k][14] ? FU_DIV : FU_MUL;
+                    case (fd_instruction[k][14:12])
+                        3'b000: dec_alu_op[k] = fd_instruction[k][30] ? 5'd1 : 5'd0; // SUB/ADD
+                        3'b001: dec_alu_op[k] = 5'd7;  // SLL
+                        3'b010: dec_alu_op[k] = 5'd5;  // SLT
+                        3'b011: dec_alu_op[k] = 5'd6;  // SLTU
+                        3'b100: dec_alu_op[k] = 5'd4;  // XOR
+                        3'b101: dec_alu_op[k] = fd_instruction[k][30] ? 5'd9 : 5'd8; // SRA/SRL
+                        3'b110: dec_alu_op[k] = 5'd3;  // OR
+                        3'b111: dec_alu_op[k] = 5'd2;  // AND
+                    endcase
+
+                    // Zba/Zbb: same funct3 slots, told apart by funct7
+                    case ({fd_instruction[k][31:25], fd_instruction[k][14:12]})
+                        {7'b0010000, 3'b010}: dec_alu_op[k] = 5'd10; // SH1ADD
+                        {7'b0010000, 3'b100}: dec_alu_op[k] = 5'd11; // SH2ADD
+                        {7'b0010000, 3'b110}: dec_alu_op[k] = 5'd12; // SH3ADD
+                        {7'b0100000, 3'b111}: dec_alu_op[k] = 5'd13; // ANDN
+                        {7'b0100000, 3'b110}: dec_alu_op[k] = 5'd14; // ORN
+                        {7'b0100000, 3'b100}: dec_alu_op[k] = 5'd15; // XNOR
+                        {7'b0000101, 3'b100}: dec_alu_op[k] = 5'd16; // MIN
+                        {7'b0000101, 3'b110}: dec_alu_op[k] = 5'd17; // MAX
+                        {7'b0000101, 3'b101}: dec_alu_op[k] = 5'd18; // MINU
+                        {7'b0000101, 3'b111}: dec_alu_op[k] = 5'd19; // MAXU
+                        {7'b0110000, 3'b001}: dec_alu_op[k] = 5'd20; // ROL
+                        {7'b0110000, 3'b101}: dec_alu_op[k] = 5'd21; // ROR
+                        {7'b0000100, 3'b100}: dec_alu_op[k] = 5'd27; // ZEXT.H
+                        default: ;
+                    endcase
+                end
+
+                7'b0010011: begin // I-type ALU
+                    dec_reg_write[k] = 1'b1;
+                    dec_alu_src[k]   = 1'b1;
+                    dec_imm[k]       = {{20{fd_instruction[k][31]}}, fd_instruction[k][31:20]};
+                    case (fd_instruction[k][14:12])
+                        3'b000: dec_alu_op[k] = 5'd0;  // ADDI
+                        3'b001: dec_alu_op[k] = 5'd7;  // SLLI
+                        3'b010: dec_alu_op[k] = 5'd5;  // SLTI
+                        3'b011: dec_alu_op[k] = 5'd6;  // SLTIU
+                        3'b100: dec_alu_op[k] = 5'd4;  // XORI
+                        3'b101: dec_alu_op[k] = fd_instruction[k][30] ? 5'd9 : 5'd8; // SRAI/SRLI
+                        3'b110: dec_alu_op[k] = 5'd3;  // ORI
+                        3'b111: dec_alu_op[k] = 5'd2;  // ANDI
+                    endcase
 
-            default: begin
-                dec_is_nop = 1'b1; // Treat unknown as NOP
+                    // Zbb: unary ops (rs2 field picks the op), RORI, REV8, ORC.B
+                    case ({fd_instruction[k][31:20], fd_instruction[k][14:12]})
+                        {12'h600, 3'b001}: dec_alu_op[k] = 5'd22; // CLZ
+                        {12'h601, 3'b001}: dec_alu_op[k] = 5'd23; // CTZ
+                        {12'h602, 3'b001}: dec_alu_op[k] = 5'd24; // CPOP
+                        {12'h604, 3'b001}: dec_alu_op[k] = 5'd25; // SEXT.B
+                        {12'h605, 3'b001}: dec_alu_op[k] = 5'd26; // SEXT.H
+                        {12'h698, 3'b101}: dec_alu_op[k] = 5'd28; // REV8
+                        {12'h287, 3'b101}: dec_alu_op[k] = 5'd29; // ORC.B
+                        default:
+                            if (fd_instruction[k][31:25] == 7'b0110000 &&
+                                fd_instruction[k][14:12] == 3'b101)
+                                dec_alu_op[k] = 5'd21;            // RORI
+                    endcase
+                end
+
+                7'b0000011: begin // Load: ALU computes rs1 + imm, the LSQ does the rest
+                    dec_mem_op[k]    = MEM_LOAD;
+                    dec_reg_write[k] = 1'b1;
+                    dec_alu_src[k]   = 1'b1;
+                    dec_imm[k]       = {{20{fd_instruction[k][31]}}, fd_instruction[k][31:20]};
+                end
+
+                7'b0100011: begin // Store: address rs1 + imm, data rs2, written after commit
+                    dec_mem_op[k]    = MEM_STORE;
+                    dec_alu_src[k]   = 1'b1;
+                    dec_imm[k]       = {{20{fd_instruction[k][31]}}, fd_instruction[k][31:25],
+                                        fd_instruction[k][11:7]};
+                end
+
+                7'b1100011: begin // Branch: compare rs1/rs2, target = PC + imm
+                    dec_br_kind[k]   = BR_COND;
+                    dec_imm[k]       = {{20{fd_instruction[k][31]}}, fd_instruction[k][7],
+                                        fd_instruction[k][30:25], fd_instruction[k][11:8], 1'b0};
+                end
+
+                7'b1101111: begin // JAL: fetch already jumped, rd = x0 + (PC + 4)
+                    dec_no_rs1[k]    = 1'b1;
+                    dec_reg_write[k] = 1'b1;
+                    dec_alu_src[k]   = 1'b1;
+                    dec_imm[k]       = dec_pc[k] + 32'd4;
+                end
+
+                7'b0110111: begin // LUI: rd = x0 + imm
+                    dec_no_rs1[k]    = 1'b1;
+                    dec_reg_write[k] = 1'b1;
+                    dec_alu_src[k]   = 1'b1;
+                    dec_imm[k]       = {fd_instruction[k][31:12], 12'd0};
+                end
+
+                7'b0010111: begin // AUIPC: rd = x0 + (PC + imm)
+                    dec_no_rs1[k]    = 1'b1;
+                    dec_reg_write[k] = 1'b1;
+                    dec_alu_src[k]   = 1'b1;
+                    dec_imm[k]       = dec_pc[k] + {fd_instruction[k][31:12], 12'd0};
+                end
+
+                7'b1100111: begin // JALR: ALU computes rs1 + imm, rd = PC + 4
+                    dec_br_kind[k]   = BR_JALR;
+                    dec_reg_write[k] = 1'b1;
+                    dec_alu_src[k]   = 1'b1;
+                    dec_imm[k]       = {{20{fd_instruction[k][31]}}, fd_instruction[k][31:20]};
+                end
+
+                7'b1110011: begin // csrr: rd = x0 + counter (ecall/ebreak are NOPs)
+                    if (fd_instruction[k][14:12] != 3'b000) begin
+                        dec_no_rs1[k]    = 1'b1;
+                        dec_reg_write[k] = 1'b1;
+                        dec_alu_src[k]   = 1'b1;
+                        dec_imm[k]       = csr_rdata[k];
+                    end else begin
+                        dec_is_nop[k] = 1'b1;
+                    end
+                end
+
+                default: begin
+                    dec_is_nop[k] = 1'b1; // Treat unknown as NOP
+                end
+            endcase
+
+            // NOP instruction (ADDI x0, x0, 0)
+            if (fd_instruction[k] == 32'h00000013)
+                dec_is_nop[k] = 1'b1;
+
+            // Extract fields from instruction (JAL, LUI and AUIPC read x0)
+            dec_rs1[k]    = dec_no_rs1[k] ? 5'd0 : fd_instruction[k][19:15];
+            dec_rs2[k]    = fd_instruction[k][24:20];
+            dec_rd[k]     = fd_instruction[k][11:7];
+            dec_funct3[k] = fd_instruction[k][14:12];
+
+            // Anything that writes a register, stores or has to be resolved
+            // goes into the ROB and issue queue (JAL x0 is finished once
+            // fetch has followed it)
+            dec_writes_rd[k] = dec_reg_write[k] && dec_rd[k] != 5'd0;
+
+            // ADDI with a zero immediate just copies rs1 (x0 for a zero idiom)
+            dec_elim[k]      = dec_writes_rd[k] && fd_instruction[k][6:0] == 7'b0010011 &&
+                               dec_funct3[k] == 3'b000 && fd_instruction[k][31:20] == 12'd0;
+            dec_dispatch[k]  = fd_valid[k] && !dec_is_nop[k] &&
+                               (dec_writes_rd[k] || dec_br_kind[k] != BR_NONE ||
+                                dec_mem_op[k] == MEM_STORE);
+            dec_fused[k]      = 2'd0;
+            dec_fused_away[k] = 1'b0;
+        end
+
+        // Macro-op fusion: the pair becomes one op in the younger slot,
+        // which keeps its PC, branch kind and prediction. A slot that
+        // already holds a fused op doesn't fuse again.
+        for (int k = 0; k < WIDTH - 1; k++) begin
+            if (fu_fuse[k] && dec_fused[k] == 2'd0) begin
+                dec_fused_away[k]  = 1'b1;
+                dec_dispatch[k]    = 1'b0;
+                dec_fused[k+1]     = fu_kind[k];
+                dec_rs1[k+1]       = fu_rs1[k];
+                dec_rs2[k+1]       = fu_rs2[k];
+                dec_rd[k+1]        = fu_rd[k];
+                dec_imm[k+1]       = fu_imm[k];
+                dec_alu_op[k+1]    = fu_alu_op[k];
+                dec_alu_src[k+1]   = fu_alu_src[k];
+                dec_funct3[k+1]    = fu_branch_type[k];
+                dec_reg_write[k+1] = 1'b1;
+                dec_writes_rd[k+1] = 1'b1;
+                dec_elim[k+1]      = 1'b0;
+                dec_dispatch[k+1]  = 1'b1;
             end
-        endcase
+        end
+    end
 
-        // NOP instruction (ADDI x0, x0, 0)
-        if (fd_instruction == 32'h00000013)
-            dec_is_nop = 1'b1;
+    // Instruction counts for instret: each dispatched slot's ROB entry
+    // also counts the dropped slots before it. A group with nothing to
+    // dispatch but drops waits once more than DROP_LIMIT are pending (see
+    // drop_stall), which keeps pending_drop at or below DROP_LIMIT + WIDTH
+    // and an entry's count, 1 + fused + pending + the group's older drops,
+    // within its 4 bits.
+    localparam DROP_LIMIT = 14 - 2 * WIDTH;
+
+    always_comb begin
+        group_drops = pending_drop;
+        for (int k = 0; k < WIDTH; k++) begin
+            dec_dropped[k] = fd_valid[k] && !dec_dispatch[k] && !dec_fused_away[k];
+            dec_insts[k]   = 4'd1 + (dec_fused[k] != 2'd0) + group_drops;
+            if (dec_dispatch[k])
+                group_drops = 4'd0;
+            else if (dec_dropped[k])
+                group_drops = group_drops + 1;
+        end
     end
 
     // ========================================================================
     // RENAME STAGE (same cycle as decode)
+    // The whole group renames together. Slots depending on an older slot
+    // of the same group get that slot's new register (see rat.sv).
     // ========================================================================
-    logic [PHYS_REG_BITS-1:0] rename_phys_rs1;
-    logic [PHYS_REG_BITS-1:0] rename_phys_rs2;
-    logic [PHYS_REG_BITS-1:0] rename_phys_rd;
-    logic [PHYS_REG_BITS-1:0] rename_old_phys;
-    logic                     rename_en;
-    logic                     alloc_valid;
+    logic [WIDTH-1:0][PHYS_REG_BITS-1:0] rename_phys_rs1;
+    logic [WIDTH-1:0][PHYS_REG_BITS-1:0] rename_phys_rs2;
+    logic [WIDTH-1:0][PHYS_REG_BITS-1:0] rename_phys_rd;
+    logic [WIDTH-1:0][PHYS_REG_BITS-1:0] rename_old_phys;
+    logic [WIDTH-1:0]                    rename_en;
+    logic [WIDTH-1:0]                    rename_alloc;   // Renamed to a new register
+    logic [WIDTH-1:0]                    iq_dispatch_en;
+    logic                                alloc_valid;
+
+    // The group dispatches all at once or not at all
+    logic                    dispatch_en;
+    logic [WIDTH-1:0]        slot_dispatch;
+    logic                    group_dispatch;   // Something in the group needs a slot
+    logic                    group_writes_rd;
+    logic                    group_has_br;
+    logic                    group_has_mem;
+    logic                    ckpt_alloc_en;
+    logic                    ckpt_free_found;
+    logic [CKPT_BITS-1:0]    ckpt_free_id;
+    logic                    lsq_alloc_en;
+    logic                    lsq_alloc_ready;
+    logic [LSQ_IDX_BITS-1:0] lsq_alloc_idx;
+
+    // The group's branch/JALR (always its youngest slot) and load/store (at
+    // most one, see fetch)
+    logic [ROB_IDX_BITS-1:0]  group_br_rob_idx;
+    logic [31:0]              group_br_pc;
+    logic [1:0]               group_mem_op;
+    logic [ROB_IDX_BITS-1:0]  group_mem_rob_idx;
+    logic [PHYS_REG_BITS-1:0] group_mem_phys_rd;
+    logic [31:0]              group_mem_pc;
+
+    always_comb begin
+        group_dispatch  = 1'b0;
+        group_writes_rd = 1'b0;
+        group_has_br    = 1'b0;
+        group_has_mem   = 1'b0;
+        for (int k = 0; k < WIDTH; k++) begin
+            if (dec_dispatch[k]) begin
+                group_dispatch  = 1'b1;
+                group_writes_rd = group_writes_rd || dec_writes_rd[k];
+                group_has_br    = group_has_br || (dec_br_kind[k] != BR_NONE);
+                group_has_mem   = group_has_mem || (dec_mem_op[k] != MEM_NONE);
+            end
+        end
+    end
+
+    always_comb begin
+        group_br_rob_idx  = 0;
+        group_br_pc       = fd_pc;
+        group_mem_op      = MEM_NONE;
+        group_mem_rob_idx = 0;
+        group_mem_phys_rd = 0;
+        group_mem_pc      = fd_pc;
+        for (int k = 0; k < WIDTH; k++) begin
+            if (dec_dispatch[k] && dec_br_kind[k] != BR_NONE) begin
+                group_br_rob_idx = rob_alloc_idx[k];
+                group_br_pc      = dec_pc[k];
+            end
+            if (dec_dispatch[k] && dec_mem_op[k] != MEM_NONE) begin
+                group_mem_op      = dec_mem_op[k];
+                group_mem_rob_idx = rob_alloc_idx[k];
+                group_mem_phys_rd = rename_phys_rd[k];
+                group_mem_pc      = dec_pc[k];
+            end
+        end
+    end
+
+    assign dispatch_en   = group_dispatch && !frontend_stall && !recover && !replay;
+    assign slot_dispatch = dispatch_en ? dec_dispatch : '0;
+    assign ckpt_alloc_en = dispatch_en && group_has_br;
+    assign lsq_alloc_en  = dispatch_en && group_has_mem;
 
-    // Should we rename this instruction?
-    assign rename_en = fd_valid && dec_reg_write && !dec_is_nop &&
-                       dec_rd != 5'd0 && alloc_valid && rob_alloc_ready && iq_dispatch_ready;
+    // Should we rename this instruction? Eliminated ones don't take a new
+    // register or an issue queue entry.
+    assign rename_en      = slot_dispatch & dec_writes_rd;
+    assign rename_alloc   = rename_en & ~dec_elim;
+    assign iq_dispatch_en = slot_dispatch & ~dec_elim;
 
     // Free list allocation
-    logic [PHYS_REG_BITS-1:0] fl_alloc_reg;
+    logic [WIDTH-1:0][PHYS_REG_BITS-1:0] fl_alloc_reg;
 
     free_list #(
         .NUM_PHYS_REGS(NUM_PHYS_REGS),
-        .PHYS_REG_BITS(PHYS_REG_BITS)
+        .PHYS_REG_BITS(PHYS_REG_BITS),
+        .WIDTH        (WIDTH),
+        .RETIRE_WIDTH (RETIRE_WIDTH),
+        .NUM_CKPTS    (NUM_CKPTS),
+        .CKPT_BITS    (CKPT_BITS)
     ) fl (
         .clk        (clk),
         .rst        (rst),
-        .alloc_en   (rename_en),
+        .flush      (replay),
+        .alloc_en   (rename_alloc),
         .alloc_reg  (fl_alloc_reg),
         .alloc_valid(alloc_valid),
         .free_en    (commit_free_en),
-        .free_reg   (commit_free_reg)
+        .free_reg   (commit_free_reg),
+        .commit_en  (commit_alloc_en),
+        .share_en   (commit_share_en),
+        .share_reg  (commit_share_reg),
+        .ckpt_en    (ckpt_alloc_en),
+        .ckpt_id    (ckpt_free_id),
+        .restore_en (recover),
+        .restore_id (ex_br_tag_r)
     );
 
-    assign rename_phys_rd = fl_alloc_reg;
+    // Instructions without a destination get physical register 0; an
+    // eliminated move takes its source's
+    always_comb begin
+        for (int k = 0; k < WIDTH; k++) begin
+            rename_phys_rd[k] = !dec_writes_rd[k] ? {PHYS_REG_BITS{1'b0}} :
+                                dec_elim[k]       ? rename_phys_rs1[k] : fl_alloc_reg[k];
+        end
+    end
 
     // RAT lookup and update
-    rat #(.PHYS_REG_BITS(PHYS_REG_BITS)) rat_inst (
+    rat #(
+        .PHYS_REG_BITS(PHYS_REG_BITS),
+        .WIDTH        (WIDTH),
+        .RETIRE_WIDTH (RETIRE_WIDTH),
+        .NUM_CKPTS    (NUM_CKPTS),
+        .CKPT_BITS    (CKPT_BITS)
+    ) rat_inst (
         .clk            (clk),
         .rst            (rst),
-        .flush          (1'b0),  // No branch misprediction handling yet
+        .flush          (replay),  // Branches use checkpoints; replays restart from commit
         .rs1            (dec_rs1),
         .rs2            (dec_rs2),
         .phys_rs1       (rename_phys_rs1),
@@ -175,50 +771,222 @@ module cpu_ooo (
         .rename_rd      (dec_rd),
         .rename_phys_rd (rename_phys_rd),
         .rename_old_phys(rename_old_phys),
+        .ckpt_en        (ckpt_alloc_en),
+        .ckpt_id        (ckpt_free_id),
+        .restore_en     (recover),
+        .restore_id     (ex_br_tag_r),
         .commit_en      (commit_rat_en),
         .commit_rd      (commit_rat_rd),
         .commit_phys_rd (commit_rat_phys)
     );
 
-    // Source readiness from ready table
-    logic src1_ready, src2_ready;
-    assign src1_ready = (dec_rs1 == 5'd0) || ready_table[rename_phys_rs1];
-    assign src2_ready = (dec_rs2 == 5'd0) || ready_table[rename_phys_rs2];
+    // Source readiness from ready table. A register newly allocated to an
+    // older slot in the group isn't ready, whatever the table says about
+    // its last use. (Reading through an eliminated move gives the move's
+    // source, which is only new if an older slot allocated it.)
+    logic [WIDTH-1:0] src1_ready, src2_ready;
+    logic [WIDTH-1:0] src1_new, src2_new;
+
+    always_comb begin
+        for (int k = 0; k < WIDTH; k++) begin
+            src1_new[k] = 1'b0;
+            src2_new[k] = 1'b0;
+            for (int j = 0; j < k; j++) begin
+                if (rename_alloc[j] && fl_alloc_reg[j] == rename_phys_rs1[k]) src1_new[k] = 1'b1;
+                if (rename_alloc[j] && fl_alloc_reg[j] == rename_phys_rs2[k]) src2_new[k] = 1'b1;
+            end
+            src1_ready[k] = (dec_rs1[k] == 5'd0) ||
+                            (!src1_new[k] && ready_table[rename_phys_rs1[k]]);
+            src2_ready[k] = (dec_rs2[k] == 5'd0) ||
+                            (!src2_new[k] && ready_table[rename_phys_rs2[k]]);
+        end
+    end
+
+    // Frontend stalls if resources for the whole group are unavailable,
+    // or if it would only add to a full pending_drop
+    assign frontend_stall = (group_dispatch &&
+                             ((group_writes_rd && !alloc_valid) || !rob_alloc_ready || !iq_dispatch_ready ||
+                              (group_has_br && !ckpt_free_found) ||
+                              (group_has_mem && !lsq_alloc_ready))) ||
+                            drop_stall;
+
+    // Statistics
+    logic [31:0] stat_dispatch_groups;  // Cycles that dispatched something
+    logic [31:0] stat_dispatched;       // Instructions dispatched
+    logic [31:0] stat_moves_elim;       // Moves renamed away
+    logic [31:0] stat_zeros_elim;       // Zero idioms renamed away
+    logic [31:0] stat_fused_li;         // lui + addi
+    logic [31:0] stat_fused_call;       // auipc + jalr
+    logic [31:0] stat_fused_cmp_br;     // slt/sltu + beq/bne
+    logic [31:0] group_size;
+    logic [31:0] group_moves;
+    logic [31:0] group_zeros;
+    logic [31:0] group_li, group_call, group_cmp_br;
+
+    always_comb begin
+        group_size   = 32'd0;
+        group_moves  = 32'd0;
+        group_zeros  = 32'd0;
+        group_li     = 32'd0;
+        group_call   = 32'd0;
+        group_cmp_br = 32'd0;
+        for (int k = 0; k < WIDTH; k++) begin
+            if (slot_dispatch[k]) group_size = group_size + 1;
+            if (slot_dispatch[k] && dec_elim[k]) begin
+                if (dec_rs1[k] == 5'd0) group_zeros = group_zeros + 1;
+                else                    group_moves = group_moves + 1;
+            end
+            if (slot_dispatch[k]) begin
+                case (dec_fused[k])
+                    2'd1:    group_li     = group_li + 1;      // LI
+                    2'd2:    group_call   = group_call + 1;    // CALL
+                    2'd3:    group_cmp_br = group_cmp_br + 1;  // CMP_BR
+                    default: ;
+                endcase
+            end
+        end
+    end
 
-    // Frontend stalls if resources unavailable
-    assign frontend_stall = fd_valid && dec_reg_write && !dec_is_nop && dec_rd != 5'd0 &&
-                           (!alloc_valid || !rob_alloc_ready || !iq_dispatch_ready);
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_dispatch_groups <= 32'd0;
+            stat_dispatched      <= 32'd0;
+            stat_moves_elim      <= 32'd0;
+            stat_zeros_elim      <= 32'd0;
+            stat_fused_li        <= 32'd0;
+            stat_fused_call      <= 32'd0;
+            stat_fused_cmp_br    <= 32'd0;
+        end else if (dispatch_en) begin
+            stat_dispatch_groups <= stat_dispatch_groups + 1;
+            stat_dispatched      <= stat_dispatched + group_size;
+            stat_moves_elim      <= stat_moves_elim + group_moves;
+            stat_zeros_elim      <= stat_zeros_elim + group_zeros;
+            stat_fused_li        <= stat_fused_li + group_li;
+            stat_fused_call      <= stat_fused_call + group_call;
+            stat_fused_cmp_br    <= stat_fused_cmp_br + group_cmp_br;
+        end
+    end
+
+    // ========================================================================
+    // BRANCH CHECKPOINTS
+    // One tag per branch/JALR in flight. The RAT and free list keep their
+    // snapshots under the same tag; the fetch-side state needed to resolve
+    // the branch is kept here.
+    // ========================================================================
+    logic                    ckpt_busy        [0:NUM_CKPTS-1];
+    logic [ROB_IDX_BITS-1:0] ckpt_rob_idx     [0:NUM_CKPTS-1];
+    logic [31:0]             ckpt_pc          [0:NUM_CKPTS-1];
+    logic [31:0]             ckpt_predict_next[0:NUM_CKPTS-1];
+    logic [31:0]             ckpt_history     [0:NUM_CKPTS-1];
+
+    always_comb begin
+        ckpt_free_id    = 0;
+        ckpt_free_found = 1'b0;
+        for (int t = 0; t < NUM_CKPTS; t++) begin
+            if (!ckpt_busy[t] && !ckpt_free_found) begin
+                ckpt_free_id    = t[CKPT_BITS-1:0];
+                ckpt_free_found = 1'b1;
+            end
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            for (int t = 0; t < NUM_CKPTS; t++) begin
+                ckpt_busy[t]         <= 1'b0;
+                ckpt_rob_idx[t]      <= 0;
+                ckpt_pc[t]           <= 32'd0;
+                ckpt_predict_next[t] <= 32'd0;
+                ckpt_history[t]      <= 32'd0;
+            end
+        end else if (replay) begin
+            // Replay: nothing in flight survives
+            for (int t = 0; t < NUM_CKPTS; t++) begin
+                ckpt_busy[t] <= 1'b0;
+            end
+        end else begin
+            if (ckpt_alloc_en) begin
+                // The branch ends its group, so the group's prediction is its own
+                ckpt_busy[ckpt_free_id]         <= 1'b1;
+                ckpt_rob_idx[ckpt_free_id]      <= group_br_rob_idx;
+                ckpt_pc[ckpt_free_id]           <= group_br_pc;
+                ckpt_predict_next[ckpt_free_id] <= fd_predict_next;
+                ckpt_history[ckpt_free_id]      <= fd_history;
+            end
+
+            // A resolved branch no longer needs its checkpoint
+            if (resolve_en) begin
+                ckpt_busy[ex_br_tag_r] <= 1'b0;
+            end
+
+            // Neither do branches squashed by a misprediction
+            if (recover) begin
+                for (int t = 0; t < NUM_CKPTS; t++) begin
+                    if (rob_younger(ckpt_rob_idx[t], ex_rob_idx_r, rob_head))
+                        ckpt_busy[t] <= 1'b0;
+                end
+            end
+        end
+    end
 
     // ========================================================================
     // DISPATCH - Insert into ROB and Issue Queue
     // ========================================================================
     logic        rob_alloc_ready;
-    logic [ROB_IDX_BITS-1:0] rob_alloc_idx;
+    logic [WIDTH-1:0][ROB_IDX_BITS-1:0] rob_alloc_idx;
+    logic [WIDTH-1:0][4:0] rob_alloc_rd;
+    logic [WIDTH-1:0]      rob_alloc_mem;
+
+    always_comb begin
+        for (int k = 0; k < WIDTH; k++) begin
+            rob_alloc_rd[k]  = dec_writes_rd[k] ? dec_rd[k] : 5'd0;
+            rob_alloc_mem[k] = (dec_mem_op[k] != MEM_NONE);
+        end
+    end
 
     // ROB allocation
-    logic        rob_complete_en;
-    logic [ROB_IDX_BITS-1:0] rob_complete_idx;
-    logic [31:0] rob_complete_result;
-    logic        commit_valid;
-    logic [4:0]  commit_rd_out;
-    logic [PHYS_REG_BITS-1:0] commit_phys_rd_out;
-    logic [PHYS_REG_BITS-1:0] commit_old_phys_out;
-    logic [31:0] commit_result_out;
-    logic        commit_ack;
+    logic [COMPLETE_PORTS-1:0]        rob_complete_en;
+    logic [COMPLETE_PORTS-1:0][ROB_IDX_BITS-1:0] rob_complete_idx;
+    logic [COMPLETE_PORTS-1:0][31:0]  rob_complete_result;
+    logic [RETIRE_WIDTH-1:0]       commit_valid;
+    logic [RETIRE_WIDTH-1:0][4:0]  commit_rd_out;
+    logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] commit_phys_rd_out;
+    logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] commit_old_phys_out;
+    logic [RETIRE_WIDTH-1:0][31:0] commit_result_out;
+    logic [RETIRE_WIDTH-1:0][31:0] commit_pc_slots;
+    logic [RETIRE_WIDTH-1:0]       commit_mem;
+    logic [RETIRE_WIDTH-1:0]       commit_elim;
+    logic [RETIRE_WIDTH-1:0]       commit_ack;
+    logic [RETIRE_WIDTH-1:0][3:0]  commit_insts;
+    logic [ROB_IDX_BITS+3:0]       rob_insts_in_flight;
+    logic [ROB_IDX_BITS+3:0]       rob_squash_insts;
+    logic [31:0] stat_rob_occupancy;    // Sum over cycles of entries in use
+    logic [31:0] stat_rob_full;         // Cycles the ROB couldn't take a group
+    logic [31:0] stat_commit_stalls;    // Cycles with an unfinished ROB head
 
     rob #(
         .ROB_SIZE(ROB_SIZE),
         .ROB_IDX_BITS(ROB_IDX_BITS),
-        .PHYS_REG_BITS(PHYS_REG_BITS)
+        .PHYS_REG_BITS(PHYS_REG_BITS),
+        .WIDTH(WIDTH),
+        .COMPLETE_PORTS(COMPLETE_PORTS),
+        .RETIRE_WIDTH(RETIRE_WIDTH)
     ) rob_inst (
         .clk            (clk),
         .rst            (rst),
-        .flush          (1'b0),
-        .alloc_en       (rename_en),
-        .alloc_rd       (dec_rd),
+        .flush          (replay),
+        .squash_en      (recover),
+        .squash_idx     (ex_rob_idx_r),
+        .head_idx       (rob_head),
+        .squash_insts   (rob_squash_insts),
+        .alloc_en       (slot_dispatch),
+        .alloc_rd       (rob_alloc_rd),
         .alloc_phys_rd  (rename_phys_rd),
         .alloc_old_phys (rename_old_phys),
-        .alloc_pc       (fd_pc),
+        .alloc_pc       (dec_pc),
+        .alloc_mem      (rob_alloc_mem),
+        .alloc_elim     (dec_elim),
+        .alloc_insts    (dec_insts),
         .alloc_idx      (rob_alloc_idx),
         .alloc_ready    (rob_alloc_ready),
         .complete_en    (rob_complete_en),
@@ -229,37 +997,110 @@ module cpu_ooo (
         .commit_phys_rd (commit_phys_rd_out),
         .commit_old_phys(commit_old_phys_out),
         .commit_result  (commit_result_out),
-        .commit_ack     (commit_ack)
+        .commit_pc      (commit_pc_slots),
+        .commit_mem     (commit_mem),
+        .commit_elim    (commit_elim),
+        .commit_insts   (commit_insts),
+        .commit_ack     (commit_ack),
+        .insts_in_flight(rob_insts_in_flight),
+        .stat_occupancy    (stat_rob_occupancy),
+        .stat_full_cycles  (stat_rob_full),
+        .stat_commit_stalls(stat_commit_stalls)
     );
 
+    // A replay refetches from the instruction at the head
+    assign commit_pc_out = commit_pc_slots[0];
+
+    // Dropped slots wait for the next dispatched one, unless nothing older
+    // is in flight. Anything still waiting at a recovery or replay was on
+    // the wrong path. Past DROP_LIMIT a group of drops waits for the ROB
+    // to empty, then they all retire directly.
+    assign drop_stall = !group_dispatch && (|dec_dropped) && pending_drop > DROP_LIMIT &&
+                        rob_insts_in_flight != 0;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            pending_drop <= 4'd0;
+        end else if (recover || replay) begin
+            pending_drop <= 4'd0;
+        end else if (!frontend_stall) begin
+            if (!group_dispatch && rob_insts_in_flight == 0)
+                pending_drop <= 4'd0;   // Retired directly (see perf counters)
+            else
+                pending_drop <= group_drops;
+        end
+    end
+
     // Issue Queue dispatch
     logic iq_dispatch_ready;
 
-    // Issue queue outputs
-    logic        iq_issue_valid;
-    logic [3:0]  iq_issue_alu_op;
-    logic        iq_issue_alu_src;
-    logic [31:0] iq_issue_imm;
-    logic [PHYS_REG_BITS-1:0] iq_issue_phys_rs1;
-    logic [PHYS_REG_BITS-1:0] iq_issue_phys_rs2;
-    logic [PHYS_REG_BITS-1:0] iq_issue_phys_rd;
-    logic [ROB_IDX_BITS-1:0]  iq_issue_rob_idx;
-    logic        iq_issue_ack;
-
-    // Wakeup signal (from execute/complete stage)
-    logic        wakeup_en;
-    logic [PHYS_REG_BITS-1:0] wakeup_phys_rd;
+    // Issue queue outputs, one set per execution port. Port 0 executes
+    // everything; the other ports are ALU-only.
+    logic [ISSUE_WIDTH-1:0]        iq_issue_valid;
+    logic [ISSUE_WIDTH-1:0][4:0]   iq_issue_alu_op;
+    logic [ISSUE_WIDTH-1:0]        iq_issue_alu_src;
+    logic [ISSUE_WIDTH-1:0][31:0]  iq_issue_imm;
+    logic [ISSUE_WIDTH-1:0][PHYS_REG_BITS-1:0] iq_issue_phys_rs1;
+    logic [ISSUE_WIDTH-1:0][PHYS_REG_BITS-1:0] iq_issue_phys_rs2;
+    logic [ISSUE_WIDTH-1:0][PHYS_REG_BITS-1:0] iq_issue_phys_rd;
+    logic [ISSUE_WIDTH-1:0][ROB_IDX_BITS-1:0]  iq_issue_rob_idx;
+    logic [ISSUE_WIDTH-1:0][1:0]   iq_issue_br_kind;
+    logic [ISSUE_WIDTH-1:0][2:0]   iq_issue_funct3;
+    logic [ISSUE_WIDTH-1:0][CKPT_BITS-1:0]     iq_issue_br_tag;
+    logic [ISSUE_WIDTH-1:0][1:0]   iq_issue_mem_op;
+    logic [ISSUE_WIDTH-1:0][LSQ_IDX_BITS-1:0]  iq_issue_lsq_idx;
+    logic [ISSUE_WIDTH-1:0][1:0]   iq_issue_fu;
+    logic [ISSUE_WIDTH-1:0]        iq_issue_ack;
+
+    // Issue statistics
+    logic [7:0][31:0] stat_issue_latency;   // Issues by cycles spent in the IQ
+    logic [31:0]      stat_ready_waits;     // Entry-cycles ready but not issued
+    logic [31:0]      stat_max_ready_wait;
+
+    // Wakeup buses: one per port, driven at issue, plus loads, multiplies
+    // and divides
+    logic [WAKEUP_PORTS-1:0]       wakeup_en;
+    logic [WAKEUP_PORTS-1:0][PHYS_REG_BITS-1:0] wakeup_phys_rd;
+
+    // Multiply/divide unit (see below): ops in flight drive wakeup buses,
+    // and the divider takes one divide at a time
+    localparam MD_TAG_BITS = ROB_IDX_BITS + PHYS_REG_BITS;
+
+    logic                   md_issue;      // MD_PORT issued a live multiply/divide
+    logic [MD_TAG_BITS-1:0] md_tag;
+    logic [1:0]                   mul_stage_valid;
+    logic [1:0][MD_TAG_BITS-1:0]  mul_stage_tag;
+    logic [1:0]                   mul_stage_kill;
+    logic                   mul_done;
+    logic [31:0]            mul_result;
+    logic [MD_TAG_BITS-1:0] mul_done_tag;
+    logic                   div_busy;
+    logic                   div_finishing;
+    logic [MD_TAG_BITS-1:0] div_busy_tag;
+    logic                   div_kill;
+    logic                   div_done;
+    logic [31:0]            div_result;
+    logic [MD_TAG_BITS-1:0] div_done_tag;
 
     issue_queue #(
         .IQ_SIZE(8),
         .IQ_IDX_BITS(3),
         .PHYS_REG_BITS(PHYS_REG_BITS),
-        .ROB_IDX_BITS(ROB_IDX_BITS)
+        .ROB_IDX_BITS(ROB_IDX_BITS),
+        .CKPT_BITS(CKPT_BITS),
+        .LSQ_IDX_BITS(LSQ_IDX_BITS),
+        .WIDTH(WIDTH),
+        .ISSUE_WIDTH(ISSUE_WIDTH),
+        .WAKEUP_PORTS(WAKEUP_PORTS),
+        .MD_PORT(MD_PORT)
     ) iq (
         .clk               (clk),
         .rst               (rst),
-        .flush             (1'b0),
-        .dispatch_en       (rename_en),
+        .flush             (replay),
+        .squash_en         (recover),
+        .squash_rob_idx    (ex_rob_idx_r),
+        .rob_head          (rob_head),
+        .dispatch_en       (iq_dispatch_en),
         .dispatch_alu_op   (dec_alu_op),
         .dispatch_alu_src  (dec_alu_src),
         .dispatch_imm      (dec_imm),
@@ -269,7 +1110,14 @@ module cpu_ooo (
         .dispatch_src1_ready(src1_ready),
         .dispatch_src2_ready(src2_ready),
         .dispatch_rob_idx  (rob_alloc_idx),
+        .dispatch_br_kind  (dec_br_kind),
+        .dispatch_funct3   (dec_funct3),
+        .dispatch_br_tag   ({WIDTH{ckpt_free_id}}),
+        .dispatch_mem_op   (dec_mem_op),
+        .dispatch_lsq_idx  ({WIDTH{lsq_alloc_idx}}),
+        .dispatch_fu       (dec_fu),
         .dispatch_ready    (iq_dispatch_ready),
+        .div_ready         (!div_busy),
         .wakeup_en         (wakeup_en),
         .wakeup_phys_rd    (wakeup_phys_rd),
         .issue_valid       (iq_issue_valid),
@@ -280,52 +1128,386 @@ module cpu_ooo (
         .issue_phys_rs2    (iq_issue_phys_rs2),
         .issue_phys_rd     (iq_issue_phys_rd),
         .issue_rob_idx     (iq_issue_rob_idx),
-        .issue_ack         (iq_issue_ack)
+        .issue_br_kind     (iq_issue_br_kind),
+        .issue_funct3      (iq_issue_funct3),
+        .issue_br_tag      (iq_issue_br_tag),
+        .issue_mem_op      (iq_issue_mem_op),
+        .issue_lsq_idx     (iq_issue_lsq_idx),
+        .issue_fu          (iq_issue_fu),
+        .issue_ack         (iq_issue_ack),
+        .stat_issue_latency (stat_issue_latency),
+        .stat_ready_waits   (stat_ready_waits),
+        .stat_max_ready_wait(stat_max_ready_wait)
     );
 
     // ========================================================================
     // ISSUE STAGE - Read physical register file
     // ========================================================================
-    logic [31:0] issue_rs1_data, issue_rs2_data;
+    logic [ISSUE_WIDTH-1:0][31:0] prf_rs1_data, prf_rs2_data;    // From the register file
+    logic [ISSUE_WIDTH-1:0][31:0] issue_rs1_data, issue_rs2_data;  // After the bypass
 
-    // Issue when IQ has a ready instruction
-    assign iq_issue_ack = iq_issue_valid; // Always accept (single-cycle execute)
+    // Issue when IQ has a ready instruction (single-cycle execute). Port 0
+    // holds off while a load from the LSQ is taking its complete stage.
+    logic        lsq_load_done;
+    logic [ROB_IDX_BITS-1:0]  lsq_load_rob_idx;
+    logic [PHYS_REG_BITS-1:0] lsq_load_phys_rd;
+    logic [31:0] lsq_load_data;
 
-    // Physical register file
-    logic        prf_write_en;
-    logic [PHYS_REG_BITS-1:0] prf_write_addr;
-    logic [31:0] prf_write_data;
+    always_comb begin
+        iq_issue_ack    = iq_issue_valid;
+        iq_issue_ack[0] = iq_issue_valid[0] && !lsq_load_done;
+    end
+
+    // Physical register file: two read ports per execution port, one write
+    // port per complete port
+    logic [COMPLETE_PORTS-1:0]        prf_write_en;
+    logic [COMPLETE_PORTS-1:0][PHYS_REG_BITS-1:0] prf_write_addr;
+    logic [COMPLETE_PORTS-1:0][31:0]  prf_write_data;
 
     physical_regfile #(
-        .NUM_PHYS_REGS(NUM_PHYS_REGS),
-        .PHYS_REG_BITS(PHYS_REG_BITS)
+        .NUM_PHYS_REGS  (NUM_PHYS_REGS),
+        .PHYS_REG_BITS  (PHYS_REG_BITS),
+        .NUM_PORTS      (ISSUE_WIDTH),
+        .NUM_WRITE_PORTS(COMPLETE_PORTS)
     ) prf (
         .clk        (clk),
         .rst        (rst),
         .read_addr1 (iq_issue_phys_rs1),
-        .read_data1 (issue_rs1_data),
+        .read_data1 (prf_rs1_data),
         .read_addr2 (iq_issue_phys_rs2),
-        .read_data2 (issue_rs2_data),
+        .read_data2 (prf_rs2_data),
         .write_en   (prf_write_en),
         .write_addr (prf_write_addr),
         .write_data (prf_write_data)
     );
 
+    // Writeback buses, one per complete port (driven from the complete stage)
+    logic [COMPLETE_PORTS-1:0]        wb_valid;
+    logic [COMPLETE_PORTS-1:0][PHYS_REG_BITS-1:0] wb_phys_rd;
+    logic [COMPLETE_PORTS-1:0][ROB_IDX_BITS-1:0]  wb_rob_idx;
+    logic [COMPLETE_PORTS-1:0][31:0]  wb_result;
+
+    // Bypass network: results in the complete registers are written to
+    // the register file at the end of this cycle, so operands that match
+    // one are taken from it directly
+    always_comb begin
+        for (int p = 0; p < ISSUE_WIDTH; p++) begin
+            issue_rs1_data[p] = prf_rs1_data[p];
+            issue_rs2_data[p] = prf_rs2_data[p];
+            for (int w = 0; w < COMPLETE_PORTS; w++) begin
+                if (wb_valid[w] && wb_phys_rd[w] != 0) begin
+                    if (wb_phys_rd[w] == iq_issue_phys_rs1[p])
+                        issue_rs1_data[p] = wb_result[w];
+                    if (wb_phys_rd[w] == iq_issue_phys_rs2[p])
+                        issue_rs2_data[p] = wb_result[w];
+                end
+            end
+        end
+    end
+
+    // Speculative wakeup: single-cycle results are announced as they issue,
+    // so dependents issue next cycle, back to back. A load's result comes
+    // from the LSQ, which announces it a cycle before it completes; the
+    // multiplier and divider do the same from their second-to-last cycle.
+    always_comb begin
+        for (int p = 0; p < ISSUE_WIDTH; p++) begin
+            wakeup_en[p]      = iq_issue_valid[p] && iq_issue_ack[p] && (iq_issue_fu[p] == FU_ALU) &&
+                                (iq_issue_mem_op[p] != MEM_LOAD) && (iq_issue_phys_rd[p] != 0);
+            wakeup_phys_rd[p] = iq_issue_phys_rd[p];
+        end
+        wakeup_en[ISSUE_WIDTH]          = lsq_load_done && (lsq_load_phys_rd != 0);
+        wakeup_phys_rd[ISSUE_WIDTH]     = lsq_load_phys_rd;
+        wakeup_en[ISSUE_WIDTH + 1]      = mul_stage_valid[1] && (mul_stage_tag[1][PHYS_REG_BITS-1:0] != 0);
+        wakeup_phys_rd[ISSUE_WIDTH + 1] = mul_stage_tag[1][PHYS_REG_BITS-1:0];
+        wakeup_en[ISSUE_WIDTH + 2]      = div_finishing && (div_busy_tag[PHYS_REG_BITS-1:0] != 0);
+        wakeup_phys_rd[ISSUE_WIDTH + 2] = div_busy_tag[PHYS_REG_BITS-1:0];
+    end
+
+    // ========================================================================
+    // EXECUTE STAGE - One ALU per port; port 0 also resolves branches and
+    // computes load/store addresses
+    // ========================================================================
+    logic [ISSUE_WIDTH-1:0][31:0] alu_operand_b;
+    logic [ISSUE_WIDTH-1:0][31:0] alu_result;
+
+    generate
+        for (g = 0; g < ISSUE_WIDTH; g++) begin : ex_port
+            assign alu_operand_b[g] = iq_issue_alu_src[g] ? iq_issue_imm[g] : issue_rs2_data[g];
+
+            // ALU instance
+            alu alu_inst (
+                .a       (issue_rs1_data[g]),
+                .b       (alu_operand_b[g]),
+                .alu_op  (iq_issue_alu_op[g]),
+                .result  (alu_result[g]),
+                .zero    ()  // Branches use their own comparator
+            );
+        end
+    endgenerate
+
+    // Branch resolution
+    logic        br_condition;
+    logic [31:0] ex_br_pc;
+    logic        ex_taken;
+    logic [31:0] ex_target;
+    logic [31:0] ex_next_pc;
+    logic        ex_mispredict;
+    logic [31:0] ex_result;
+
+    always_comb begin
+        case (iq_issue_funct3[0])
+            3'b000:  br_condition = (issue_rs1_data[0] == issue_rs2_data[0]);                   // BEQ
+            3'b001:  br_condition = (issue_rs1_data[0] != issue_rs2_data[0]);                   // BNE
+            3'b100:  br_condition = ($signed(issue_rs1_data[0]) <  $signed(issue_rs2_data[0])); // BLT
+            3'b101:  br_condition = ($signed(issue_rs1_data[0]) >= $signed(issue_rs2_data[0])); // BGE
+            3'b110:  br_condition = (issue_rs1_data[0] <  issue_rs2_data[0]);                   // BLTU
+            3'b111:  br_condition = (issue_rs1_data[0] >= issue_rs2_data[0]);                   // BGEU
+            default: br_condition = 1'b0;
+        endcase
+    end
+
+    assign ex_br_pc      = ckpt_pc[iq_issue_br_tag[0]];
+    assign ex_taken      = (iq_issue_br_kind[0] == BR_JALR) || br_condition;
+    assign ex_target     = (iq_issue_br_kind[0] == BR_JALR) ? {alu_result[0][31:1], 1'b0} :
+                                                           ex_br_pc + iq_issue_imm[0];
+    assign ex_next_pc    = ex_taken ? ex_target : ex_br_pc + 32'd4;
+    assign ex_mispredict = (iq_issue_br_kind[0] != BR_NONE) &&
+                           (ex_next_pc != ckpt_predict_next[iq_issue_br_tag[0]]);
+
+    // JALR writes the link address, everything else the ALU result
+    assign ex_result = (iq_issue_br_kind[0] == BR_JALR) ? ex_br_pc + 32'd4 : alu_result[0];
+
+    // An instruction issued in the cycle its older branch recovers is
+    // wrong-path: drop it before it writes anything
+    logic issue_squashed;
+    assign issue_squashed = recover && rob_younger(iq_issue_rob_idx[0], ex_rob_idx_r, rob_head);
+
+    // Loads and stores: the ALU result is the address, sent to the LSQ
+    logic lsq_addr_en;
+    assign lsq_addr_en = iq_issue_ack[0] && !issue_squashed && !replay &&
+                         (iq_issue_mem_op[0] != MEM_NONE);
+
+    // ========================================================================
+    // MULTIPLY/DIVIDE UNIT - Fed from MD_PORT, completes on its own ports
+    // Ops carry {ROB index, destination} as their tag (declared with the
+    // wakeup buses). A misprediction drops the ones younger than the branch
+    // wherever they are; a replay drops everything.
+    // ========================================================================
+    assign md_issue = iq_issue_valid[MD_PORT] && iq_issue_ack[MD_PORT] && !replay &&
+                      !(recover && rob_younger(iq_issue_rob_idx[MD_PORT], ex_rob_idx_r, rob_head));
+    assign md_tag   = {iq_issue_rob_idx[MD_PORT], iq_issue_phys_rd[MD_PORT]};
+
+    always_comb begin
+        for (int s = 0; s < 2; s++) begin
+            mul_stage_kill[s] = recover &&
+                                rob_younger(mul_stage_tag[s][MD_TAG_BITS-1:PHYS_REG_BITS],
+                                            ex_rob_idx_r, rob_head);
+        end
+        div_kill = recover && rob_younger(div_busy_tag[MD_TAG_BITS-1:PHYS_REG_BITS],
+                                          ex_rob_idx_r, rob_head);
+    end
+
+    multiplier #(
+        .TAG_BITS(MD_TAG_BITS)
+    ) mul_unit (
+        .clk        (clk),
+        .rst        (rst),
+        .flush      (replay),
+        .start      (md_issue && iq_issue_fu[MD_PORT] == FU_MUL),
+        .op         (iq_issue_funct3[MD_PORT][1:0]),
+        .a          (issue_rs1_data[MD_PORT]),
+        .b          (issue_rs2_data[MD_PORT]),
+        .tag        (md_tag),
+        .stage_valid(mul_stage_valid),
+        .stage_tag  (mul_stage_tag),
+        .stage_kill (mul_stage_kill),
+        .done       (mul_done),
+        .result     (mul_result),
+        .done_tag   (mul_done_tag)
+    );
+
+    divider #(
+        .TAG_BITS(MD_TAG_BITS)
+    ) div_unit (
+        .clk        (clk),
+        .rst        (rst),
+        .flush      (replay),
+        .start      (md_issue && iq_issue_fu[MD_PORT] == FU_DIV),
+        .op         (iq_issue_funct3[MD_PORT][1:0]),
+        .a          (issue_rs1_data[MD_PORT]),
+        .b          (issue_rs2_data[MD_PORT]),
+        .tag        (md_tag),
+        .busy       (div_busy),
+        .finishing  (div_finishing),
+        .busy_tag   (div_busy_tag),
+        .kill       (div_kill),
+        .done       (div_done),
+        .result     (div_result),
+        .done_tag   (div_done_tag)
+    );
+
+    // Statistics
+    logic [31:0] stat_mul_ops;      // Multiplies issued
+    logic [31:0] stat_div_ops;      // Divides and remainders issued
+    logic [31:0] stat_div_busy;     // Cycles the divider was busy
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_mul_ops  <= 32'd0;
+            stat_div_ops  <= 32'd0;
+            stat_div_busy <= 32'd0;
+        end else begin
+            if (md_issue && iq_issue_fu[MD_PORT] == FU_MUL)
+                stat_mul_ops <= stat_mul_ops + 1;
+            if (md_issue && iq_issue_fu[MD_PORT] == FU_DIV)
+                stat_div_ops <= stat_div_ops + 1;
+            if (div_busy)
+                stat_div_busy <= stat_div_busy + 1;
+        end
+    end
+
     // ========================================================================
-    // EXECUTE STAGE
+    // LOAD/STORE QUEUE + D-CACHE
     // ========================================================================
-    logic [31:0] alu_operand_b;
-    logic [31:0] alu_result;
+    logic        lsq_commit_pending;
+    logic [ROB_IDX_BITS-1:0] lsq_commit_rob_idx;
+    logic        lsq_commit_violation;
+    logic        lsq_commit_en;
+    logic [31:0] stat_lsq_forwards;
+    logic [31:0] stat_lsq_violations;
+    logic [31:0] stat_lsq_spec_loads;
+    logic [31:0] stat_predicted_deps;
+
+    // Memory dependence prediction
+    logic        ss_wait_valid;
+    logic [LSQ_IDX_BITS-1:0] ss_wait_idx;
+    logic        lsq_violation_en;
+    logic [31:0] lsq_violation_load_pc;
+    logic [31:0] lsq_violation_store_pc;
+
+    store_set_predictor #(
+        .LSQ_IDX_BITS(LSQ_IDX_BITS)
+    ) ssp (
+        .clk                (clk),
+        .rst                (rst),
+        .flush              (replay),
+        .dispatch_pc        (group_mem_pc),
+        .dispatch_load      (lsq_alloc_en && group_mem_op == MEM_LOAD),
+        .dispatch_store     (lsq_alloc_en && group_mem_op == MEM_STORE),
+        .dispatch_lsq_idx   (lsq_alloc_idx),
+        .wait_valid         (ss_wait_valid),
+        .wait_idx           (ss_wait_idx),
+        .store_exec_en      (lsq_addr_en && iq_issue_mem_op[0] == MEM_STORE),
+        .store_exec_idx     (iq_issue_lsq_idx[0]),
+        .train_en           (lsq_violation_en),
+        .train_load_pc      (lsq_violation_load_pc),
+        .train_store_pc     (lsq_violation_store_pc),
+        .stat_predicted_deps(stat_predicted_deps)
+    );
 
-    assign alu_operand_b = iq_issue_alu_src ? iq_issue_imm : issue_rs2_data;
+    // D-cache interface
+    logic [31:0] dc_addr;
+    logic        dc_read_en;
+    logic        dc_write_en;
+    logic [31:0] dc_write_data;
+    logic [31:0] dc_read_data;
+    logic        dc_stall;
+    logic        dc_hit, dc_miss;      // Performance events
 
-    // ALU instance
-    alu alu_inst (
-        .a       (issue_rs1_data),
-        .b       (alu_operand_b),
-        .alu_op  (iq_issue_alu_op),
-        .result  (alu_result),
-        .zero    ()  // Not used in OoO for now
+    // Main memory interface
+    logic [31:0] dmem_addr;
+    logic        dmem_read_en;
+    logic        dmem_write_en;
+    logic [31:0] dmem_write_data;
+    logic [31:0] dmem_read_data;
+    logic        dmem_ready;
+
+    load_store_queue #(
+        .LSQ_SIZE     (LSQ_SIZE),
+        .LSQ_IDX_BITS (LSQ_IDX_BITS),
+        .ROB_IDX_BITS (ROB_IDX_BITS),
+        .PHYS_REG_BITS(PHYS_REG_BITS),
+        .NUM_CKPTS    (NUM_CKPTS),
+        .CKPT_BITS    (CKPT_BITS)
+    ) lsq (
+        .clk             (clk),
+        .rst             (rst),
+        .flush           (replay),
+        .alloc_en        (lsq_alloc_en),
+        .alloc_is_store  (group_mem_op == MEM_STORE),
+        .alloc_rob_idx   (group_mem_rob_idx),
+        .alloc_phys_rd   (group_mem_phys_rd),
+        .alloc_pc        (group_mem_pc),
+        .alloc_wait_valid(ss_wait_valid),
+        .alloc_wait_idx  (ss_wait_idx),
+        .alloc_idx       (lsq_alloc_idx),
+        .alloc_ready     (lsq_alloc_ready),
+        .addr_en         (lsq_addr_en),
+        .addr_idx        (iq_issue_lsq_idx[0]),
+        .addr            (alu_result[0]),
+        .store_data      (issue_rs2_data[0]),
+        .load_done       (lsq_load_done),
+        .load_rob_idx    (lsq_load_rob_idx),
+        .load_phys_rd    (lsq_load_phys_rd),
+        .load_data       (lsq_load_data),
+        .cache_addr      (dc_addr),
+        .cache_read_en   (dc_read_en),
+        .cache_write_en  (dc_write_en),
+        .cache_write_data(dc_write_data),
+        .cache_read_data (dc_read_data),
+        .cache_stall     (dc_stall),
+        .commit_pending  (lsq_commit_pending),
+        .commit_rob_idx  (lsq_commit_rob_idx),
+        .commit_violation(lsq_commit_violation),
+        .commit_en       (lsq_commit_en),
+        .violation_en      (lsq_violation_en),
+        .violation_load_pc (lsq_violation_load_pc),
+        .violation_store_pc(lsq_violation_store_pc),
+        .ckpt_en         (ckpt_alloc_en),
+        .ckpt_id         (ckpt_free_id),
+        .restore_en      (recover),
+        .restore_id      (ex_br_tag_r),
+        .stat_forwards   (stat_lsq_forwards),
+        .stat_violations (stat_lsq_violations),
+        .stat_spec_loads (stat_lsq_spec_loads)
+    );
+
+    cache #(
+        .CACHE_SIZE_BYTES(256),
+        .LINE_SIZE_BYTES (16)
+    ) dcache (
+        .clk            (clk),
+        .rst            (rst),
+        .cpu_addr       (dc_addr),
+        .cpu_write_data (dc_write_data),
+        .cpu_read_en    (dc_read_en),
+        .cpu_write_en   (dc_write_en),
+        .cpu_read_data  (dc_read_data),
+        .cpu_stall      (dc_stall),
+        .event_hit      (dc_hit),
+        .event_miss     (dc_miss),
+        .prefetch_en    (1'b0),
+        .prefetch_addr  (32'd0),
+        .mem_addr       (dmem_addr),
+        .mem_read_en    (dmem_read_en),
+        .mem_write_en   (dmem_write_en),
+        .mem_write_data (dmem_write_data),
+        .mem_read_data  (dmem_read_data),
+        .mem_ready      (dmem_ready)
+    );
+
+    main_memory #(
+        .MEM_SIZE_WORDS(4096),
+        .LATENCY       (4)
+    ) dmem (
+        .clk        (clk),
+        .rst        (rst),
+        .addr       (dmem_addr),
+        .read_en    (dmem_read_en),
+        .write_en   (dmem_write_en),
+        .write_data (dmem_write_data),
+        .read_data  (dmem_read_data),
+        .ready      (dmem_ready)
     );
 
     // ========================================================================
@@ -336,34 +1518,176 @@ module cpu_ooo (
     logic [PHYS_REG_BITS-1:0] ex_phys_rd_r;
     logic [ROB_IDX_BITS-1:0]  ex_rob_idx_r;
     logic [31:0] ex_result_r;
+    logic [1:0]  ex_br_kind_r;
+    logic [CKPT_BITS-1:0] ex_br_tag_r;
+    logic        ex_taken_r;
+    logic [31:0] ex_target_r;
+    logic [31:0] ex_next_pc_r;
+    logic        ex_mispredict_r;
 
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
-            ex_valid_r   <= 1'b0;
-            ex_phys_rd_r <= 0;
-            ex_rob_idx_r <= 0;
-            ex_result_r  <= 32'd0;
+            ex_valid_r      <= 1'b0;
+            ex_phys_rd_r    <= 0;
+            ex_rob_idx_r    <= 0;
+            ex_result_r     <= 32'd0;
+            ex_br_kind_r    <= BR_NONE;
+            ex_br_tag_r     <= 0;
+            ex_taken_r      <= 1'b0;
+            ex_target_r     <= 32'd0;
+            ex_next_pc_r    <= 32'd0;
+            ex_mispredict_r <= 1'b0;
+        end else if (replay) begin
+            ex_valid_r      <= 1'b0;
+        end else if (lsq_load_done) begin
+            // Load data from the LSQ takes the complete stage this cycle
+            ex_valid_r      <= !(recover && rob_younger(lsq_load_rob_idx, ex_rob_idx_r, rob_head));
+            ex_phys_rd_r    <= lsq_load_phys_rd;
+            ex_rob_idx_r    <= lsq_load_rob_idx;
+            ex_result_r     <= lsq_load_data;
+            ex_br_kind_r    <= BR_NONE;
+            ex_mispredict_r <= 1'b0;
         end else begin
-            ex_valid_r   <= iq_issue_valid;
-            ex_phys_rd_r <= iq_issue_phys_rd;
-            ex_rob_idx_r <= iq_issue_rob_idx;
-            ex_result_r  <= alu_result;
+            // Loads only hand their address to the LSQ, multiplies and
+            // divides go to their unit; both complete later
+            ex_valid_r      <= iq_issue_valid[0] && !issue_squashed && (iq_issue_mem_op[0] != MEM_LOAD) &&
+                               (iq_issue_fu[0] == FU_ALU);
+            ex_phys_rd_r    <= iq_issue_phys_rd[0];
+            ex_rob_idx_r    <= iq_issue_rob_idx[0];
+            ex_result_r     <= ex_result;
+            ex_br_kind_r    <= iq_issue_br_kind[0];
+            ex_br_tag_r     <= iq_issue_br_tag[0];
+            ex_taken_r      <= ex_taken;
+            ex_target_r     <= ex_target;
+            ex_next_pc_r    <= ex_next_pc;
+            ex_mispredict_r <= ex_mispredict;
+        end
+    end
+
+    // ALU-only ports have a plain complete register each. Entry 0 is
+    // unused: port 0 completes through the ex_*_r register above.
+    logic [ISSUE_WIDTH-1:0]        alu_valid_r;
+    logic [ISSUE_WIDTH-1:0][PHYS_REG_BITS-1:0] alu_phys_rd_r;
+    logic [ISSUE_WIDTH-1:0][ROB_IDX_BITS-1:0]  alu_rob_idx_r;
+    logic [ISSUE_WIDTH-1:0][31:0]  alu_result_r;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst || replay) begin
+            alu_valid_r   <= '0;
+            alu_phys_rd_r <= '0;
+            alu_rob_idx_r <= '0;
+            alu_result_r  <= '0;
+        end else begin
+            for (int p = 1; p < ISSUE_WIDTH; p++) begin
+                alu_valid_r[p]   <= iq_issue_valid[p] && (iq_issue_fu[p] == FU_ALU) &&
+                                    !(recover && rob_younger(iq_issue_rob_idx[p], ex_rob_idx_r, rob_head));
+                alu_phys_rd_r[p] <= iq_issue_phys_rd[p];
+                alu_rob_idx_r[p] <= iq_issue_rob_idx[p];
+                alu_result_r[p]  <= alu_result[p];
+            end
+        end
+    end
+
+    // Statistics
+    logic [31:0] stat_multi_issue;  // Cycles with more than one port issuing
+    logic [31:0] issue_count;
+
+    always_comb begin
+        issue_count = 32'd0;
+        for (int p = 0; p < ISSUE_WIDTH; p++) begin
+            if (iq_issue_valid[p] && iq_issue_ack[p]) issue_count = issue_count + 1;
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_multi_issue <= 32'd0;
+        end else if (issue_count > 1) begin
+            stat_multi_issue <= stat_multi_issue + 1;
+        end
+    end
+
+    // Writeback buses (declared with the bypass network): the execution
+    // ports, then the multiplier and the divider
+    always_comb begin
+        for (int p = 0; p < ISSUE_WIDTH; p++) begin
+            wb_valid[p]   = alu_valid_r[p];
+            wb_phys_rd[p] = alu_phys_rd_r[p];
+            wb_rob_idx[p] = alu_rob_idx_r[p];
+            wb_result[p]  = alu_result_r[p];
+        end
+        wb_valid[0]   = ex_valid_r;
+        wb_phys_rd[0] = ex_phys_rd_r;
+        wb_rob_idx[0] = ex_rob_idx_r;
+        wb_result[0]  = ex_result_r;
+
+        wb_valid[ISSUE_WIDTH]       = mul_done;
+        wb_phys_rd[ISSUE_WIDTH]     = mul_done_tag[PHYS_REG_BITS-1:0];
+        wb_rob_idx[ISSUE_WIDTH]     = mul_done_tag[MD_TAG_BITS-1:PHYS_REG_BITS];
+        wb_result[ISSUE_WIDTH]      = mul_result;
+        wb_valid[ISSUE_WIDTH + 1]   = div_done;
+        wb_phys_rd[ISSUE_WIDTH + 1] = div_done_tag[PHYS_REG_BITS-1:0];
+        wb_rob_idx[ISSUE_WIDTH + 1] = div_done_tag[MD_TAG_BITS-1:PHYS_REG_BITS];
+        wb_result[ISSUE_WIDTH + 1]  = div_result;
+    end
+
+    always_comb begin
+        for (int p = 0; p < COMPLETE_PORTS; p++) begin
+            // Write to physical regfile
+            prf_write_en[p]   = wb_valid[p] && (wb_phys_rd[p] != 0);
+            prf_write_addr[p] = wb_phys_rd[p];
+            prf_write_data[p] = wb_result[p];
+
+            // Complete: mark ROB entry done
+            rob_complete_en[p]     = wb_valid[p];
+            rob_complete_idx[p]    = wb_rob_idx[p];
+            rob_complete_result[p] = wb_result[p];
+
+        end
+    end
+
+    // ========================================================================
+    // BRANCH RECOVERY - A mispredicted branch restores its checkpoint
+    // RAT and free list roll back, ROB and issue queue squash younger
+    // entries, fetch restarts at the correct PC. One cycle, no drain.
+    // ========================================================================
+    assign resolve_en      = ex_valid_r && (ex_br_kind_r != BR_NONE);
+    assign recover         = resolve_en && ex_mispredict_r && !replay;
+    assign resolve_pc      = ckpt_pc[ex_br_tag_r];
+    assign resolve_history = ckpt_history[ex_br_tag_r];
+
+    // Statistics
+    logic [31:0] stat_recoveries;  // Mispredicted branches and JALRs
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_recoveries <= 32'd0;
+        end else if (recover) begin
+            stat_recoveries <= stat_recoveries + 1;
         end
     end
 
-    // Write to physical regfile
-    assign prf_write_en   = ex_valid_r && (ex_phys_rd_r != 0);
-    assign prf_write_addr = ex_phys_rd_r;
-    assign prf_write_data = ex_result_r;
+    // ========================================================================
+    // MEMORY-ORDER REPLAY - A load that read stale data is refetched
+    // The LSQ can only tell after the load ran, so it's dealt with at the
+    // ROB head: instead of committing, everything is flushed back to the
+    // committed state and fetch restarts at the load.
+    // ========================================================================
+    logic head_is_mem;  // ROB head is the LSQ's oldest uncommitted entry
 
-    // Complete: mark ROB entry done
-    assign rob_complete_en     = ex_valid_r;
-    assign rob_complete_idx    = ex_rob_idx_r;
-    assign rob_complete_result = ex_result_r;
+    assign head_is_mem   = lsq_commit_pending && (lsq_commit_rob_idx == rob_head);
+    assign replay        = commit_valid[0] && head_is_mem && lsq_commit_violation;
+    assign lsq_commit_en = |(commit_ack & commit_mem);
 
-    // Wake-up: broadcast to issue queue
-    assign wakeup_en      = ex_valid_r && (ex_phys_rd_r != 0);
-    assign wakeup_phys_rd = ex_phys_rd_r;
+    logic [31:0] stat_replays;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_replays <= 32'd0;
+        end else if (replay) begin
+            stat_replays <= stat_replays + 1;
+        end
+    end
 
     // ========================================================================
     // READY TABLE - Track which physical registers have valid values
@@ -374,13 +1698,18 @@ module cpu_ooo (
             ready_table <= {32'b0, 32'hFFFFFFFF};  // [31:0] ready, [63:32] not ready
         end else begin
             // Clear ready bit when a new physical reg is allocated (rename)
-            if (rename_en && rename_phys_rd != 0) begin
-                ready_table[rename_phys_rd] <= 1'b0;
+            for (int k = 0; k < WIDTH; k++) begin
+                if (rename_alloc[k] && rename_phys_rd[k] != 0) begin
+                    ready_table[rename_phys_rd[k]] <= 1'b0;
+                end
             end
 
-            // Set ready bit when result is written (complete)
-            if (ex_valid_r && ex_phys_rd_r != 0) begin
-                ready_table[ex_phys_rd_r] <= 1'b1;
+            // Set ready bit when the result is announced (wakeup), so an
+            // instruction dispatched after the broadcast doesn't miss it
+            for (int p = 0; p < WAKEUP_PORTS; p++) begin
+                if (wakeup_en[p]) begin
+                    ready_table[wakeup_phys_rd[p]] <= 1'b1;
+                end
             end
         end
     end
@@ -388,23 +1717,195 @@ module cpu_ooo (
     // ========================================================================
     // COMMIT STAGE - Retire from ROB head in program order
     // ========================================================================
-    logic        commit_free_en;
-    logic [PHYS_REG_BITS-1:0] commit_free_reg;
-    logic        commit_rat_en;
-    logic [4:0]  commit_rat_rd;
-    logic [PHYS_REG_BITS-1:0] commit_rat_phys;
+    logic [RETIRE_WIDTH-1:0]       commit_free_en;
+    logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] commit_free_reg;
+    logic [RETIRE_WIDTH-1:0]       commit_rat_en;
+    logic [RETIRE_WIDTH-1:0][4:0]  commit_rat_rd;
+    logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] commit_rat_phys;
+    logic [RETIRE_WIDTH-1:0]       commit_alloc_en;  // Register came off the free list
+    logic [RETIRE_WIDTH-1:0]       commit_share_en;  // Eliminated move: one more sharer
+    logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] commit_share_reg;
+    logic                          commit_blocked;  // An older slot didn't retire
+    logic                          commit_mem_seen; // An older slot used the LSQ commit
+
+    // Auto-commit a run of finished entries from the head. Only one load or
+    // store per cycle (the LSQ commits its oldest entry), and a load that
+    // read stale data stops the run: at the head it replays instead.
+    always_comb begin
+        commit_blocked  = replay;
+        commit_mem_seen = 1'b0;
+        for (int r = 0; r < RETIRE_WIDTH; r++) begin
+            if (commit_mem[r] && (commit_mem_seen || lsq_commit_violation))
+                commit_blocked = 1'b1;
+            commit_ack[r] = commit_valid[r] && !commit_blocked;
+            if (!commit_ack[r])
+                commit_blocked = 1'b1;
+            if (commit_mem[r])
+                commit_mem_seen = 1'b1;
 
-    // Auto-commit when head is ready
-    assign commit_ack = commit_valid;
+            // Free the old physical register
+            commit_free_en[r]  = commit_ack[r] && (commit_old_phys_out[r] != 0) &&
+                                 (commit_rd_out[r] != 5'd0);
+            commit_free_reg[r] = commit_old_phys_out[r];
 
-    // Free the old physical register
-    assign commit_free_en  = commit_valid && (commit_old_phys_out != 0) &&
-                             (commit_rd_out != 5'd0);
-    assign commit_free_reg = commit_old_phys_out;
+            // Update committed RAT
+            commit_rat_en[r]   = commit_ack[r] && (commit_rd_out[r] != 5'd0);
+            commit_rat_rd[r]   = commit_rd_out[r];
+            commit_rat_phys[r] = commit_phys_rd_out[r];
+
+            // Eliminated instructions took no register: a move adds a
+            // sharer to its source's, a zero idiom maps to register 0
+            commit_alloc_en[r]  = commit_rat_en[r] && !commit_elim[r];
+            commit_share_en[r]  = commit_rat_en[r] && commit_elim[r] &&
+                                  (commit_phys_rd_out[r] != 0);
+            commit_share_reg[r] = commit_phys_rd_out[r];
+        end
+    end
+
+    // ========================================================================
+    // PERFORMANCE COUNTERS - cycle, instret, hpmcounter3-10
+    // ========================================================================
+    logic [5:0]                                 perf_retired;
+    logic [WIDTH-1:0][11:0]                     perf_csr_addr;
+    logic [WIDTH-1:0][ROB_IDX_BITS+4:0]         perf_pending;
 
-    // Update committed RAT
-    assign commit_rat_en   = commit_valid && (commit_rd_out != 5'd0);
-    assign commit_rat_rd   = commit_rd_out;
-    assign commit_rat_phys = commit_phys_rd_out;
+    // Retired: the committed entries' counts, the drops older than a load
+    // being replayed (its entry goes, but they did run), and drops with
+    // nothing older in flight
+    always_comb begin
+        perf_retired = 6'd0;
+        for (int r = 0; r < RETIRE_WIDTH; r++) begin
+            if (commit_ack[r])
+                perf_retired = perf_retired + commit_insts[r];
+        end
+        if (replay)
+            perf_retired = perf_retired + commit_insts[0] - 1;
+        if (!frontend_stall && !recover && !replay && !group_dispatch &&
+            rob_insts_in_flight == 0)
+            perf_retired = perf_retired + group_drops;
+    end
+
+    // A csrr in slot k comes after everything in the ROB, the drops
+    // waiting for a ROB entry and the group's older slots
+    always_comb begin
+        for (int k = 0; k < WIDTH; k++) begin
+            perf_csr_addr[k] = fd_instruction[k][31:20];
+            perf_pending[k]  = rob_insts_in_flight + pending_drop;
+            for (int j = 0; j < k; j++) begin
+                if (fd_valid[j])
+                    perf_pending[k] = perf_pending[k] + 1;
+            end
+        end
+    end
+
+    // There's no I-cache or load-use interlock here; a full issue queue or
+    // ROB counts when it holds up a group
+    perf_counters #(
+        .NUM_PORTS   (WIDTH),
+        .RETIRE_BITS (6),
+        .PENDING_BITS(ROB_IDX_BITS + 5),
+        .HPM_EVENTS  (HPM_EVENTS)
+    ) perf (
+        .clk             (clk),
+        .rst             (rst),
+        .retired         (perf_retired),
+        .events          ({group_dispatch && !rob_alloc_ready,    // ROB full
+                           group_dispatch && !iq_dispatch_ready,  // IQ full
+                           1'b0,                                  // Load-use stall
+                           recover,                               // Mispredict
+                           dc_miss,
+                           dc_hit,
+                           2'b00}),                               // I-cache
+        .csr_addr        (perf_csr_addr),
+        .instret_pending (perf_pending),
+        .csr_rdata       (csr_rdata)
+    );
+
+    // ========================================================================
+    // TOP-DOWN ACCOUNTING - Where each cycle's WIDTH dispatch slots went
+    // A slot holding an instruction counts as retiring when it leaves
+    // decode. If a recovery or replay squashes it later, it moves over to
+    // bad speculation, so the counters always add up to WIDTH * cycles.
+    // ========================================================================
+    logic [31:0] stat_td_frontend;      // Nothing fetched for the slot
+    logic [31:0] stat_td_bad_spec;      // Squashed, or lost to a recovery/replay
+    logic [31:0] stat_td_backend_mem;   // Group held up behind memory
+    logic [31:0] stat_td_backend_core;  // Group held up by a full ROB, IQ, free list...
+    logic [31:0] stat_td_retiring;
+    logic        td_refill;             // Waiting for the right path after a recovery/replay
+    logic        td_mem_bound;
+    logic [31:0] td_delivered;          // Slots of the group leaving decode
+    logic [31:0] td_squashed;           // Slots delivered earlier that a squash throws away
+
+    // Memory-bound: the LSQ is full, or the oldest instruction is a
+    // load/store that hasn't finished, so everything else backs up behind it
+    assign td_mem_bound = (group_has_mem && !lsq_alloc_ready) ||
+                          (rob_insts_in_flight != 0 && !commit_valid[0] && commit_mem[0]);
+
+    // A replay keeps the drops older than the head load: they retire
+    always_comb begin
+        td_delivered = 32'd0;
+        for (int k = 0; k < WIDTH; k++) begin
+            if (fd_valid[k])
+                td_delivered = td_delivered + 1;
+        end
+        td_squashed = replay ? rob_insts_in_flight - (commit_insts[0] - 1) + pending_drop :
+                               rob_squash_insts + pending_drop;
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            td_refill            <= 1'b0;
+            stat_td_frontend     <= 32'd0;
+            stat_td_bad_spec     <= 32'd0;
+            stat_td_backend_mem  <= 32'd0;
+            stat_td_backend_core <= 32'd0;
+            stat_td_retiring     <= 32'd0;
+        end else if (recover || replay) begin
+            td_refill        <= 1'b1;
+            stat_td_bad_spec <= stat_td_bad_spec + WIDTH + td_squashed;
+            stat_td_retiring <= stat_td_retiring - td_squashed;
+        end else if (frontend_stall) begin
+            if (td_mem_bound)
+                stat_td_backend_mem  <= stat_td_backend_mem + WIDTH;
+            else
+                stat_td_backend_core <= stat_td_backend_core + WIDTH;
+        end else begin
+            stat_td_retiring <= stat_td_retiring + td_delivered;
+            if (td_refill)
+                stat_td_bad_spec <= stat_td_bad_spec + WIDTH - td_delivered;
+            else
+                stat_td_frontend <= stat_td_frontend + WIDTH - td_delivered;
+            if (td_delivered != 0)
+                td_refill <= 1'b0;
+        end
+    end
+
+    // Retire statistics
+    logic [31:0] stat_cycles;
+    logic [31:0] stat_retired;
+    logic [31:0] stat_multi_retire;  // Cycles retiring more than one instruction
+    logic [31:0] retire_count;
+
+    always_comb begin
+        retire_count = 32'd0;
+        for (int r = 0; r < RETIRE_WIDTH; r++) begin
+            if (commit_ack[r])
+                retire_count = retire_count + 1;
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_cycles       <= 32'd0;
+            stat_retired      <= 32'd0;
+            stat_multi_retire <= 32'd0;
+        end else begin
+            stat_cycles  <= stat_cycles + 1;
+            stat_retired <= stat_retired + retire_count;
+            if (retire_count > 1)
+                stat_multi_retire <= stat_multi_retire + 1;
+        end
+    end
 
 endmodule
@@ -5,9 +5,36 @@
 // Features:
 //   - Forwarding Unit: Passes results from MEM/WB directly to EX when needed
 //   - Hazard Detection: Stalls pipeline for load-use hazards
-//   - Branch Prediction: 2-bit predictor with BTB to reduce branch penalties
-
-module cpu_pipelined (
+//   - Early Branch Resolution: branches resolve in EX, 2-cycle mispredict penalty
+//   - Decoupled Front End: predictor runs ahead into a fetch target queue,
+//     the I-cache prefetches from it and fills an instruction buffer
+//   - Predecode: IF computes JAL targets itself and redirects the predictor,
+//     so JALs stay out of the (set-associative, partial-tag) BTB
+//   - Per-Stage Stalls: an I-cache miss only stops fetch, a D-cache miss
+//     holds MEM and the stages behind it while WB drains
+//   - Branch Prediction: bimodal, gshare, tournament or TAGE predictor with BTB
+//   - Return Address Stack: predicts function returns, repaired on mispredict
+//   - Indirect Predictor: history-indexed targets for non-return JALR
+//   - Loop Predictor: learns trip counts, overrides the base predictor on exits
+//   - Macro-op Fusion: ID merges lui+addi, auipc+jalr and slt+beq/bne pairs
+//     from the instruction buffer into one op (see macro_fusion.sv)
+//   - M Extension: multiplies go to a 3-stage pipelined multiplier, divides
+//     to an iterative divider; EX holds the instruction until its result is
+//     back, and MEM takes bubbles meanwhile
+//   - C Extension: fetch works on halfword-aligned PCs and expands 16-bit
+//     instructions before the instruction buffer (see rvc_expander.sv); a
+//     length table tells BP whether to step by 2 or 4
+//   - Performance Counters: cycle, instret and hpmcounter3-10 read with
+//     csrr in EX (see perf_counters.sv); each stage carries how many
+//     instructions it holds, so instret counts fused pairs as two
+//   - Top-Down Accounting: every cycle's issue slot (ID -> EX) is put down
+//     to the front end, bad speculation, the memory or core back end, or
+//     retiring; the five counters add up to the cycle count
+
+module cpu_pipelined #(
+    parameter BP_TYPE = 2,  // Direction predictor: 0 = bimodal, 1 = gshare, 2 = tournament, 3 = TAGE
+    parameter [31:0] HPM_EVENTS = 32'h87654321  // Event per hpmcounter (see perf_counters.sv)
+)(
     input  logic clk,
     input  logic rst
 );
@@ -16,23 +43,135 @@ module cpu_pipelined (
     // Wire declarations for each stage
     // ============================================================
 
-    // IF stage signals
+    // BP stage signals (branch prediction, runs ahead of fetch)
+    logic [31:0] bp_pc;
+    logic [31:0] bp_pc_next;
+    logic [31:0] bp_pc_plus4;         // Next sequential PC (+2 when compressed)
+    logic        bp_rvc;              // Length table: BP's instruction is compressed
+    logic        bp_advance;          // Prediction leaves BP this cycle
+    logic        bp_predict_taken;    // Final prediction (direction + BTB + RAS)
+    logic [31:0] bp_predict_target;
+    logic        bp_dir_taken;        // Direction predictor output
+    logic        bp_loop_valid;       // Loop predictor is confident
+    logic        bp_loop_taken;
+    logic [7:0][7:0] bp_loop_ckpt;    // Loop predictor checkpoint (every entry's count)
+    logic        bp_btb_hit;
+    logic [31:0] bp_btb_target;
+    logic [1:0]  bp_btb_type;
+    logic        bp_btb_branch;       // BTB says BP holds a conditional branch
+    logic [31:0] bp_history;
+    logic        bp_predict_en;
+    logic        bp_restore_en;       // Roll the GHR back (non-branch redirect)
+    logic [31:0] bp_restore_history;
+    logic        bp_ras_push;
+    logic        bp_ras_pop;
+    logic [31:0] bp_ras_top_addr;
+    logic [3:0]  bp_ras_ptr;
+    logic [31:0] bp_ras_top;
+    logic        bp_ind_hit;
+    logic [31:0] bp_ind_target;
+
+    // Fetch target queue (BP -> IF)
+    localparam FTQ_WIDTH = 199;       // pc, taken, target, history, RAS ptr/top, loop ckpt, length, branch
+    logic [FTQ_WIDTH-1:0] bp_ftq_entry;
+    logic [FTQ_WIDTH-1:0] ftq_head;
+    logic [FTQ_WIDTH-1:0] ftq_tail;
+    logic        ftq_empty;
+    logic        ftq_full;
+    logic        ftq_enq;
+    logic        ftq_deq;
+    logic [31:0] ftq_tail_pc;
+
+    // IF stage signals (head of the FTQ, or straight from BP when it's empty)
     logic [31:0] if_pc;
-    logic [31:0] if_pc_next;
-    logic [31:0] if_pc_plus4;
     logic [31:0] if_instruction;
     logic        if_predict_taken;
     logic [31:0] if_predict_target;
-    logic        if_btb_hit;
-
-    // ID stage signals (from IF/ID register)
+    logic [31:0] if_bp_history;
+    logic [3:0]  if_ras_ptr;
+    logic [31:0] if_ras_top;
+    logic [7:0][7:0] if_loop_ckpt;
+    logic        if_rvc_guess;        // BP stepped over it as a compressed instruction
+    logic        if_btb_branch;       // BP predicted it as a conditional branch
+    logic        if_fetch;            // Instruction goes into the buffer this cycle
+
+    // IF halfword fetch: an instruction at PC bit 1 = 1 starts in the upper
+    // half of a word, and a 32-bit one continues into the next word (maybe
+    // the next cache line). The last word read is kept for that case.
+    localparam LEN_TABLE_SIZE = 256;  // Instruction length table entries
+    logic [31:0] if_icache_addr;      // Word IF reads from the I-cache
+    logic [31:0] if_word;             // ...and what it got
+    logic        if_prev_valid;       // Last word read
+    logic [31:0] if_prev_addr;
+    logic [31:0] if_prev_word;
+    logic        if_prev_hit;         // The word holding PC was the last one read
+    logic [15:0] if_parcel;           // First halfword of the instruction
+    logic [31:0] if_raw;              // Instruction as fetched (compressed in [15:0])
+    logic        if_rvc;              // It's a compressed instruction
+    logic        if_split;            // 32-bit instruction across two words, first not read yet
+    logic [31:0] if_pc_next;          // PC + 2 or PC + 4
+    logic        len_table [0:LEN_TABLE_SIZE-1];
+
+    // IF predecode
+    logic        if_pd_jal;           // Direct jump: target known from the bits
+    logic        if_pd_call;          // JAL or JALR that links (rd = x1/x5)
+    logic        if_pd_branch;        // Conditional branch
+    logic [31:0] if_pd_jal_target;
+    logic        if_pd_cf;            // Any branch or jump
+    logic        if_pd_taken;         // Prediction after predecode
+    logic [31:0] if_pd_target;
+    logic        if_false_hit;        // BTB alias predicted a non-branch taken
+    logic        if_redirect;         // Predecode disagrees with BP: refetch
+    logic        if_len_redirect;     // ...because BP guessed the length wrong
+    logic        if_keep_not_taken;   // ...on a branch BP predicted not taken
+    logic [31:0] if_redirect_pc;
+
+    // Return address stack repair (EX misprediction or IF redirect)
+    logic        ras_repair_en;
+    logic [3:0]  ras_repair_ptr;
+    logic [31:0] ras_repair_top;
+    logic        ras_repair_push;
+    logic        ras_repair_pop;
+    logic [31:0] ras_repair_push_addr;
+
+    // Instruction buffer (IF -> ID)
+    localparam IB_WIDTH = 166;        // FTQ entry + instruction + length
+    logic [IB_WIDTH-1:0] ib_head;
+    logic [IB_WIDTH-1:0] ib_next;     // Entry behind the head
+    logic        ib_pair;             // Head and next are both there
+    logic        ib_empty;
+    logic        ib_full;
+    logic        id_advance;          // ID consumes the buffer head this cycle
+    logic [31:0] id_ib_instruction;
+    logic        id_ib_predict_taken;
+
+    // Macro-op fusion (ID looks at the head and the entry behind it)
+    logic        id_fuse;             // ID takes the pair as one op
+    logic        fu_fuse;
+    logic [1:0]  fu_kind;
+    logic [4:0]  fu_rs1, fu_rs2, fu_rd;
+    logic [31:0] fu_imm;
+    logic [4:0]  fu_alu_op;
+    logic        fu_alu_src;
+    logic [2:0]  fu_branch_type;
+    logic [IB_WIDTH-1:0] id_entry;    // Head, or next when fusing
+
+    // Decoder outputs (before fusion and U-type fix-ups)
+    logic [4:0]  dec_rs1, dec_rs2, dec_rd;
+    logic [31:0] dec_imm;
+    logic [4:0]  dec_alu_op;
+    logic        dec_alu_src;
+    logic        dec_reg_write;
+    logic [2:0]  dec_branch_type;
+
+    // ID stage signals (from the instruction buffer)
     logic [31:0] id_pc;
     logic [31:0] id_instruction;
     logic [31:0] id_read_data1;
     logic [31:0] id_read_data2;
     logic [31:0] id_imm;
     logic [4:0]  id_rs1, id_rs2, id_rd;
-    logic [3:0]  id_alu_op;
+    logic [4:0]  id_alu_op;
     logic        id_alu_src;
     logic        id_reg_write;
     logic        id_mem_read;
@@ -43,15 +182,24 @@ module cpu_pipelined (
     logic        id_jump;
     logic        id_predict_taken;
     logic [31:0] id_predict_target;
+    logic [31:0] id_bp_history;
+    logic [3:0]  id_ras_ptr;
+    logic [31:0] id_ras_top;
+    logic [1:0]  id_cf_type;
+    logic        id_muldiv;
+    logic        id_rvc;              // Expanded from a compressed instruction
+    logic        id_csr;              // Counter CSR read
+    logic [1:0]  id_insts;            // Instructions this op stands for (0 = bubble)
 
     // EX stage signals (from ID/EX register)
     logic [31:0] ex_pc;
-    logic [31:0] ex_pc_plus4;
+    logic [31:0] ex_pc_plus4;         // Next sequential PC (+2 when compressed)
+    logic        ex_rvc;
     logic [31:0] ex_read_data1;
     logic [31:0] ex_read_data2;
     logic [31:0] ex_imm;
     logic [4:0]  ex_rs1, ex_rs2, ex_rd;
-    logic [3:0]  ex_alu_op;
+    logic [4:0]  ex_alu_op;
     logic        ex_alu_src;
     logic        ex_reg_write;
     logic        ex_mem_read;
@@ -62,12 +210,28 @@ module cpu_pipelined (
     logic        ex_jump;
     logic        ex_predict_taken;
     logic [31:0] ex_predict_target;
+    logic [31:0] ex_bp_history;
+    logic [3:0]  ex_ras_ptr;
+    logic [31:0] ex_ras_top;
+    logic [1:0]  ex_cf_type;
+    logic        ex_muldiv;           // Multiply/divide (funct3 in ex_muldiv_op)
+    logic [2:0]  ex_muldiv_op;
+    logic        ex_csr;
+    logic [1:0]  ex_insts;
+    logic [31:0] ex_csr_rdata;
+    logic [31:0] ex_result;           // ALU, multiply/divide or CSR result
+    logic        ex_indirect;
     logic [31:0] ex_alu_operand_a;
     logic [31:0] ex_alu_operand_b;
     logic [31:0] ex_alu_operand_b_fwd;
     logic [31:0] ex_alu_result;
-    logic        ex_alu_zero;
     logic [31:0] ex_branch_target;
+    logic        ex_branch_condition;
+    logic        ex_actual_taken;
+    logic        ex_mispredicted;
+    logic [31:0] ex_correct_pc;
+    logic        ex_branch_update;   // Branch/jump resolving this cycle
+    logic        ex_redirect;        // Resolved and mispredicted: refetch
 
     // MEM stage signals (from EX/MEM register)
     logic [31:0] mem_pc;
@@ -75,20 +239,13 @@ module cpu_pipelined (
     logic [31:0] mem_alu_result;
     logic [31:0] mem_read_data2;
     logic [4:0]  mem_rd;
-    logic        mem_zero;
-    logic [31:0] mem_branch_target;
-    logic        mem_predict_taken;
     logic        mem_reg_write;
     logic        mem_mem_read;
     logic        mem_mem_write;
     logic        mem_mem_to_reg;
-    logic        mem_branch;
-    logic [2:0]  mem_branch_type;
     logic        mem_jump;
+    logic [1:0]  mem_insts;
     logic [31:0] mem_data_read;
-    logic        mem_actual_taken;
-    logic        mem_mispredicted;
-    logic [31:0] mem_correct_pc;
     logic [31:0] mem_write_back_data;
 
     // WB stage signals (from MEM/WB register)
@@ -99,19 +256,22 @@ module cpu_pipelined (
     logic        wb_reg_write;
     logic        wb_mem_to_reg;
     logic        wb_jump;
+    logic [1:0]  wb_insts;
     logic [31:0] wb_write_data;
 
     // Hazard control signals
-    logic        stall_if;
     logic        stall_id;
     logic        flush_ex;
-    logic        flush_if_id;
     logic        flush_id_ex;
 
     // Cache signals
     logic        icache_stall;
     logic        dcache_stall;
-    logic        cache_stall;       // Global stall from cache misses
+    logic        icache_hit, icache_miss;
+    logic        dcache_hit, dcache_miss;
+    logic        stall_mem;         // MEM waiting on the D-cache
+    logic        stall_ex;          // EX can't move into a held MEM
+    logic        ex_md_wait;        // EX waiting on the multiply/divide unit
     logic [31:0] imem_addr;
     logic        imem_read_en;
     logic [31:0] imem_read_data;
@@ -127,20 +287,112 @@ module cpu_pipelined (
     logic [1:0]  forward_a;
     logic [1:0]  forward_b;
 
+    // Branch prediction statistics
+    logic [31:0] bp_stat_branches;
+    logic [31:0] bp_stat_mispredicts;
+    logic [31:0] ind_stat_jumps;
+    logic [31:0] ind_stat_hits;
+    logic [31:0] ind_stat_mispredicts;
+    logic [31:0] loop_stat_predictions;
+    logic [31:0] loop_stat_wrong;
+
+    // Stall statistics
+    logic [31:0] stat_cycles;
+    logic [31:0] stat_icache_stall;   // Cycles fetch waited on the I-cache
+    logic [31:0] stat_dcache_stall;   // Cycles MEM waited on the D-cache
+    logic [31:0] stat_stall_overlap;  // ...both at once
+
+    // Fusion statistics
+    logic [31:0] stat_fused_li;       // lui + addi
+    logic [31:0] stat_fused_call;     // auipc + jalr
+    logic [31:0] stat_fused_cmp_br;   // slt/sltu + beq/bne
+
+    // Multiply/divide statistics
+    logic [31:0] stat_mul_ops;        // Multiplies executed
+    logic [31:0] stat_div_ops;        // Divides and remainders executed
+    logic [31:0] stat_muldiv_stall;   // Cycles EX waited on the unit
+
+    // Top-down accounting (one issue slot per cycle)
+    logic [31:0] stat_td_frontend;     // Buffer empty: I-cache miss or fetch bubble
+    logic [31:0] stat_td_bad_spec;     // Mispredict flush and the refill after it
+    logic [31:0] stat_td_backend_mem;  // D-cache stall or load-use bubble
+    logic [31:0] stat_td_backend_core; // EX waiting on the multiply/divide unit
+    logic [31:0] stat_td_retiring;     // An instruction (or fused pair) issued
+
+    // Compressed instruction statistics
+    logic [31:0] stat_rvc_fetched;    // Compressed instructions fetched
+    logic [31:0] stat_fetch_split;    // Extra reads for instructions across two words
+    logic [31:0] stat_len_redirect;   // IF redirects for a wrong length guess
+
 
     // ============================================================
     // Branch Predictor
     // ============================================================
 
-    branch_predictor bp_inst (
-        .clk           (clk),
-        .rst           (rst),
-        .pc_if         (if_pc),
-        .predict_taken (if_predict_taken),
-        .update_en     (mem_branch || mem_jump),
-        .update_pc     (mem_pc),
-        .actual_taken  (mem_actual_taken)
-    );
+    // Control-flow types (BTB / decoder encoding)
+    localparam CF_BRANCH = 2'b00;
+    localparam CF_JUMP   = 2'b01;
+    localparam CF_CALL   = 2'b10;
+    localparam CF_RETURN = 2'b11;
+
+    // Only a BTB hit tells us BP holds a branch, so only those shift the
+    // global history, once the prediction actually leaves BP. Jumps stay
+    // out of it on both paths: they don't shift here, they don't train the
+    // direction tables, and a mispredicted one restores its checkpoint
+    // rather than appending its outcome.
+    assign bp_btb_branch = bp_btb_hit && (bp_btb_type == CF_BRANCH);
+    assign bp_predict_en = bp_btb_branch && bp_advance;
+
+    // EX is older, so its restore wins. A branch that only redirects for
+    // its length keeps its not-taken outcome in the history.
+    assign bp_restore_en      = (ex_redirect && !ex_branch) || if_redirect;
+    assign bp_restore_history = ex_redirect       ? ex_bp_history :
+                                if_keep_not_taken ? {if_bp_history[30:0], 1'b0} :
+                                                    if_bp_history;
+
+    generate
+        if (BP_TYPE == 3) begin : g_tage
+            tage_predictor bp_inst (
+                .clk             (clk),
+                .rst             (rst),
+                .pc_if           (bp_pc),
+                .predict_taken   (bp_dir_taken),
+                .predict_en      (bp_predict_en),
+                .predict_final   (bp_predict_taken),
+                .predict_history (bp_history),
+                .update_en       (ex_branch_update && ex_branch),
+                .update_pc       (ex_pc),
+                .actual_taken    (ex_actual_taken),
+                .update_history  (ex_bp_history),
+                .mispredict      (ex_mispredicted),
+                .restore_en      (bp_restore_en),
+                .restore_history (bp_restore_history),
+                .stat_branches   (bp_stat_branches),
+                .stat_mispredicts(bp_stat_mispredicts)
+            );
+        end else begin : g_counter
+            branch_predictor #(
+                .PREDICTOR(BP_TYPE)
+            ) bp_inst (
+                .clk             (clk),
+                .rst             (rst),
+                .pc_if           (bp_pc),
+                .predict_taken   (bp_dir_taken),
+                .predict_en      (bp_predict_en),
+                .predict_final   (bp_predict_taken),
+                .predict_history (bp_history),
+                .update_en       (ex_branch_update && ex_branch),
+                .update_pc       (ex_pc),
+                .actual_taken    (ex_actual_taken),
+                .update_history  (ex_bp_history),
+                .mispredict      (ex_mispredicted),
+                .restore_en      (bp_restore_en),
+                .restore_history (bp_restore_history),
+                .stat_branches   (bp_stat_branches),
+                .stat_mispredicts(bp_stat_mispredicts)
+            );
+        end
+    endgenerate
 
 
     // ============================================================
@@ -150,13 +402,121 @@ module cpu_pipelined (
     branch_target_buffer btb_inst (
         .clk             (clk),
         .rst             (rst),
-        .pc_if           (if_pc),
-        .btb_hit         (if_btb_hit),
-        .btb_target      (if_predict_target),
-        .update_en       (mem_branch || mem_jump),
-        .update_pc       (mem_pc),
-        .update_target   (mem_branch_target),
-        .update_is_branch(mem_branch || mem_jump)
+        .pc_if           (bp_pc),
+        .btb_hit         (bp_btb_hit),
+        .btb_target      (bp_btb_target),
+        .btb_type        (bp_btb_type),
+        .update_en       (ex_branch_update),
+        .update_pc       (ex_pc),
+        .update_target   (ex_branch_target),
+        .update_is_branch(ex_branch || (ex_jump && ex_alu_src)),  // Not JAL
+        .update_type     (ex_cf_type),
+        .invalidate_en   (if_false_hit),
+        .invalidate_pc   (if_pc)
+    );
+
+
+    // ============================================================
+    // Return Address Stack
+    // ============================================================
+
+    // JALR calls and returns are recognised from the BTB type, so they only
+    // push/pop once the BTB has seen them. The first encounter mispredicts
+    // and the repair path replays the push/pop instead. JAL calls never
+    // reach the BTB: IF's predecode redirect replays their push. BP pushes
+    // PC + its length guess, so a call whose length it guessed wrong is
+    // redirected in IF too, and the repair pushes the real PC + 2/4.
+    assign bp_ras_push = bp_btb_hit && (bp_btb_type == CF_CALL) && bp_advance;
+    assign bp_ras_pop  = bp_btb_hit && (bp_btb_type == CF_RETURN) && bp_advance;
+
+    // EX is older, so its repair wins
+    always_comb begin
+        if (ex_redirect) begin
+            ras_repair_en        = 1'b1;
+            ras_repair_ptr       = ex_ras_ptr;
+            ras_repair_top       = ex_ras_top;
+            ras_repair_push      = (ex_cf_type == CF_CALL);
+            ras_repair_pop       = (ex_cf_type == CF_RETURN);
+            ras_repair_push_addr = ex_pc_plus4;
+        end else begin
+            ras_repair_en        = if_redirect;
+            ras_repair_ptr       = if_ras_ptr;
+            ras_repair_top       = if_ras_top;
+            ras_repair_push      = if_pd_call;
+            ras_repair_pop       = 1'b0;
+            ras_repair_push_addr = if_pc_next;
+        end
+    end
+
+    return_address_stack ras_inst (
+        .clk             (clk),
+        .rst             (rst),
+        .push_en         (bp_ras_push),
+        .push_addr       (bp_pc_plus4),
+        .pop_en          (bp_ras_pop),
+        .top_addr        (bp_ras_top_addr),
+        .ckpt_ptr        (bp_ras_ptr),
+        .ckpt_top        (bp_ras_top),
+        .repair_en       (ras_repair_en),
+        .repair_ptr      (ras_repair_ptr),
+        .repair_top      (ras_repair_top),
+        .repair_push     (ras_repair_push),
+        .repair_pop      (ras_repair_pop),
+        .repair_push_addr(ras_repair_push_addr)
+    );
+
+
+    // ============================================================
+    // Indirect Target Predictor
+    // ============================================================
+
+    indirect_predictor ind_inst (
+        .clk              (clk),
+        .rst              (rst),
+        .pc_if            (bp_pc),
+        .history_if       (bp_history),
+        .hit              (bp_ind_hit),
+        .target           (bp_ind_target),
+        .update_en        (ex_branch_update && ex_indirect),
+        .update_pc        (ex_pc),
+        .update_history   (ex_bp_history),
+        .update_target    (ex_branch_target),
+        .update_mispredict(ex_mispredicted),
+        .stat_jumps       (ind_stat_jumps),
+        .stat_hits        (ind_stat_hits),
+        .stat_mispredicts (ind_stat_mispredicts)
+    );
+
+
+    // ============================================================
+    // Loop Predictor
+    // ============================================================
+
+    // Sits on top of whichever direction predictor BP_TYPE selected and
+    // overrides it for confident loop branches. Its checkpoint rides in
+    // the FTQ, so an IF redirect can take back the iterations counted for
+    // the predictions it flushes (an EX redirect resyncs from committed
+    // state instead).
+    loop_predictor loop_inst (
+        .clk             (clk),
+        .rst             (rst),
+        .pc_if           (bp_pc),
+        .predict_valid   (bp_loop_valid),
+        .predict_taken   (bp_loop_taken),
+        .predict_en      (bp_predict_en),
+        .predict_final   (bp_predict_taken),
+        .ckpt_iter       (bp_loop_ckpt),
+        .restore_en      (if_redirect),
+        .restore_iter    (if_loop_ckpt),
+        .restore_pc      (if_pc),
+        .restore_not_taken(if_keep_not_taken),
+        .update_en       (ex_branch_update && ex_branch),
+        .update_pc       (ex_pc),
+        .update_backward (ex_branch_target < ex_pc),
+        .actual_taken    (ex_actual_taken),
+        .mispredict      (ex_redirect),
+        .stat_predictions(loop_stat_predictions),
+        .stat_wrong      (loop_stat_wrong)
     );
 
 
@@ -164,8 +524,35 @@ module cpu_pipelined (
     // Cache Stall Logic
     // ============================================================
 
-    // Cache miss freezes the entire pipeline
-    assign cache_stall = icache_stall || dcache_stall;
+    // Each stage stalls only for its own reasons:
+    // - BP:  FTQ full
+    // - IF:  I-cache miss or instruction buffer full
+    // - ID:  load-use hazard, or EX held
+    // - EX:  MEM held, or a multiply/divide still computing
+    // - MEM: D-cache miss
+    // - WB:  never; it gets a bubble while MEM is held
+    // So an I-cache miss just starves ID of instructions while everything
+    // already in flight keeps going, and a D-cache miss lets the front end
+    // keep fetching into the buffer behind it.
+    assign stall_mem = dcache_stall;
+    assign stall_ex  = stall_mem || ex_md_wait;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_cycles        <= 32'd0;
+            stat_icache_stall  <= 32'd0;
+            stat_dcache_stall  <= 32'd0;
+            stat_stall_overlap <= 32'd0;
+        end else begin
+            stat_cycles <= stat_cycles + 1;
+            if (icache_stall)
+                stat_icache_stall <= stat_icache_stall + 1;
+            if (dcache_stall)
+                stat_dcache_stall <= stat_dcache_stall + 1;
+            if (icache_stall && dcache_stall)
+                stat_stall_overlap <= stat_stall_overlap + 1;
+        end
+    end
 
 
     // ============================================================
@@ -177,7 +564,7 @@ module cpu_pipelined (
         .id_rs2      (id_rs2),
         .ex_rd       (ex_rd),
         .ex_mem_read (ex_mem_read),
-        .stall_if    (stall_if),
+        .stall_if    (),            // IF runs ahead into the instruction buffer
         .stall_id    (stall_id),
         .flush_ex    (flush_ex)
     );
@@ -200,47 +587,227 @@ module cpu_pipelined (
 
 
     // ============================================================
-    // IF Stage: Instruction Fetch with Branch Prediction
+    // BP Stage: Branch Prediction (runs ahead of fetch)
     // ============================================================
 
-    assign if_pc_plus4 = if_pc + 32'd4;
+    // Nothing has been decoded yet at BP, so the length table guesses the
+    // instruction's size from what IF last fetched at this PC. IF checks the
+    // guess and redirects BP when it was wrong.
+    assign bp_rvc      = len_table[bp_pc[$clog2(LEN_TABLE_SIZE):1]];
+    assign bp_pc_plus4 = bp_pc + (bp_rvc ? 32'd2 : 32'd4);
+
+    // Final prediction: jumps are always taken once the BTB knows them,
+    // conditional branches ask the loop predictor if it's confident and the
+    // direction predictor otherwise. Returns take their
+    // target from the return address stack, and indirect jumps from the
+    // indirect predictor when it has one, instead of the BTB.
+    assign bp_predict_taken  = bp_btb_hit &&
+                               ((bp_btb_type != CF_BRANCH) ||
+                                (bp_loop_valid ? bp_loop_taken : bp_dir_taken));
+    always_comb begin
+        if (bp_btb_type == CF_RETURN)
+            bp_predict_target = bp_ras_top_addr;
+        else if (bp_btb_type != CF_BRANCH && bp_ind_hit)
+            bp_predict_target = bp_ind_target;
+        else
+            bp_predict_target = bp_btb_target;
+    end
+
+    // BP moves on whenever the FTQ has room (or IF takes the prediction
+    // directly), independent of what the backend is doing
+    assign bp_advance = !ex_redirect && !if_redirect && !ftq_full;
 
     // PC selection logic:
-    // 1. If mispredicted in MEM stage, use correct PC
-    // 2. If predicted taken and BTB hit, use predicted target
-    // 3. Otherwise, use PC + 4
+    // 1. If mispredicted in EX stage, use correct PC
+    // 2. If IF's predecode disagrees with the prediction, use its PC
+    // 3. If predicted taken and BTB hit, use predicted target
+    // 4. Otherwise, use PC + 4 (PC + 2 for a compressed instruction)
     always_comb begin
-        if (mem_mispredicted) begin
-            if_pc_next = mem_correct_pc;
-        end else if (if_predict_taken && if_btb_hit && !stall_if) begin
-            if_pc_next = if_predict_target;
+        if (ex_redirect) begin
+            bp_pc_next = ex_correct_pc;
+        end else if (if_redirect) begin
+            bp_pc_next = if_redirect_pc;
+        end else if (bp_predict_taken) begin
+            bp_pc_next = bp_predict_target;
         end else begin
-            if_pc_next = if_pc_plus4;
+            bp_pc_next = bp_pc_plus4;
         end
     end
 
-    // Program Counter (with stall support - hazard OR cache stall)
+    // Program Counter (held while the FTQ is full)
     program_counter pc_inst (
         .clk     (clk),
         .rst     (rst),
-        .stall   (stall_if || cache_stall),
-        .pc_next (if_pc_next),
-        .pc      (if_pc)
+        .stall   (!bp_advance && !ex_redirect && !if_redirect),
+        .pc_next (bp_pc_next),
+        .pc      (bp_pc)
+    );
+
+
+    // ============================================================
+    // Fetch Target Queue
+    // ============================================================
+
+    assign bp_ftq_entry = {bp_pc, bp_predict_taken, bp_predict_target,
+                           bp_history, bp_ras_ptr, bp_ras_top,
+                           bp_loop_ckpt, bp_rvc, bp_btb_branch};
+
+    // An empty FTQ is bypassed: IF fetches the prediction BP is making right
+    // now. Otherwise BP queues its prediction behind the older ones.
+    assign ftq_enq = bp_advance && !(ftq_empty && if_fetch);
+    assign ftq_deq = if_fetch && !ftq_empty;
+
+    fetch_queue #(
+        .WIDTH(FTQ_WIDTH),
+        .DEPTH(8)
+    ) ftq_inst (
+        .clk       (clk),
+        .rst       (rst),
+        .flush     (ex_redirect || if_redirect),
+        .enq_en    (ftq_enq),
+        .enq_data  (bp_ftq_entry),
+        .deq_en    (ftq_deq),
+        .deq_pair  (1'b0),
+        .head_data (ftq_head),
+        .next_data (),
+        .tail_data (ftq_tail),
+        .empty     (ftq_empty),
+        .pair      (),
+        .full      (ftq_full)
+    );
+
+    assign ftq_tail_pc = ftq_tail[FTQ_WIDTH-1 -: 32];
+
+
+    // ============================================================
+    // IF Stage: Instruction Fetch
+    // ============================================================
+
+    assign {if_pc, if_predict_taken, if_predict_target, if_bp_history,
+            if_ras_ptr, if_ras_top, if_loop_ckpt, if_rvc_guess, if_btb_branch} = ftq_empty ? bp_ftq_entry : ftq_head;
+
+    // Halfword fetch. PC bit 1 = 0: the instruction starts at the bottom of
+    // the word read. PC bit 1 = 1: it starts in the upper half, which is
+    // usually still in if_prev_word from fetching the instruction before it;
+    // a 32-bit one then reads the next word for its upper half. Coming in
+    // cold (after a redirect), the first word is read on its own cycle.
+    assign if_prev_hit    = if_prev_valid && (if_prev_addr == {if_pc[31:2], 2'b00});
+    assign if_icache_addr = (if_pc[1] && if_prev_hit && (if_prev_word[17:16] == 2'b11)) ?
+                            {if_pc[31:2], 2'b00} + 32'd4 : {if_pc[31:2], 2'b00};
+
+    always_comb begin
+        if (!if_pc[1]) begin
+            if_parcel = if_word[15:0];
+            if_raw    = if_word;
+        end else if (if_prev_hit) begin
+            if_parcel = if_prev_word[31:16];
+            if_raw    = {if_word[15:0], if_prev_word[31:16]};
+        end else begin
+            if_parcel = if_word[31:16];
+            if_raw    = {16'd0, if_word[31:16]};
+        end
+    end
+
+    assign if_split   = if_pc[1] && !if_prev_hit && !if_rvc;
+    assign if_pc_next = if_pc + (if_rvc ? 32'd2 : 32'd4);
+
+    // Expand compressed instructions here, so predecode, the buffer and
+    // the decoder only ever see 32-bit ones
+    rvc_expander rvc_inst (
+        .instruction (if_raw),
+        .expanded    (if_instruction),
+        .compressed  (if_rvc)
     );
 
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            if_prev_valid <= 1'b0;
+            if_prev_addr  <= 32'd0;
+            if_prev_word  <= 32'd0;
+        end else if (!ex_redirect && !icache_stall) begin
+            if_prev_valid <= 1'b1;
+            if_prev_addr  <= if_icache_addr;
+            if_prev_word  <= if_word;
+        end
+    end
+
+    // Length table: remember how long the instruction at each PC was
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            for (int i = 0; i < LEN_TABLE_SIZE; i++)
+                len_table[i] <= 1'b0;
+        end else if (if_fetch) begin
+            len_table[if_pc[$clog2(LEN_TABLE_SIZE):1]] <= if_rvc;
+        end
+    end
+
+    // Fetch into the instruction buffer on a hit, as long as there's room
+    assign if_fetch = !ex_redirect && !icache_stall && !ib_full && !if_split;
+
+    // Predecode: a JAL's target is right there in the instruction, so IF
+    // fixes the prediction itself instead of keeping JALs in the BTB. A
+    // taken prediction for something that isn't a branch at all comes from
+    // a partial-tag alias in the BTB; drop it and evict the entry. If BP
+    // guessed the length wrong, the next PC it went on to is wrong too, and
+    // so is the return address it pushed for a call, taken or not.
+    assign if_pd_jal        = (if_instruction[6:0] == 7'b1101111);
+    assign if_pd_branch     = (if_instruction[6:0] == 7'b1100011);
+    assign if_pd_call       = (if_pd_jal || if_instruction[6:0] == 7'b1100111) &&
+                              (if_instruction[11:7] == 5'd1 || if_instruction[11:7] == 5'd5);
+    assign if_pd_jal_target = if_pc + {{12{if_instruction[31]}}, if_instruction[19:12],
+                                       if_instruction[20], if_instruction[30:21], 1'b0};
+    assign if_pd_cf         = if_pd_jal || if_pd_branch ||
+                              (if_instruction[6:0] == 7'b1100111);    // JALR
+
+    assign if_pd_taken  = if_pd_jal || (if_pd_cf && if_predict_taken);
+    assign if_pd_target = if_pd_jal ? if_pd_jal_target : if_predict_target;
+
+    assign if_false_hit    = if_fetch && !if_pd_cf && if_predict_taken;
+    assign if_len_redirect = if_fetch && (if_rvc != if_rvc_guess) && (!if_pd_taken || if_pd_call);
+    assign if_redirect     = if_len_redirect ||
+                             (if_fetch &&
+                              ((if_pd_jal && !(if_predict_taken && if_predict_target == if_pd_jal_target)) ||
+                               (!if_pd_cf && if_predict_taken)));
+    assign if_redirect_pc  = if_pd_taken ? if_pd_target : if_pc_next;
+
+    // Only a length redirect gets here for a conditional branch, and only
+    // with a not-taken prediction: the restore keeps that outcome
+    assign if_keep_not_taken = if_btb_branch && if_pd_branch;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_rvc_fetched  <= 32'd0;
+            stat_fetch_split  <= 32'd0;
+            stat_len_redirect <= 32'd0;
+        end else begin
+            if (if_fetch && if_rvc)
+                stat_rvc_fetched <= stat_rvc_fetched + 1;
+            if (if_split && !ex_redirect && !icache_stall)
+                stat_fetch_split <= stat_fetch_split + 1;
+            if (if_len_redirect)
+                stat_len_redirect <= stat_len_redirect + 1;
+        end
+    end
+
     // Instruction Cache
+    // The youngest FTQ entry is as far ahead as the predictor has got, so
+    // that's the line to prefetch while IF works through the older ones.
     cache #(
         .CACHE_SIZE_BYTES(256),
         .LINE_SIZE_BYTES(16)
     ) icache (
         .clk            (clk),
         .rst            (rst),
-        .cpu_addr       (if_pc),
+        .cpu_addr       (if_icache_addr),
         .cpu_write_data (32'd0),
-        .cpu_read_en    (1'b1),         // Always reading instructions
+        .cpu_read_en    (!ex_redirect), // Always reading instructions (unless refetching)
         .cpu_write_en   (1'b0),         // Never write to I-cache from CPU
-        .cpu_read_data  (if_instruction),
+        .cpu_read_data  (if_word),
         .cpu_stall      (icache_stall),
+        .event_hit      (icache_hit),
+        .event_miss     (icache_miss),
+        .prefetch_en    (!ftq_empty),
+        .prefetch_addr  (ftq_tail_pc),
         .mem_addr       (imem_addr),
         .mem_read_en    (imem_read_en),
         .mem_write_en   (),             // Not used for I-cache
@@ -266,27 +833,62 @@ module cpu_pipelined (
 
 
     // ============================================================
-    // IF/ID Pipeline Register
+    // Instruction Buffer (replaces the IF/ID register)
     // ============================================================
 
-    // Flush IF/ID on misprediction
-    assign flush_if_id = mem_mispredicted;
+    // ID takes the head whenever it isn't stalled. Flushed on misprediction.
+    assign id_advance = !ib_empty && !stall_id && !stall_ex;
+
+    fetch_queue #(
+        .WIDTH(IB_WIDTH),
+        .DEPTH(4)
+    ) ib_inst (
+        .clk       (clk),
+        .rst       (rst),
+        .flush     (ex_redirect),
+        .enq_en    (if_fetch),
+        .enq_data  ({if_pc, if_instruction, if_pd_taken, if_pd_target,
+                     if_bp_history, if_ras_ptr, if_ras_top, if_rvc}),
+        .deq_en    (id_advance),
+        .deq_pair  (id_fuse),
+        .head_data (ib_head),
+        .next_data (ib_next),
+        .tail_data (),
+        .empty     (ib_empty),
+        .pair      (ib_pair),
+        .full      (ib_full)
+    );
 
-    pipe_if_id if_id_reg (
-        .clk               (clk),
-        .rst               (rst),
-        .flush             (flush_if_id),
-        .stall             (stall_id || cache_stall),
-        .if_pc             (if_pc),
-        .if_instruction    (if_instruction),
-        .if_predict_taken  (if_predict_taken && if_btb_hit),
-        .if_predict_target (if_predict_target),
-        .id_pc             (id_pc),
-        .id_instruction    (id_instruction),
-        .id_predict_taken  (id_predict_taken),
-        .id_predict_target (id_predict_target)
+    // Macro-op fusion: if the head and the entry behind it form a fusible
+    // pair, ID takes both as one op in the second instruction's place (its
+    // PC and prediction). The head must not be predicted taken, so the
+    // second entry really is the next instruction (2 or 4 bytes on).
+    macro_fusion fusion_inst (
+        .first      (ib_head[IB_WIDTH-33 -: 32]),
+        .second     (ib_next[IB_WIDTH-33 -: 32]),
+        .first_pc   (ib_head[IB_WIDTH-1 -: 32]),
+        .fuse       (fu_fuse),
+        .kind       (fu_kind),
+        .rs1        (fu_rs1),
+        .rs2        (fu_rs2),
+        .rd         (fu_rd),
+        .imm        (fu_imm),
+        .alu_op     (fu_alu_op),
+        .alu_src    (fu_alu_src),
+        .branch_type(fu_branch_type)
     );
 
+    assign id_fuse  = !ib_empty && ib_pair && fu_fuse && !ib_head[IB_WIDTH-65] &&
+                      (ib_next[IB_WIDTH-1 -: 32] == ib_head[IB_WIDTH-1 -: 32] +
+                                                    (ib_head[0] ? 32'd2 : 32'd4));
+    assign id_entry = id_fuse ? ib_next : ib_head;
+
+    // An empty buffer hands ID a NOP, which becomes a bubble in EX
+    assign {id_pc, id_ib_instruction, id_ib_predict_taken, id_predict_target,
+            id_bp_history, id_ras_ptr, id_ras_top, id_rvc} = id_entry;
+    assign id_instruction   = ib_empty ? 32'h00000013 : id_ib_instruction;
+    assign id_predict_taken = !ib_empty && id_ib_predict_taken;
+
 
     // ============================================================
     // ID Stage: Instruction Decode
@@ -294,21 +896,72 @@ module cpu_pipelined (
 
     decoder decoder_inst (
         .instruction (id_instruction),
-        .rs1         (id_rs1),
-        .rs2         (id_rs2),
-        .rd          (id_rd),
-        .imm         (id_imm),
-        .alu_op      (id_alu_op),
-        .alu_src     (id_alu_src),
-        .reg_write   (id_reg_write),
+        .rs1         (dec_rs1),
+        .rs2         (dec_rs2),
+        .rd          (dec_rd),
+        .imm         (dec_imm),
+        .alu_op      (dec_alu_op),
+        .alu_src     (dec_alu_src),
+        .reg_write   (dec_reg_write),
         .mem_read    (id_mem_read),
         .mem_write   (id_mem_write),
         .mem_to_reg  (id_mem_to_reg),
         .branch      (id_branch),
-        .branch_type (id_branch_type),
-        .jump        (id_jump)
+        .branch_type (dec_branch_type),
+        .jump        (id_jump),
+        .cf_type     (id_cf_type),
+        .muldiv      (id_muldiv),
+        .csr         (id_csr)
     );
 
+    assign id_insts = ib_empty ? 2'd0 : (id_fuse ? 2'd2 : 2'd1);
+
+    // A fused pair replaces the second instruction's operands. LUI and
+    // AUIPC have no rs1: they add their immediate (plus the PC for AUIPC)
+    // to x0.
+    always_comb begin
+        id_rs1         = dec_rs1;
+        id_rs2         = dec_rs2;
+        id_rd          = dec_rd;
+        id_imm         = dec_imm;
+        id_alu_op      = dec_alu_op;
+        id_alu_src     = dec_alu_src;
+        id_reg_write   = dec_reg_write;
+        id_branch_type = dec_branch_type;
+
+        if (id_fuse) begin
+            id_rs1         = fu_rs1;
+            id_rs2         = fu_rs2;
+            id_rd          = fu_rd;
+            id_imm         = fu_imm;
+            id_alu_op      = fu_alu_op;
+            id_alu_src     = fu_alu_src;
+            id_reg_write   = 1'b1;
+            id_branch_type = fu_branch_type;
+        end else if (id_instruction[6:0] == 7'b0110111) begin  // LUI
+            id_rs1 = 5'd0;
+        end else if (id_instruction[6:0] == 7'b0010111) begin  // AUIPC
+            id_rs1 = 5'd0;
+            id_imm = id_pc + dec_imm;
+        end
+    end
+
+    // Count fused pairs as they leave ID (not when EX throws them away)
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_fused_li     <= 32'd0;
+            stat_fused_call   <= 32'd0;
+            stat_fused_cmp_br <= 32'd0;
+        end else if (id_advance && id_fuse && !ex_redirect) begin
+            case (fu_kind)
+                2'd1:    stat_fused_li     <= stat_fused_li + 1;      // LI
+                2'd2:    stat_fused_call   <= stat_fused_call + 1;    // CALL
+                2'd3:    stat_fused_cmp_br <= stat_fused_cmp_br + 1;  // CMP_BR
+                default: ;
+            endcase
+        end
+    end
+
     register_file regfile (
         .clk        (clk),
         .we         (wb_reg_write),
@@ -325,14 +978,17 @@ module cpu_pipelined (
     // ID/EX Pipeline Register
     // ============================================================
 
-    // Flush ID/EX on misprediction or load-use hazard
-    assign flush_id_ex = mem_mispredicted || flush_ex;
+    // Flush ID/EX on misprediction or load-use hazard. The load-use bubble
+    // must wait while EX is held, or it would wipe out the held load.
+    assign flush_id_ex = ex_redirect || (flush_ex && !stall_ex);
 
     pipe_id_ex id_ex_reg (
         .clk               (clk),
         .rst               (rst),
         .flush             (flush_id_ex),
-        .stall             (cache_stall),
+        .stall             (stall_ex),
+        .ex_fwd_data1      (ex_alu_operand_a),
+        .ex_fwd_data2      (ex_alu_operand_b_fwd),
         .id_pc             (id_pc),
         .id_read_data1     (id_read_data1),
         .id_read_data2     (id_read_data2),
@@ -342,6 +998,9 @@ module cpu_pipelined (
         .id_rd             (id_rd),
         .id_predict_taken  (id_predict_taken),
         .id_predict_target (id_predict_target),
+        .id_bp_history     (id_bp_history),
+        .id_ras_ptr        (id_ras_ptr),
+        .id_ras_top        (id_ras_top),
         .id_alu_op         (id_alu_op),
         .id_alu_src        (id_alu_src),
         .id_reg_write      (id_reg_write),
@@ -351,6 +1010,12 @@ module cpu_pipelined (
         .id_branch         (id_branch),
         .id_branch_type    (id_branch_type),
         .id_jump           (id_jump),
+        .id_cf_type        (id_cf_type),
+        .id_muldiv         (id_muldiv),
+        .id_muldiv_op      (id_instruction[14:12]),
+        .id_rvc            (id_rvc),
+        .id_csr            (id_csr),
+        .id_insts          (id_insts),
         .ex_pc             (ex_pc),
         .ex_read_data1     (ex_read_data1),
         .ex_read_data2     (ex_read_data2),
@@ -360,6 +1025,9 @@ module cpu_pipelined (
         .ex_rd             (ex_rd),
         .ex_predict_taken  (ex_predict_taken),
         .ex_predict_target (ex_predict_target),
+        .ex_bp_history     (ex_bp_history),
+        .ex_ras_ptr        (ex_ras_ptr),
+        .ex_ras_top        (ex_ras_top),
         .ex_alu_op         (ex_alu_op),
         .ex_alu_src        (ex_alu_src),
         .ex_reg_write      (ex_reg_write),
@@ -368,7 +1036,13 @@ module cpu_pipelined (
         .ex_mem_to_reg     (ex_mem_to_reg),
         .ex_branch         (ex_branch),
         .ex_branch_type    (ex_branch_type),
-        .ex_jump           (ex_jump)
+        .ex_jump           (ex_jump),
+        .ex_cf_type        (ex_cf_type),
+        .ex_muldiv         (ex_muldiv),
+        .ex_muldiv_op      (ex_muldiv_op),
+        .ex_rvc            (ex_rvc),
+        .ex_csr            (ex_csr),
+        .ex_insts          (ex_insts)
     );
 
 
@@ -376,9 +1050,13 @@ module cpu_pipelined (
     // EX Stage: Execute (with forwarding muxes)
     // ============================================================
 
-    assign ex_pc_plus4 = ex_pc + 32'd4;
-    assign ex_branch_target = ex_pc + ex_imm;
-    assign mem_write_back_data = mem_alu_result;
+    assign ex_pc_plus4 = ex_pc + (ex_rvc ? 32'd2 : 32'd4);
+    // JALR jumps to rs1 + imm (the ALU result, low bit cleared); JAL and
+    // branches are PC-relative. JALR is the only jump with an immediate ALU input.
+    assign ex_branch_target = (ex_jump && ex_alu_src) ? {ex_alu_result[31:1], 1'b0} :
+                                                        ex_pc + ex_imm;
+    assign ex_indirect = ex_jump && ex_alu_src && (ex_cf_type != CF_RETURN);
+    assign mem_write_back_data = mem_jump ? mem_pc_plus4 : mem_alu_result;  // JAL/JALR link value
 
     // Forwarding mux for operand A (rs1)
     always_comb begin
@@ -407,7 +1085,217 @@ module cpu_pipelined (
         .b      (ex_alu_operand_b),
         .alu_op (ex_alu_op),
         .result (ex_alu_result),
-        .zero   (ex_alu_zero)
+        .zero   ()  // Branches use their own comparator
+    );
+
+
+    // ============================================================
+    // EX Stage: Multiply/Divide
+    // ============================================================
+
+    // The unit starts on the first cycle the instruction is in EX, with its
+    // forwarded operands. EX (and everything behind it) waits until the
+    // result comes back: 3 cycles for a multiply, 33 for a divide. A result
+    // that arrives while MEM is held is kept until EX can move on.
+    logic        md_start;
+    logic        md_busy;           // Started, result not back yet
+    logic        md_ready;          // Result back and kept, EX still held
+    logic [31:0] md_kept;
+    logic        mul_done, div_done;
+    logic [31:0] mul_result, div_result;
+    logic        md_done;
+    logic [31:0] md_result;
+
+    assign md_start   = ex_muldiv && !md_busy && !md_ready;
+    assign md_done    = mul_done || div_done;
+    assign md_result  = mul_done ? mul_result : div_result;
+    assign ex_md_wait = ex_muldiv && !md_ready && !md_done;
+    assign ex_result  = ex_csr     ? ex_csr_rdata :
+                        !ex_muldiv ? ex_alu_result :
+                        md_ready   ? md_kept : md_result;
+
+    multiplier mul_unit (
+        .clk        (clk),
+        .rst        (rst),
+        .flush      (1'b0),
+        .start      (md_start && !ex_muldiv_op[2]),
+        .op         (ex_muldiv_op[1:0]),
+        .a          (ex_alu_operand_a),
+        .b          (ex_alu_operand_b_fwd),
+        .tag        (1'b0),
+        .stage_valid(),
+        .stage_tag  (),
+        .stage_kill (2'b00),         // In-order: never wrong-path once in EX
+        .done       (mul_done),
+        .result     (mul_result),
+        .done_tag   ()
+    );
+
+    divider div_unit (
+        .clk        (clk),
+        .rst        (rst),
+        .flush      (1'b0),
+        .start      (md_start && ex_muldiv_op[2]),
+        .op         (ex_muldiv_op[1:0]),
+        .a          (ex_alu_operand_a),
+        .b          (ex_alu_operand_b_fwd),
+        .tag        (1'b0),
+        .busy       (),
+        .finishing  (),
+        .busy_tag   (),
+        .kill       (1'b0),
+        .done       (div_done),
+        .result     (div_result),
+        .done_tag   ()
+    );
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            md_busy  <= 1'b0;
+            md_ready <= 1'b0;
+            md_kept  <= 32'd0;
+        end else begin
+            if (md_start)
+                md_busy <= 1'b1;
+            else if (md_done)
+                md_busy <= 1'b0;
+
+            if (ex_muldiv && !stall_ex) begin
+                md_ready <= 1'b0;       // EX moves on
+            end else if (md_done) begin
+                md_ready <= 1'b1;       // MEM is held: keep the result
+                md_kept  <= md_result;
+            end
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_mul_ops      <= 32'd0;
+            stat_div_ops      <= 32'd0;
+            stat_muldiv_stall <= 32'd0;
+        end else begin
+            if (md_start && !ex_muldiv_op[2])
+                stat_mul_ops <= stat_mul_ops + 1;
+            if (md_start && ex_muldiv_op[2])
+                stat_div_ops <= stat_div_ops + 1;
+            if (ex_md_wait)
+                stat_muldiv_stall <= stat_muldiv_stall + 1;
+        end
+    end
+
+
+    // ============================================================
+    // EX Stage: Branch Resolution
+    // ============================================================
+
+    // Dedicated comparator on the forwarded operands, so every branch type
+    // (including the unsigned ones) is decided here instead of from the
+    // ALU's subtract result one stage later
+    // Branch types: 000=BEQ, 001=BNE, 100=BLT, 101=BGE, 110=BLTU, 111=BGEU
+    always_comb begin
+        case (ex_branch_type)
+            3'b000:  ex_branch_condition = (ex_alu_operand_a == ex_alu_operand_b_fwd);
+            3'b001:  ex_branch_condition = (ex_alu_operand_a != ex_alu_operand_b_fwd);
+            3'b100:  ex_branch_condition = ($signed(ex_alu_operand_a) <  $signed(ex_alu_operand_b_fwd));
+            3'b101:  ex_branch_condition = ($signed(ex_alu_operand_a) >= $signed(ex_alu_operand_b_fwd));
+            3'b110:  ex_branch_condition = (ex_alu_operand_a <  ex_alu_operand_b_fwd);
+            3'b111:  ex_branch_condition = (ex_alu_operand_a >= ex_alu_operand_b_fwd);
+            default: ex_branch_condition = 1'b0;
+        endcase
+    end
+    assign ex_actual_taken = (ex_branch && ex_branch_condition) || ex_jump;
+
+    // Misprediction detection
+    // Mispredicted if: prediction != actual outcome, or we went the right
+    // way but to the wrong place (stale BTB target, wrong return address)
+    assign ex_mispredicted = (ex_branch || ex_jump) &&
+                             ((ex_predict_taken != ex_actual_taken) ||
+                              (ex_actual_taken && ex_predict_target != ex_branch_target));
+
+    // Correct PC to fetch from after misprediction
+    // If we should have taken but didn't predict taken: go to branch target
+    // If we predicted taken but shouldn't have: go to PC + 4
+    assign ex_correct_pc = ex_actual_taken ? ex_branch_target : ex_pc_plus4;
+
+    // Resolve each branch once, when EX actually advances. A D-cache stall
+    // holds the branch in EX, so it redirects when the stall ends.
+    assign ex_branch_update = (ex_branch || ex_jump) && !stall_ex;
+    assign ex_redirect      = ex_branch_update && ex_mispredicted;
+
+
+    // ============================================================
+    // Top-Down Accounting
+    // ============================================================
+
+    // The issue slot is ID handing an op to EX. Branches resolve in EX, so
+    // a wrong-path instruction never gets that far: the one in ID when the
+    // branch redirects is the only slot lost, plus the cycles the buffer
+    // sits empty until the right path arrives (td_refill). Everything that
+    // issues retires.
+    logic td_refill;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst)
+            td_refill <= 1'b0;
+        else if (ex_redirect)
+            td_refill <= 1'b1;
+        else if (!ib_empty)
+            td_refill <= 1'b0;
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_td_frontend     <= 32'd0;
+            stat_td_bad_spec     <= 32'd0;
+            stat_td_backend_mem  <= 32'd0;
+            stat_td_backend_core <= 32'd0;
+            stat_td_retiring     <= 32'd0;
+        end else if (ex_redirect) begin
+            stat_td_bad_spec <= stat_td_bad_spec + 1;
+        end else if (stall_ex) begin
+            if (stall_mem)
+                stat_td_backend_mem  <= stat_td_backend_mem + 1;
+            else
+                stat_td_backend_core <= stat_td_backend_core + 1;
+        end else if (ib_empty) begin
+            if (td_refill)
+                stat_td_bad_spec <= stat_td_bad_spec + 1;
+            else
+                stat_td_frontend <= stat_td_frontend + 1;
+        end else if (stall_id) begin
+            stat_td_backend_mem <= stat_td_backend_mem + 1;   // Load-use
+        end else begin
+            stat_td_retiring <= stat_td_retiring + 1;
+        end
+    end
+
+
+    // ============================================================
+    // Performance Counters
+    // ============================================================
+
+    // A csrr reads its counter in EX. Instructions retire in WB, so the
+    // older ones still in MEM and WB go into instret as pending. A fetch
+    // counts as an I-cache hit once IF actually hands it to the buffer;
+    // load-use stalls count the cycles the hazard unit inserts a bubble.
+    perf_counters #(
+        .HPM_EVENTS(HPM_EVENTS)
+    ) perf (
+        .clk             (clk),
+        .rst             (rst),
+        .retired         (wb_insts),
+        .events          ({1'b0,                      // ROB full (no ROB)
+                           1'b0,                      // IQ full (no IQ)
+                           flush_ex && !stall_ex,     // Load-use stall
+                           ex_redirect,               // Mispredict
+                           dcache_miss,
+                           dcache_hit,
+                           icache_miss,
+                           icache_hit && !ib_full}),
+        .csr_addr        (ex_imm[11:0]),
+        .instret_pending ({6'd0, mem_insts} + {6'd0, wb_insts}),
+        .csr_rdata       (ex_csr_rdata)
     );
 
 
@@ -418,71 +1306,37 @@ module cpu_pipelined (
     pipe_ex_mem ex_mem_reg (
         .clk              (clk),
         .rst              (rst),
-        .flush            (mem_mispredicted),  // Flush on branch misprediction
-        .stall            (cache_stall),
+        .flush            (ex_md_wait && !stall_mem),  // Bubble behind a multiply/divide
+        .stall            (stall_mem),
         .ex_pc            (ex_pc),
         .ex_pc_plus4      (ex_pc_plus4),
-        .ex_alu_result    (ex_alu_result),
+        .ex_alu_result    (ex_result),
         .ex_read_data2    (ex_alu_operand_b_fwd),
         .ex_rd            (ex_rd),
-        .ex_zero          (ex_alu_zero),
-        .ex_branch_target (ex_branch_target),
-        .ex_predict_taken (ex_predict_taken),
         .ex_reg_write     (ex_reg_write),
         .ex_mem_read      (ex_mem_read),
         .ex_mem_write     (ex_mem_write),
         .ex_mem_to_reg    (ex_mem_to_reg),
-        .ex_branch        (ex_branch),
-        .ex_branch_type   (ex_branch_type),
         .ex_jump          (ex_jump),
+        .ex_insts         (ex_insts),
         .mem_pc           (mem_pc),
         .mem_pc_plus4     (mem_pc_plus4),
         .mem_alu_result   (mem_alu_result),
         .mem_read_data2   (mem_read_data2),
         .mem_rd           (mem_rd),
-        .mem_zero         (mem_zero),
-        .mem_branch_target(mem_branch_target),
-        .mem_predict_taken(mem_predict_taken),
         .mem_reg_write    (mem_reg_write),
         .mem_mem_read     (mem_mem_read),
         .mem_mem_write    (mem_mem_write),
         .mem_mem_to_reg   (mem_mem_to_reg),
-        .mem_branch       (mem_branch),
-        .mem_branch_type  (mem_branch_type),
-        .mem_jump         (mem_jump)
+        .mem_jump         (mem_jump),
+        .mem_insts        (mem_insts)
     );
 
 
     // ============================================================
-    // MEM Stage: Memory Access + Branch Resolution
+    // MEM Stage: Memory Access
     // ============================================================
 
-    // Actual branch decision (resolved here)
-    // Branch types: 000=BEQ, 001=BNE, 100=BLT, 101=BGE, 110=BLTU, 111=BGEU
-    logic mem_branch_condition;
-    always_comb begin
-        case (mem_branch_type)
-            3'b000:  mem_branch_condition = mem_zero;           // BEQ: branch if equal
-            3'b001:  mem_branch_condition = !mem_zero;          // BNE: branch if not equal
-            3'b100:  mem_branch_condition = mem_alu_result[31]; // BLT: branch if less than (signed)
-            3'b101:  mem_branch_condition = !mem_alu_result[31] || mem_zero; // BGE: branch if >= (signed)
-            3'b110:  mem_branch_condition = !mem_zero && !mem_alu_result[31]; // BLTU: unsigned (simplified)
-            3'b111:  mem_branch_condition = mem_zero || mem_alu_result[31];   // BGEU: unsigned (simplified)
-            default: mem_branch_condition = 1'b0;
-        endcase
-    end
-    assign mem_actual_taken = (mem_branch && mem_branch_condition) || mem_jump;
-
-    // Misprediction detection
-    // Mispredicted if: prediction != actual outcome
-    assign mem_mispredicted = (mem_branch || mem_jump) &&
-                              (mem_predict_taken != mem_actual_taken);
-
-    // Correct PC to fetch from after misprediction
-    // If we should have taken but didn't predict taken: go to branch target
-    // If we predicted taken but shouldn't have: go to PC + 4
-    assign mem_correct_pc = mem_actual_taken ? mem_branch_target : mem_pc_plus4;
-
     // Data Cache
     cache #(
         .CACHE_SIZE_BYTES(256),
@@ -496,6 +1350,10 @@ module cpu_pipelined (
         .cpu_write_en   (mem_mem_write),
         .cpu_read_data  (mem_data_read),
         .cpu_stall      (dcache_stall),
+        .event_hit      (dcache_hit),
+        .event_miss     (dcache_miss),
+        .prefetch_en    (1'b0),         // No prefetching for data
+        .prefetch_addr  (32'd0),
         .mem_addr       (dmem_addr),
         .mem_read_en    (dmem_read_en),
         .mem_write_en   (dmem_write_en),
@@ -527,7 +1385,7 @@ module cpu_pipelined (
     pipe_mem_wb mem_wb_reg (
         .clk            (clk),
         .rst            (rst),
-        .stall          (cache_stall),
+        .flush          (stall_mem),
         .mem_pc_plus4   (mem_pc_plus4),
         .mem_alu_result (mem_alu_result),
         .mem_read_data  (mem_data_read),
@@ -535,13 +1393,15 @@ module cpu_pipelined (
         .mem_reg_write  (mem_reg_write),
         .mem_mem_to_reg (mem_mem_to_reg),
         .mem_jump       (mem_jump),
+        .mem_insts      (mem_insts),
         .wb_pc_plus4    (wb_pc_plus4),
         .wb_alu_result  (wb_alu_result),
         .wb_read_data   (wb_read_data),
         .wb_rd          (wb_rd),
         .wb_reg_write   (wb_reg_write),
         .wb_mem_to_reg  (wb_mem_to_reg),
-        .wb_jump        (wb_jump)
+        .wb_jump        (wb_jump),
+        .wb_insts       (wb_insts)
     );
 
 
@@ -18,12 +18,16 @@ module cpu_top (
 
     // Control signals
     logic [4:0]  rs1, rs2, rd;
-    logic [3:0]  alu_op;
+    logic [4:0]  alu_op;
     logic        alu_src;
     logic        reg_write;
     logic        mem_read, mem_write;
     logic        mem_to_reg;
     logic        branch, jump;
+    logic        csr;
+
+    // Counter CSRs
+    logic [31:0] csr_rdata;
 
     // Branch/jump logic
     logic        take_branch;
@@ -44,9 +48,11 @@ module cpu_top (
     // ALU operand B selection (register or immediate)
     assign alu_operand_b = alu_src ? imm : read_data2;
 
-    // Write-back data selection (ALU result or memory data)
+    // Write-back data selection (ALU result, memory data or a counter CSR)
     // For JAL/JALR, write PC+4 to rd (return address)
-    assign write_back_data = jump ? pc_plus4 : (mem_to_reg ? mem_read_data : alu_result);
+    assign write_back_data = jump ? pc_plus4 :
+                             csr  ? csr_rdata :
+                             (mem_to_reg ? mem_read_data : alu_result);
 
     // =========== Module Instantiations ===========
 
@@ -79,7 +85,8 @@ module cpu_top (
         .mem_write   (mem_write),
         .mem_to_reg  (mem_to_reg),
         .branch      (branch),
-        .jump        (jump)
+        .jump        (jump),
+        .csr         (csr)
     );
 
     // Register File
@@ -103,6 +110,18 @@ module cpu_top (
         .zero   (alu_zero)
     );
 
+    // Performance counters: one instruction retires every cycle, and there
+    // are no caches or predictors to raise events
+    perf_counters perf (
+        .clk             (clk),
+        .rst             (rst),
+        .retired         (2'd1),
+        .events          (8'd0),
+        .csr_addr        (imm[11:0]),
+        .instret_pending (8'd0),
+        .csr_rdata       (csr_rdata)
+    );
+
     // Data Memory
     data_memory dmem (
         .clk        (clk),
@@ -12,7 +12,7 @@ module decoder (
     output logic [31:0] imm,
 
     // Control signals
-    output logic [3:0]  alu_op,
+    output logic [4:0]  alu_op,
     output logic        alu_src,      // 0 = rs2, 1 = immediate
     output logic        reg_write,    // Write to register file
     output logic        mem_read,     // Read from data memory
@@ -20,7 +20,10 @@ module decoder (
     output logic        mem_to_reg,   // 0 = ALU result, 1 = memory data
     output logic        branch,       // Branch instruction
     output logic [2:0]  branch_type,  // Branch condition (funct3)
-    output logic        jump          // Jump instruction (JAL/JALR)
+    output logic        jump,         // Jump instruction (JAL/JALR)
+    output logic [1:0]  cf_type,      // Control-flow type for prediction (see below)
+    output logic        muldiv,       // M extension: multiply/divide unit, op in funct3
+    output logic        csr           // Counter CSR read (csrr): rd = CSR imm[11:0]
 );
 
     // Extract fields from instruction
@@ -45,23 +48,51 @@ module decoder (
     localparam OP_STORE  = 7'b0100011;
     localparam OP_OPIMM  = 7'b0010011;  // I-type ALU (addi, etc.)
     localparam OP_OP     = 7'b0110011;  // R-type ALU (add, sub, etc.)
+    localparam OP_SYSTEM = 7'b1110011;  // CSR access (ecall/ebreak when funct3 = 0)
 
     // ALU operation codes (match alu.sv)
-    localparam ALU_ADD  = 4'b0000;
-    localparam ALU_SUB  = 4'b0001;
-    localparam ALU_AND  = 4'b0010;
-    localparam ALU_OR   = 4'b0011;
-    localparam ALU_XOR  = 4'b0100;
-    localparam ALU_SLT  = 4'b0101;
-    localparam ALU_SLTU = 4'b0110;
-    localparam ALU_SLL  = 4'b0111;
-    localparam ALU_SRL  = 4'b1000;
-    localparam ALU_SRA  = 4'b1001;
+    localparam ALU_ADD    = 5'b00000;
+    localparam ALU_SUB    = 5'b00001;
+    localparam ALU_AND    = 5'b00010;
+    localparam ALU_OR     = 5'b00011;
+    localparam ALU_XOR    = 5'b00100;
+    localparam ALU_SLT    = 5'b00101;
+    localparam ALU_SLTU   = 5'b00110;
+    localparam ALU_SLL    = 5'b00111;
+    localparam ALU_SRL    = 5'b01000;
+    localparam ALU_SRA    = 5'b01001;
+    localparam ALU_SH1ADD = 5'b01010;
+    localparam ALU_SH2ADD = 5'b01011;
+    localparam ALU_SH3ADD = 5'b01100;
+    localparam ALU_ANDN   = 5'b01101;
+    localparam ALU_ORN    = 5'b01110;
+    localparam ALU_XNOR   = 5'b01111;
+    localparam ALU_MIN    = 5'b10000;
+    localparam ALU_MAX    = 5'b10001;
+    localparam ALU_MINU   = 5'b10010;
+    localparam ALU_MAXU   = 5'b10011;
+    localparam ALU_ROL    = 5'b10100;
+    localparam ALU_ROR    = 5'b10101;
+    localparam ALU_CLZ    = 5'b10110;
+    localparam ALU_CTZ    = 5'b10111;
+    localparam ALU_CPOP   = 5'b11000;
+    localparam ALU_SEXTB  = 5'b11001;
+    localparam ALU_SEXTH  = 5'b11010;
+    localparam ALU_ZEXTH  = 5'b11011;
+    localparam ALU_REV8   = 5'b11100;
+    localparam ALU_ORCB   = 5'b11101;
+
+    // Zba/Zbb funct7 groups (andn/orn/xnor share 0100000 with sub/sra)
+    localparam F7_ZBA    = 7'b0010000;  // sh1add/sh2add/sh3add
+    localparam F7_MINMAX = 7'b0000101;  // min/minu/max/maxu
+    localparam F7_ROT    = 7'b0110000;  // rol/ror/rori, and the OP-IMM unary ops
+    localparam F7_NEG    = 7'b0100000;  // andn/orn/xnor
+    localparam F7_ZEXTH  = 7'b0000100;  // zext.h
 
     // Immediate generation
     always_comb begin
         case (opcode)
-            OP_OPIMM, OP_LOAD, OP_JALR: begin
+            OP_OPIMM, OP_LOAD, OP_JALR, OP_SYSTEM: begin
                 // I-type immediate
                 imm = {{20{instruction[31]}}, instruction[31:20]};
             end
@@ -87,6 +118,24 @@ module decoder (
         endcase
     end
 
+    // Control-flow type (matches the BTB type encoding)
+    //   00 = not a jump (conditional branches and everything else)
+    //   01 = plain jump
+    //   10 = call:   JAL/JALR that links into ra (x1) or t0 (x5)
+    //   11 = return: JALR through ra/t0 that doesn't link
+    logic rd_is_link, rs1_is_link;
+    assign rd_is_link  = (rd == 5'd1) || (rd == 5'd5);
+    assign rs1_is_link = (rs1 == 5'd1) || (rs1 == 5'd5);
+
+    always_comb begin
+        case (opcode)
+            OP_JAL:  cf_type = rd_is_link ? 2'b10 : 2'b01;
+            OP_JALR: cf_type = rd_is_link ? 2'b10 :
+                               (rs1_is_link && rd == 5'd0) ? 2'b11 : 2'b01;
+            default: cf_type = 2'b00;
+        endcase
+    end
+
     // Control signal generation
     always_comb begin
         // Defaults
@@ -99,11 +148,14 @@ module decoder (
         branch      = 1'b0;
         branch_type = 3'b000;
         jump        = 1'b0;
+        muldiv      = 1'b0;
+        csr         = 1'b0;
 
         case (opcode)
             OP_OP: begin  // R-type (add, sub, and, or, etc.)
                 reg_write = 1'b1;
                 alu_src   = 1'b0;  // Use rs2
+                muldiv    = (funct7 == 7'b0000001);  // mul/div/rem family
                 case (funct3)
                     3'b000: alu_op = (funct7[5]) ? ALU_SUB : ALU_ADD;
                     3'b001: alu_op = ALU_SLL;
@@ -114,6 +166,37 @@ module decoder (
                     3'b110: alu_op = ALU_OR;
                     3'b111: alu_op = ALU_AND;
                 endcase
+
+                // Zba/Zbb: same funct3 slots, told apart by funct7
+                case (funct7)
+                    F7_ZBA: case (funct3)
+                        3'b010: alu_op = ALU_SH1ADD;
+                        3'b100: alu_op = ALU_SH2ADD;
+                        3'b110: alu_op = ALU_SH3ADD;
+                        default: ;
+                    endcase
+                    F7_MINMAX: case (funct3)
+                        3'b100: alu_op = ALU_MIN;
+                        3'b101: alu_op = ALU_MINU;
+                        3'b110: alu_op = ALU_MAX;
+                        3'b111: alu_op = ALU_MAXU;
+                        default: ;
+                    endcase
+                    F7_ROT: case (funct3)
+                        3'b001: alu_op = ALU_ROL;
+                        3'b101: alu_op = ALU_ROR;
+                        default: ;
+                    endcase
+                    F7_NEG: case (funct3)
+                        3'b100: alu_op = ALU_XNOR;
+                        3'b110: alu_op = ALU_ORN;
+                        3'b111: alu_op = ALU_ANDN;
+                        default: ;
+                    endcase
+                    F7_ZEXTH:
+                        if (funct3 == 3'b100) alu_op = ALU_ZEXTH;
+                    default: ;
+                endcase
             end
 
             OP_OPIMM: begin  // I-type ALU (addi, andi, etc.)
@@ -129,6 +212,25 @@ module decoder (
                     3'b110: alu_op = ALU_OR;   // ori
                     3'b111: alu_op = ALU_AND;  // andi
                 endcase
+
+                // Zbb: unary ops (rs2 field picks the op) and rori
+                if (funct3 == 3'b001 && funct7 == F7_ROT) begin
+                    case (rs2)
+                        5'b00000: alu_op = ALU_CLZ;
+                        5'b00001: alu_op = ALU_CTZ;
+                        5'b00010: alu_op = ALU_CPOP;
+                        5'b00100: alu_op = ALU_SEXTB;
+                        5'b00101: alu_op = ALU_SEXTH;
+                        default: ;
+                    endcase
+                end else if (funct3 == 3'b101) begin
+                    if (funct7 == F7_ROT)
+                        alu_op = ALU_ROR;   // rori
+                    else if (instruction[31:20] == 12'h698)
+                        alu_op = ALU_REV8;
+                    else if (instruction[31:20] == 12'h287)
+                        alu_op = ALU_ORCB;
+                end
             end
 
             OP_LOAD: begin  // lw, lb, lh, etc.
@@ -174,6 +276,14 @@ module decoder (
                 alu_src   = 1'b1;
                 alu_op    = ALU_ADD;
             end
+
+            OP_SYSTEM: begin  // csrrw/csrrs/csrrc(i): the counters are read-only, so only the read happens
+                if (funct3 != 3'b000) begin
+                    reg_write = 1'b1;
+                    alu_src   = 1'b1;
+                    csr       = 1'b1;
+                end
+            end
         endcase
     end
 
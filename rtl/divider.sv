@@ -0,0 +1,121 @@
+// divider.sv - Iterative divider for the M extension
+//
+// Radix-2 restoring division on the operand magnitudes, one quotient bit
+// per cycle: a divide started in cycle t has its result out (done) in
+// cycle t+33. Only one divide is in flight; busy is high meanwhile, and
+// finishing marks the last step, a cycle before the result.
+//
+// Ops (funct3[1:0]): 00 DIV, 01 DIVU, 10 REM, 11 REMU.
+//
+// The signs are put back at the end. That already gives the results the
+// ISA asks for in the corner cases, as long as the quotient of a divide
+// by zero is left alone:
+//   x / 0         -> all ones,  x % 0         -> x
+//   -2^31 / -1    -> -2^31,     -2^31 % -1    -> 0
+
+module divider #(
+    parameter TAG_BITS = 1
+) (
+    input  logic                clk,
+    input  logic                rst,
+    input  logic                flush,      // Abandon the divide in flight
+
+    // Start a divide (only when not busy)
+    input  logic                start,
+    input  logic [1:0]          op,
+    input  logic [31:0]         a,
+    input  logic [31:0]         b,
+    input  logic [TAG_BITS-1:0] tag,
+
+    // The divide in flight. A killed divide is abandoned.
+    output logic                busy,
+    output logic                finishing,  // Last step: result next cycle
+    output logic [TAG_BITS-1:0] busy_tag,
+    input  logic                kill,
+
+    // The result
+    output logic                done,
+    output logic [31:0]         result,
+    output logic [TAG_BITS-1:0] done_tag
+);
+
+    localparam logic [1:0] OP_DIV = 2'b00;
+    localparam logic [1:0] OP_REM = 2'b10;
+
+    // Divide state
+    logic [5:0]  count;      // Steps left
+    logic [31:0] quotient;   // Dividend shifts out the top, quotient in the bottom
+    logic [31:0] remainder;
+    logic [31:0] divisor;
+    logic        want_rem;
+    logic        neg_quotient;
+    logic        neg_remainder;
+
+    // Operand magnitudes and result signs for a new divide
+    logic        op_signed;
+    logic [31:0] a_mag, b_mag;
+
+    assign op_signed = (op == OP_DIV) || (op == OP_REM);
+    assign a_mag     = (op_signed && a[31]) ? -a : a;
+    assign b_mag     = (op_signed && b[31]) ? -b : b;
+
+    // One restoring step: shift the next dividend bit in, subtract if it fits
+    logic [32:0] step_shifted;
+    logic [32:0] step_diff;
+    logic [31:0] step_remainder;
+    logic [31:0] step_quotient;
+
+    assign step_shifted   = {remainder, quotient[31]};
+    assign step_diff      = step_shifted - {1'b0, divisor};
+    assign step_remainder = step_diff[32] ? step_shifted[31:0] : step_diff[31:0];
+    assign step_quotient  = {quotient[30:0], !step_diff[32]};
+
+    assign finishing = busy && (count == 6'd1);
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst || flush) begin
+            busy          <= 1'b0;
+            count         <= 6'd0;
+            quotient      <= 32'd0;
+            remainder     <= 32'd0;
+            divisor       <= 32'd0;
+            want_rem      <= 1'b0;
+            neg_quotient  <= 1'b0;
+            neg_remainder <= 1'b0;
+            busy_tag      <= '0;
+            done          <= 1'b0;
+            result        <= 32'd0;
+            done_tag      <= '0;
+        end else begin
+            done <= 1'b0;
+
+            if (busy && kill) begin
+                busy <= 1'b0;
+            end else if (busy) begin
+                count     <= count - 1'b1;
+                quotient  <= step_quotient;
+                remainder <= step_remainder;
+                if (finishing) begin
+                    busy     <= 1'b0;
+                    done     <= 1'b1;
+                    done_tag <= busy_tag;
+                    if (want_rem)
+                        result <= neg_remainder ? -step_remainder : step_remainder;
+                    else
+                        result <= neg_quotient ? -step_quotient : step_quotient;
+                end
+            end else if (start) begin
+                busy          <= 1'b1;
+                count         <= 6'd32;
+                quotient      <= a_mag;
+                remainder     <= 32'd0;
+                divisor       <= b_mag;
+                want_rem      <= op[1];
+                neg_quotient  <= op_signed && (a[31] ^ b[31]) && (b != 32'd0);
+                neg_remainder <= op_signed && a[31];
+                busy_tag      <= tag;
+            end
+        end
+    end
+
+endmodule
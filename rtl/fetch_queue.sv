@@ -0,0 +1,85 @@
+// fetch_queue.sv - Small FIFO used to decouple the pipelined front end
+//
+// The same queue is used twice:
+// - Fetch target queue (FTQ): the branch predictor pushes the PCs it wants
+//   fetched, together with their prediction metadata. The I-cache pops them.
+// - Instruction buffer: the I-cache pushes fetched instructions, the
+//   decode stage pops them.
+//
+// Each stage only waits on its own queue being full or empty, so a stall
+// on one side no longer freezes the other.
+//
+// Entries are packed into one WIDTH-bit vector by the caller.
+// The oldest entry (head) and the youngest entry (tail) can both be read;
+// the youngest FTQ entry is as far ahead as the predictor has run, which
+// is what the I-cache prefetches.
+//
+// The instruction buffer's reader can also look one entry past the head
+// and pop both at once, which is how decode fuses an instruction pair.
+//
+// The caller must not push when full or pop when empty. Flush empties the
+// queue (branch misprediction) and wins over push/pop.
+
+module fetch_queue #(
+    parameter WIDTH = 32,
+    parameter DEPTH = 4   // Power of 2, at least 2
+)(
+    input  logic             clk,
+    input  logic             rst,
+    input  logic             flush,
+
+    // Push (younger side)
+    input  logic             enq_en,
+    input  logic [WIDTH-1:0] enq_data,
+
+    // Pop (older side)
+    input  logic             deq_en,
+    input  logic             deq_pair,    // With deq_en: pop two entries
+    output logic [WIDTH-1:0] head_data,   // Oldest entry
+    output logic [WIDTH-1:0] next_data,   // Second oldest entry
+    output logic [WIDTH-1:0] tail_data,   // Youngest entry
+
+    // Status
+    output logic             empty,
+    output logic             pair,        // At least two entries
+    output logic             full
+);
+
+    localparam PTR_BITS = $clog2(DEPTH);
+
+    logic [WIDTH-1:0]  entries [0:DEPTH-1];
+    logic [PTR_BITS-1:0] head;
+    logic [PTR_BITS-1:0] tail;
+    logic [PTR_BITS:0]   count;
+    logic [PTR_BITS:0]   deq_count;   // Entries popped this cycle
+
+    assign head_data = entries[head];
+    assign next_data = entries[head + 1'b1];
+    assign tail_data = entries[tail - 1'b1];
+    assign empty     = (count == 0);
+    assign pair      = (count >= 2);
+    assign full      = (count == DEPTH);
+    assign deq_count = !deq_en ? 0 : deq_pair ? 2 : 1;
+
+    initial begin
+        for (int i = 0; i < DEPTH; i++) begin
+            entries[i] = '0;
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst || flush) begin
+            head  <= '0;
+            tail  <= '0;
+            count <= '0;
+        end else begin
+            if (enq_en) begin
+                entries[tail] <= enq_data;
+                tail <= tail + 1'b1;
+            end
+            head  <= head + deq_count[PTR_BITS-1:0];
+            count <= count + (enq_en ? 1'b1 : 1'b0) - deq_count;
+        end
+    end
+
+endmodule
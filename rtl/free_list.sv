@@ -1,21 +1,63 @@
 // free_list.sv - Free list for physical register allocation
 // Circular FIFO tracking available physical registers
+//
+// Registers are popped in order, so everything allocated after a branch
+// sits between the branch's head pointer and the current head. A branch
+// checkpoint just records the head pointer; restoring it hands those
+// registers back in one cycle.
+//
+// A second head pointer advances as register-writing instructions commit.
+// A full flush (replay from the ROB head) moves the head back to it,
+// returning every register allocated by an uncommitted instruction.
+//
+// Up to WIDTH registers can be popped per cycle, one per rename slot.
+// Slot k takes the entry after those taken by the slots in front of it,
+// so the registers still come off the list in program order.
+//
+// Up to RETIRE_WIDTH registers are pushed back per cycle, one per
+// retiring instruction, in retire order.
+//
+// Move elimination lets several architectural registers share a physical
+// register. share_count holds the number of extra committed mappings; it
+// goes up when an eliminated move commits, and a freed register only goes
+// back on the list once its count is zero (otherwise the count drops).
+// Counting committed mappings only means squashed moves need no undo.
 
 module free_list #(
     parameter NUM_PHYS_REGS = 64,
-    parameter PHYS_REG_BITS = 6
+    parameter PHYS_REG_BITS = 6,
+    parameter WIDTH         = 1,   // Allocations per cycle
+    parameter RETIRE_WIDTH  = 1,   // Frees per cycle
+    parameter NUM_CKPTS     = 4,
+    parameter CKPT_BITS     = 2    // log2(NUM_CKPTS)
 ) (
     input  logic        clk,
     input  logic        rst,
+    input  logic        flush,          // Drop every uncommitted allocation
 
-    // Allocate: pop a free register (during rename)
-    input  logic                     alloc_en,
-    output logic [PHYS_REG_BITS-1:0] alloc_reg,
-    output logic                     alloc_valid,  // 0 if list is empty
+    // Allocate: pop free registers (during rename), one per slot
+    input  logic [WIDTH-1:0]                    alloc_en,
+    output logic [WIDTH-1:0][PHYS_REG_BITS-1:0] alloc_reg,
+    output logic                                alloc_valid,  // Enough for a full group
 
-    // Free: push a register back (during commit)
-    input  logic                     free_en,
-    input  logic [PHYS_REG_BITS-1:0] free_reg
+    // Free: push registers back (during commit), one per retire slot
+    input  logic [RETIRE_WIDTH-1:0]                    free_en,
+    input  logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] free_reg,
+
+    // Commit: the oldest allocations are now architectural, one per set bit
+    input  logic [RETIRE_WIDTH-1:0]  commit_en,
+
+    // Share: a committed move maps one more architectural register to share_reg
+    input  logic [RETIRE_WIDTH-1:0]                    share_en,
+    input  logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] share_reg,
+
+    // Checkpoint: remember the head pointer (after this cycle's allocation)
+    input  logic                     ckpt_en,
+    input  logic [CKPT_BITS-1:0]     ckpt_id,
+
+    // Restore: return every register allocated since the checkpoint
+    input  logic                     restore_en,
+    input  logic [CKPT_BITS-1:0]     restore_id
 );
 
     // Circular buffer storage
@@ -27,10 +69,71 @@ module free_list #(
     logic [PHYS_REG_BITS:0]   head;  // Extra bit for full/empty detection
     logic [PHYS_REG_BITS:0]   tail;
     logic [PHYS_REG_BITS:0]   count;
+    logic [PHYS_REG_BITS:0]   commit_head;  // Head as of the last commit
 
-    // Output the register at the head
-    assign alloc_reg   = fifo[head[PHYS_REG_BITS-1:0]];
-    assign alloc_valid = (count > 0);
+    // Saved head pointers, one per checkpoint
+    logic [PHYS_REG_BITS:0]   head_ckpt [0:NUM_CKPTS-1];
+
+    // Extra committed mappings per register (at most 31 other arch regs)
+    logic [4:0]               share_count [0:NUM_PHYS_REGS-1];
+
+    // Slot k pops the entry after the ones taken by older slots
+    logic [PHYS_REG_BITS:0] alloc_total;
+
+    always_comb begin
+        alloc_total = 0;
+        for (int k = 0; k < WIDTH; k++) begin
+            alloc_reg[k] = fifo[head[PHYS_REG_BITS-1:0] + alloc_total[PHYS_REG_BITS-1:0]];
+            if (alloc_en[k])
+                alloc_total = alloc_total + 1;
+        end
+    end
+
+    // Share counts as seen by each retire slot, after the older slots'
+    // updates (a slot shares its new register before freeing its old one)
+    logic [4:0] share_now  [0:RETIRE_WIDTH-1];
+    logic [4:0] free_now   [0:RETIRE_WIDTH-1];
+    logic       free_push  [0:RETIRE_WIDTH-1];  // Last mapping gone: back on the list
+    logic       free_drop  [0:RETIRE_WIDTH-1];  // Still shared: count down
+
+    always_comb begin
+        for (int r = 0; r < RETIRE_WIDTH; r++) begin
+            share_now[r] = share_count[share_reg[r]];
+            free_now[r]  = share_count[free_reg[r]];
+            for (int j = 0; j < r; j++) begin
+                if (share_en[j] && share_reg[j] == share_reg[r]) share_now[r] = share_now[r] + 1;
+                if (free_drop[j] && free_reg[j] == share_reg[r]) share_now[r] = share_now[r] - 1;
+                if (share_en[j] && share_reg[j] == free_reg[r])  free_now[r]  = free_now[r] + 1;
+                if (free_drop[j] && free_reg[j] == free_reg[r])  free_now[r]  = free_now[r] - 1;
+            end
+            if (share_en[r] && share_reg[r] == free_reg[r])
+                free_now[r] = free_now[r] + 1;
+            free_push[r] = free_en[r] && (free_now[r] == 0);
+            free_drop[r] = free_en[r] && (free_now[r] != 0);
+        end
+    end
+
+    // Retire slot r pushes after the ones freed by older slots
+    logic [PHYS_REG_BITS:0] free_pos [0:RETIRE_WIDTH-1];
+    logic [PHYS_REG_BITS:0] free_total;
+    logic [PHYS_REG_BITS:0] commit_total;
+
+    always_comb begin
+        free_total   = 0;
+        commit_total = 0;
+        for (int r = 0; r < RETIRE_WIDTH; r++) begin
+            free_pos[r] = tail + free_total;
+            if (free_push[r])
+                free_total = free_total + 1;
+            if (commit_en[r])
+                commit_total = commit_total + 1;
+        end
+    end
+
+    // Ready only if a whole group can be renamed, so readiness doesn't
+    // depend on which slots end up allocating
+    assign count       = tail - head;
+    assign alloc_valid = (count >= WIDTH);
 
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
@@ -40,24 +143,44 @@ module free_list #(
             for (i = 0; i < NUM_PHYS_REGS - 32; i++) begin
                 fifo[i] <= i[PHYS_REG_BITS-1:0] + 6'd32;
             end
+            for (i = 0; i < NUM_PHYS_REGS; i++) begin
+                share_count[i] <= 5'd0;
+            end
             head  <= 0;
             tail  <= NUM_PHYS_REGS - 32;  // 32 entries initially
-            count <= NUM_PHYS_REGS - 32;
+            commit_head <= 0;
         end else begin
-            // Allocate (pop from head)
-            if (alloc_en && alloc_valid) begin
-                head <= head + 1;
-                count <= count - (free_en ? 0 : 1);
+            if (flush) begin
+                // Replay: nothing after the last commit survives
+                head <= commit_head;
+            end else if (restore_en) begin
+                // Misprediction: wrong-path registers go back on the list
+                head <= head_ckpt[restore_id];
+            end else if (alloc_valid) begin
+                // Allocate (pop from head)
+                head <= head + alloc_total;
+            end
+
+            if (ckpt_en) begin
+                head_ckpt[ckpt_id] <= head + (alloc_valid ? alloc_total : 0);
             end
 
+            commit_head <= commit_head + commit_total;
+
             // Free (push to tail)
-            if (free_en) begin
-                fifo[tail[PHYS_REG_BITS-1:0]] <= free_reg;
-                tail <= tail + 1;
-                if (!(alloc_en && alloc_valid)) begin
-                    count <= count + 1;
-                end
+            for (int r = 0; r < RETIRE_WIDTH; r++) begin
+                if (free_push[r])
+                    fifo[free_pos[r][PHYS_REG_BITS-1:0]] <= free_reg[r];
+            end
+
+            // Share counts (younger slots write the later value)
+            for (int r = 0; r < RETIRE_WIDTH; r++) begin
+                if (share_en[r])
+                    share_count[share_reg[r]] <= share_now[r] + 1;
+                if (free_drop[r])
+                    share_count[free_reg[r]] <= free_now[r] - 1;
             end
+            tail <= tail + free_total;
         end
     end
 
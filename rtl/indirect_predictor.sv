@@ -0,0 +1,112 @@
+// indirect_predictor.sv - Target cache for indirect jumps (non-return JALR)
+//
+// Jump tables and function pointers compile to JALR whose target changes
+// from one execution to the next. The BTB only remembers the last target
+// per PC, but the target usually correlates with how we got here.
+//
+// Structure:
+// - Indexed by PC XOR global history, so the same JALR can keep several
+//   targets, one per history pattern
+// - Each entry stores: valid bit, tag (PC bits), target address
+// - Only non-return JALRs are written, so a hit means "this is an
+//   indirect jump, and here is where it went last time with this history"
+//
+// The history is the same global history checkpoint the direction
+// predictor hands out, so the update side sees the exact index used at
+// fetch.
+
+module indirect_predictor #(
+    parameter INDEX_BITS   = 5,  // 2^5 = 32 entries
+    parameter TAG_BITS     = 10, // PC bits for matching
+    parameter HISTORY_BITS = 8   // Global history bits hashed into the index (max 31)
+)(
+    input  logic        clk,
+    input  logic        rst,
+
+    // Lookup interface (IF stage)
+    input  logic [31:0] pc_if,           // PC to look up
+    input  logic [31:0] history_if,      // Global history at fetch
+    output logic        hit,             // Have a target for this PC + history
+    output logic [31:0] target,          // Predicted target if hit
+
+    // Update interface (when the indirect jump resolves)
+    input  logic        update_en,       // A non-return JALR resolved
+    input  logic [31:0] update_pc,
+    input  logic [31:0] update_history,  // Global history checkpoint from fetch
+    input  logic [31:0] update_target,   // Where it actually went
+    input  logic        update_mispredict, // Fetch went to the wrong place
+
+    // Statistics
+    output logic [31:0] stat_jumps,      // Indirect jumps resolved
+    output logic [31:0] stat_hits,       // ...that had a matching entry
+    output logic [31:0] stat_mispredicts // ...that were mispredicted
+);
+
+    localparam NUM_ENTRIES = (1 << INDEX_BITS);
+    localparam [31:0] HISTORY_MASK = (32'd1 << HISTORY_BITS) - 32'd1;
+
+    logic                valid  [0:NUM_ENTRIES-1];
+    logic [TAG_BITS-1:0] tags   [0:NUM_ENTRIES-1];
+    logic [31:0]         targets[0:NUM_ENTRIES-1];
+
+    // Index = PC XOR (history folded down to the index width)
+    function automatic logic [INDEX_BITS-1:0] hash_index(input logic [31:0] pc,
+                                                         input logic [31:0] hist);
+        logic [31:0] h;
+        h = hist & HISTORY_MASK;
+        hash_index = pc[INDEX_BITS+1:2];
+        for (int i = 0; i < 32; i = i + INDEX_BITS) begin
+            hash_index = hash_index ^ h[INDEX_BITS-1:0];
+            h = h >> INDEX_BITS;
+        end
+    endfunction
+
+    logic [INDEX_BITS-1:0] lookup_index;
+    logic [TAG_BITS-1:0]   lookup_tag;
+    logic [INDEX_BITS-1:0] update_index;
+    logic [TAG_BITS-1:0]   update_tag;
+
+    assign lookup_index = hash_index(pc_if, history_if);
+    assign lookup_tag   = pc_if[TAG_BITS+1:2] ^ {{(TAG_BITS-1){1'b0}}, pc_if[1]};  // Bit 1: compressed jumps
+    assign update_index = hash_index(update_pc, update_history);
+    assign update_tag   = update_pc[TAG_BITS+1:2] ^ {{(TAG_BITS-1){1'b0}}, update_pc[1]};
+
+    // Lookup logic (combinational)
+    assign hit    = valid[lookup_index] && (tags[lookup_index] == lookup_tag);
+    assign target = targets[lookup_index];
+
+    initial begin
+        for (int i = 0; i < NUM_ENTRIES; i++) begin
+            valid[i]   = 1'b0;
+            tags[i]    = '0;
+            targets[i] = 32'd0;
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            for (int i = 0; i < NUM_ENTRIES; i++) begin
+                valid[i]   <= 1'b0;
+                tags[i]    <= '0;
+                targets[i] <= 32'd0;
+            end
+            stat_jumps       <= 32'd0;
+            stat_hits        <= 32'd0;
+            stat_mispredicts <= 32'd0;
+        end else if (update_en) begin
+            // Remember where this jump went under this history
+            valid[update_index]   <= 1'b1;
+            tags[update_index]    <= update_tag;
+            targets[update_index] <= update_target;
+
+            stat_jumps <= stat_jumps + 1;
+            if (valid[update_index] && tags[update_index] == update_tag) begin
+                stat_hits <= stat_hits + 1;
+            end
+            if (update_mispredict) begin
+                stat_mispredicts <= stat_mispredicts + 1;
+            end
+        end
+    end
+
+endmodule
@@ -1,49 +1,114 @@
 // issue_queue.sv - Issue Queue (Reservation Stations)
 // Holds instructions waiting for operands, issues when ready
 // Implements wake-up (mark sources ready) and select (pick ready instruction)
+//
+// Branches and JALRs carry their kind, funct3 and checkpoint tag so the
+// execute stage can resolve them. On a misprediction, entries younger
+// than the branch (by ROB age) are squashed; older ones stay.
+//
+// Loads and stores only compute their address here (rs1 + imm). A store
+// also needs its data register, so it waits for both sources. The LSQ
+// index travels along so execute knows where to write the address.
+//
+// Up to WIDTH instructions are dispatched per cycle; each dispatch port
+// takes the first free slot not already claimed by a lower port.
+//
+// Up to ISSUE_WIDTH instructions issue per cycle, one per execution port.
+// Port 0 is the full unit (ALU, branches, load/store address); the other
+// ports are plain ALUs and only take instructions that are neither
+// branches nor memory ops. Each port has its own select: it takes the
+// oldest ready instruction that no lower port has picked. Every port's
+// result is broadcast back as a wakeup (WAKEUP_PORTS buses in total).
+//
+// Multiplies and divides (the fu field) only issue on MD_PORT, which feeds
+// the multiply/divide unit instead of its ALU. The divider takes one divide
+// at a time, so a divide isn't ready while div_ready is low. Their latency
+// isn't known here: the unit drives its own wakeup buses a cycle before
+// each result, like the LSQ does for loads, so dependents wait for
+// whenever that is.
+//
+// Oldest-first: slot position says nothing about age (dispatch reuses any
+// free slot), so select compares ROB ages, the distance from the ROB head
+// that squash already uses. The oldest ready instruction is usually on
+// the critical path and never waits behind younger ones.
+//
+// Statistics: a histogram of cycles spent in the queue before issue, and
+// how long ready instructions sat waiting for a port (starvation).
 
 module issue_queue #(
     parameter IQ_SIZE       = 8,
     parameter IQ_IDX_BITS   = 3,
     parameter PHYS_REG_BITS = 6,
-    parameter ROB_IDX_BITS  = 4
+    parameter ROB_IDX_BITS  = 4,
+    parameter CKPT_BITS     = 2,
+    parameter LSQ_IDX_BITS  = 3,
+    parameter WIDTH         = 1,   // Dispatch ports
+    parameter ISSUE_WIDTH   = 1,   // Issue ports
+    parameter WAKEUP_PORTS  = 1,   // Wakeup buses
+    parameter MD_PORT       = 0,   // Issue port of the multiply/divide unit
+    parameter LAT_BUCKETS   = 8    // Histogram: 0, 1, 2, 3, 4-7, 8-15, 16-31, 32+ cycles
 ) (
     input  logic        clk,
     input  logic        rst,
     input  logic        flush,
 
-    // Dispatch: insert a new instruction
-    input  logic        dispatch_en,
-    input  logic [3:0]  dispatch_alu_op,
-    input  logic        dispatch_alu_src,     // 0=reg, 1=imm
-    input  logic [31:0] dispatch_imm,
-    input  logic [PHYS_REG_BITS-1:0] dispatch_phys_rs1,
-    input  logic [PHYS_REG_BITS-1:0] dispatch_phys_rs2,
-    input  logic [PHYS_REG_BITS-1:0] dispatch_phys_rd,
-    input  logic        dispatch_src1_ready,  // Source 1 already in regfile
-    input  logic        dispatch_src2_ready,  // Source 2 already in regfile
-    input  logic [ROB_IDX_BITS-1:0] dispatch_rob_idx,
-    output logic        dispatch_ready,       // Queue has space
-
-    // Wake-up: broadcast completing instruction's phys_rd
-    input  logic        wakeup_en,
-    input  logic [PHYS_REG_BITS-1:0] wakeup_phys_rd,
-
-    // Issue: output the selected ready instruction
-    output logic        issue_valid,
-    output logic [3:0]  issue_alu_op,
-    output logic        issue_alu_src,
-    output logic [31:0] issue_imm,
-    output logic [PHYS_REG_BITS-1:0] issue_phys_rs1,
-    output logic [PHYS_REG_BITS-1:0] issue_phys_rs2,
-    output logic [PHYS_REG_BITS-1:0] issue_phys_rd,
-    output logic [ROB_IDX_BITS-1:0]  issue_rob_idx,
-    input  logic        issue_ack              // Execution unit accepted
+    // Squash: drop entries younger than squash_rob_idx (branch misprediction)
+    input  logic        squash_en,
+    input  logic [ROB_IDX_BITS-1:0] squash_rob_idx,
+    input  logic [ROB_IDX_BITS-1:0] rob_head,
+
+    // Dispatch: insert new instructions, one per port
+    input  logic [WIDTH-1:0]                    dispatch_en,
+    input  logic [WIDTH-1:0][4:0]               dispatch_alu_op,
+    input  logic [WIDTH-1:0]                    dispatch_alu_src,     // 0=reg, 1=imm
+    input  logic [WIDTH-1:0][31:0]              dispatch_imm,
+    input  logic [WIDTH-1:0][PHYS_REG_BITS-1:0] dispatch_phys_rs1,
+    input  logic [WIDTH-1:0][PHYS_REG_BITS-1:0] dispatch_phys_rs2,
+    input  logic [WIDTH-1:0][PHYS_REG_BITS-1:0] dispatch_phys_rd,
+    input  logic [WIDTH-1:0]                    dispatch_src1_ready,  // Source 1 already in regfile
+    input  logic [WIDTH-1:0]                    dispatch_src2_ready,  // Source 2 already in regfile
+    input  logic [WIDTH-1:0][ROB_IDX_BITS-1:0]  dispatch_rob_idx,
+    input  logic [WIDTH-1:0][1:0]               dispatch_br_kind,     // 00 = none, 01 = branch, 10 = JALR
+    input  logic [WIDTH-1:0][2:0]               dispatch_funct3,      // Branch condition
+    input  logic [WIDTH-1:0][CKPT_BITS-1:0]     dispatch_br_tag,
+    input  logic [WIDTH-1:0][1:0]               dispatch_mem_op,      // 00 = none, 01 = load, 10 = store
+    input  logic [WIDTH-1:0][LSQ_IDX_BITS-1:0]  dispatch_lsq_idx,
+    input  logic [WIDTH-1:0][1:0]               dispatch_fu,          // 00 = ALU, 01 = multiply, 10 = divide
+    output logic                                dispatch_ready,       // Room for a full group
+
+    // The divider can take a new divide this cycle
+    input  logic                                div_ready,
+
+    // Wake-up: broadcast the phys_rd of results that will be available next cycle
+    input  logic [WAKEUP_PORTS-1:0]                    wakeup_en,
+    input  logic [WAKEUP_PORTS-1:0][PHYS_REG_BITS-1:0] wakeup_phys_rd,
+
+    // Issue: output the selected ready instructions, one per port
+    output logic [ISSUE_WIDTH-1:0]                    issue_valid,
+    output logic [ISSUE_WIDTH-1:0][4:0]               issue_alu_op,
+    output logic [ISSUE_WIDTH-1:0]                    issue_alu_src,
+    output logic [ISSUE_WIDTH-1:0][31:0]              issue_imm,
+    output logic [ISSUE_WIDTH-1:0][PHYS_REG_BITS-1:0] issue_phys_rs1,
+    output logic [ISSUE_WIDTH-1:0][PHYS_REG_BITS-1:0] issue_phys_rs2,
+    output logic [ISSUE_WIDTH-1:0][PHYS_REG_BITS-1:0] issue_phys_rd,
+    output logic [ISSUE_WIDTH-1:0][ROB_IDX_BITS-1:0]  issue_rob_idx,
+    output logic [ISSUE_WIDTH-1:0][1:0]               issue_br_kind,
+    output logic [ISSUE_WIDTH-1:0][2:0]               issue_funct3,
+    output logic [ISSUE_WIDTH-1:0][CKPT_BITS-1:0]     issue_br_tag,
+    output logic [ISSUE_WIDTH-1:0][1:0]               issue_mem_op,
+    output logic [ISSUE_WIDTH-1:0][LSQ_IDX_BITS-1:0]  issue_lsq_idx,
+    output logic [ISSUE_WIDTH-1:0][1:0]               issue_fu,
+    input  logic [ISSUE_WIDTH-1:0]                    issue_ack,  // Execution unit accepted
+
+    // Statistics
+    output logic [LAT_BUCKETS-1:0][31:0]              stat_issue_latency, // Issues by cycles waited
+    output logic [31:0]                               stat_ready_waits,   // Entry-cycles ready, not issued
+    output logic [31:0]                               stat_max_ready_wait // Longest a ready entry waited
 );
 
     // Entry fields
     logic        valid     [0:IQ_SIZE-1];
-    logic [3:0]  alu_op    [0:IQ_SIZE-1];
+    logic [4:0]  alu_op    [0:IQ_SIZE-1];
     logic        alu_src   [0:IQ_SIZE-1];
     logic [31:0] imm       [0:IQ_SIZE-1];
     logic [PHYS_REG_BITS-1:0] phys_rs1 [0:IQ_SIZE-1];
@@ -52,124 +117,272 @@ module issue_queue #(
     logic        src1_rdy  [0:IQ_SIZE-1];
     logic        src2_rdy  [0:IQ_SIZE-1];
     logic [ROB_IDX_BITS-1:0] rob_idx [0:IQ_SIZE-1];
+    logic [1:0]  br_kind   [0:IQ_SIZE-1];
+    logic [2:0]  funct3    [0:IQ_SIZE-1];
+    logic [CKPT_BITS-1:0] br_tag [0:IQ_SIZE-1];
+    logic [1:0]  mem_op    [0:IQ_SIZE-1];
+    logic [LSQ_IDX_BITS-1:0] lsq_idx [0:IQ_SIZE-1];
+    logic [1:0]  fu        [0:IQ_SIZE-1];
+    logic [5:0]  wait_count [0:IQ_SIZE-1];  // Cycles since dispatch (saturating)
+    logic [5:0]  ready_wait [0:IQ_SIZE-1];  // Cycles ready but not picked (saturating)
 
     // Count entries
     logic [IQ_IDX_BITS:0] count;
-    assign dispatch_ready = (count < IQ_SIZE);
+    always_comb begin
+        count = 0;
+        for (int i = 0; i < IQ_SIZE; i++) begin
+            if (valid[i]) count = count + 1;
+        end
+    end
+    assign dispatch_ready = (count <= IQ_SIZE - WIDTH);
+
+    // Squash check: older/younger is distance from the ROB head
+    logic [ROB_IDX_BITS-1:0] squash_age;
+    logic [ROB_IDX_BITS-1:0] entry_age [0:IQ_SIZE-1];
+    logic                    squashed  [0:IQ_SIZE-1];
+    assign squash_age = squash_rob_idx - rob_head;
+    always_comb begin
+        for (int i = 0; i < IQ_SIZE; i++) begin
+            entry_age[i] = rob_idx[i] - rob_head;
+            squashed[i]  = squash_en && (entry_age[i] > squash_age);
+        end
+    end
 
-    // Find a free slot for dispatch
-    logic [IQ_IDX_BITS-1:0] free_slot;
-    logic free_found;
+    // Find a free slot for each dispatch port
+    logic [IQ_IDX_BITS-1:0] free_slot [0:WIDTH-1];
+    logic                   claimed   [0:IQ_SIZE-1];
+    logic                   free_found;
     always_comb begin
-        free_slot = 0;
-        free_found = 1'b0;
-        begin : find_free
-            integer i;
-            for (i = 0; i < IQ_SIZE; i++) begin
-                if (!valid[i] && !free_found) begin
-                    free_slot = i[IQ_IDX_BITS-1:0];
-                    free_found = 1'b1;
+        for (int i = 0; i < IQ_SIZE; i++) begin
+            claimed[i] = valid[i];
+        end
+        for (int k = 0; k < WIDTH; k++) begin
+            free_slot[k] = 0;
+            free_found   = 1'b0;
+            for (int i = 0; i < IQ_SIZE; i++) begin
+                if (!claimed[i] && !free_found) begin
+                    free_slot[k] = i[IQ_IDX_BITS-1:0];
+                    free_found   = 1'b1;
                 end
             end
+            claimed[free_slot[k]] = 1'b1;
         end
     end
 
-    // Select oldest ready instruction to issue
-    // "Ready" means both sources are ready (or alu_src=1 means src2 is imm)
-    logic [IQ_IDX_BITS-1:0] issue_slot;
-    logic issue_found;
+    // Wake-up match: does any broadcast this cycle produce this register?
+    function automatic logic woken(input logic [PHYS_REG_BITS-1:0] phys,
+                                   input logic [WAKEUP_PORTS-1:0] en,
+                                   input logic [WAKEUP_PORTS-1:0][PHYS_REG_BITS-1:0] rd);
+        woken = 1'b0;
+        for (int p = 0; p < WAKEUP_PORTS; p++) begin
+            if (en[p] && rd[p] == phys && rd[p] != 0)
+                woken = 1'b1;
+        end
+    endfunction
+
+    // "Ready" means both sources are ready (or alu_src=1 means src2 is imm).
+    // Stores use both: immediate for the address, src2 for data. A divide
+    // also needs the divider to be free.
+    logic entry_ready [0:IQ_SIZE-1];
     always_comb begin
-        issue_slot = 0;
-        issue_found = 1'b0;
-        issue_valid = 1'b0;
-        issue_alu_op = 4'd0;
-        issue_alu_src = 1'b0;
-        issue_imm = 32'd0;
-        issue_phys_rs1 = 0;
-        issue_phys_rs2 = 0;
-        issue_phys_rd = 0;
-        issue_rob_idx = 0;
-
-        begin : find_ready
-            integer i;
-            for (i = 0; i < IQ_SIZE; i++) begin
-                if (valid[i] && !issue_found) begin
-                    // Check if ready: src1 must be ready, src2 must be ready OR using immediate
-                    if (src1_rdy[i] && (src2_rdy[i] || alu_src[i])) begin
-                        issue_slot = i[IQ_IDX_BITS-1:0];
-                        issue_found = 1'b1;
-                        issue_valid = 1'b1;
-                        issue_alu_op = alu_op[i];
-                        issue_alu_src = alu_src[i];
-                        issue_imm = imm[i];
-                        issue_phys_rs1 = phys_rs1[i];
-                        issue_phys_rs2 = phys_rs2[i];
-                        issue_phys_rd = phys_rd[i];
-                        issue_rob_idx = rob_idx[i];
-                    end
+        for (int i = 0; i < IQ_SIZE; i++) begin
+            entry_ready[i] = valid[i] && src1_rdy[i] &&
+                             (src2_rdy[i] || (alu_src[i] && mem_op[i] != 2'b10)) &&
+                             (fu[i] != 2'b10 || div_ready);
+        end
+    end
+
+    // Select one ready instruction per port, oldest (smallest ROB age) first
+    logic [IQ_IDX_BITS-1:0]  issue_slot [0:ISSUE_WIDTH-1];
+    logic                    picked     [0:IQ_SIZE-1];
+    logic [ROB_IDX_BITS-1:0] best_age;
+    always_comb begin
+        for (int i = 0; i < IQ_SIZE; i++) begin
+            picked[i] = 1'b0;
+        end
+
+        for (int p = 0; p < ISSUE_WIDTH; p++) begin
+            best_age          = '1;
+            issue_slot[p]     = 0;
+            issue_valid[p]    = 1'b0;
+            issue_alu_op[p]   = 5'd0;
+            issue_alu_src[p]  = 1'b0;
+            issue_imm[p]      = 32'd0;
+            issue_phys_rs1[p] = 0;
+            issue_phys_rs2[p] = 0;
+            issue_phys_rd[p]  = 0;
+            issue_rob_idx[p]  = 0;
+            issue_br_kind[p]  = 2'b00;
+            issue_funct3[p]   = 3'b000;
+            issue_br_tag[p]   = 0;
+            issue_mem_op[p]   = 2'b00;
+            issue_lsq_idx[p]  = 0;
+            issue_fu[p]       = 2'b00;
+
+            for (int i = 0; i < IQ_SIZE; i++) begin
+                // Ports other than 0 only have an ALU; multiplies and
+                // divides only go to MD_PORT
+                if (entry_ready[i] && !picked[i] &&
+                    (!issue_valid[p] || entry_age[i] < best_age) &&
+                    (p == 0 || (br_kind[i] == 2'b00 && mem_op[i] == 2'b00)) &&
+                    (p == MD_PORT || fu[i] == 2'b00)) begin
+                    best_age          = entry_age[i];
+                    issue_slot[p]     = i[IQ_IDX_BITS-1:0];
+                    issue_valid[p]    = 1'b1;
+                    issue_alu_op[p]   = alu_op[i];
+                    issue_alu_src[p]  = alu_src[i];
+                    issue_imm[p]      = imm[i];
+                    issue_phys_rs1[p] = phys_rs1[i];
+                    issue_phys_rs2[p] = phys_rs2[i];
+                    issue_phys_rd[p]  = phys_rd[i];
+                    issue_rob_idx[p]  = rob_idx[i];
+                    issue_br_kind[p]  = br_kind[i];
+                    issue_funct3[p]   = funct3[i];
+                    issue_br_tag[p]   = br_tag[i];
+                    issue_mem_op[p]   = mem_op[i];
+                    issue_lsq_idx[p]  = lsq_idx[i];
+                    issue_fu[p]       = fu[i];
                 end
             end
+
+            if (issue_valid[p])
+                picked[issue_slot[p]] = 1'b1;
+        end
+    end
+
+    // Histogram bucket for a number of cycles waited
+    function automatic int lat_bucket(input logic [5:0] cycles);
+        if (cycles < 4)       lat_bucket = cycles;
+        else if (cycles < 8)  lat_bucket = 4;
+        else if (cycles < 16) lat_bucket = 5;
+        else if (cycles < 32) lat_bucket = 6;
+        else                  lat_bucket = 7;
+    endfunction
+
+    // Issue latency histogram and starvation counters
+    logic [LAT_BUCKETS-1:0][31:0] lat_next;
+    logic [31:0]                  ready_waits_next;
+    logic [31:0]                  max_ready_wait_next;
+    always_comb begin
+        lat_next            = stat_issue_latency;
+        ready_waits_next    = stat_ready_waits;
+        max_ready_wait_next = stat_max_ready_wait;
+        for (int p = 0; p < ISSUE_WIDTH; p++) begin
+            if (issue_valid[p] && issue_ack[p]) begin
+                lat_next[lat_bucket(wait_count[issue_slot[p]])] =
+                    lat_next[lat_bucket(wait_count[issue_slot[p]])] + 1;
+                if (ready_wait[issue_slot[p]] > max_ready_wait_next)
+                    max_ready_wait_next = ready_wait[issue_slot[p]];
+            end
+        end
+        for (int i = 0; i < IQ_SIZE; i++) begin
+            if (entry_ready[i] && !picked[i])
+                ready_waits_next = ready_waits_next + 1;
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_issue_latency  <= '0;
+            stat_ready_waits    <= 32'd0;
+            stat_max_ready_wait <= 32'd0;
+        end else if (!flush) begin
+            stat_issue_latency  <= lat_next;
+            stat_ready_waits    <= ready_waits_next;
+            stat_max_ready_wait <= max_ready_wait_next;
         end
     end
 
     always_ff @(posedge clk or posedge rst) begin
         if (rst || flush) begin
-            count <= 0;
             begin : rst_loop
                 integer i;
                 for (i = 0; i < IQ_SIZE; i++) begin
                     valid[i]    <= 1'b0;
                     src1_rdy[i] <= 1'b0;
                     src2_rdy[i] <= 1'b0;
-                    alu_op[i]   <= 4'd0;
+                    alu_op[i]   <= 5'd0;
                     alu_src[i]  <= 1'b0;
                     imm[i]      <= 32'd0;
                     phys_rs1[i] <= 0;
                     phys_rs2[i] <= 0;
                     phys_rd[i]  <= 0;
                     rob_idx[i]  <= 0;
+                    br_kind[i]  <= 2'b00;
+                    funct3[i]   <= 3'b000;
+                    br_tag[i]   <= 0;
+                    mem_op[i]   <= 2'b00;
+                    lsq_idx[i]  <= 0;
+                    fu[i]       <= 2'b00;
+                    wait_count[i] <= 0;
+                    ready_wait[i] <= 0;
                 end
             end
         end else begin
             // Wake-up: mark sources ready when their producer completes
-            if (wakeup_en) begin
-                begin : wakeup_loop
-                    integer i;
-                    for (i = 0; i < IQ_SIZE; i++) begin
-                        if (valid[i]) begin
-                            if (phys_rs1[i] == wakeup_phys_rd && wakeup_phys_rd != 0)
-                                src1_rdy[i] <= 1'b1;
-                            if (phys_rs2[i] == wakeup_phys_rd && wakeup_phys_rd != 0)
-                                src2_rdy[i] <= 1'b1;
-                        end
+            begin : wakeup_loop
+                integer i;
+                for (i = 0; i < IQ_SIZE; i++) begin
+                    if (valid[i]) begin
+                        if (woken(phys_rs1[i], wakeup_en, wakeup_phys_rd))
+                            src1_rdy[i] <= 1'b1;
+                        if (woken(phys_rs2[i], wakeup_en, wakeup_phys_rd))
+                            src2_rdy[i] <= 1'b1;
                     end
                 end
             end
 
-            // Issue: remove the issued instruction
-            if (issue_valid && issue_ack) begin
-                valid[issue_slot] <= 1'b0;
-                count <= count - (dispatch_en && dispatch_ready ? 0 : 1);
-            end else if (dispatch_en && dispatch_ready) begin
-                count <= count + 1;
+            // Age the waiting entries (they saturate rather than wrap)
+            for (int i = 0; i < IQ_SIZE; i++) begin
+                if (valid[i] && wait_count[i] != 6'h3F)
+                    wait_count[i] <= wait_count[i] + 1'b1;
+                if (entry_ready[i] && !picked[i] && ready_wait[i] != 6'h3F)
+                    ready_wait[i] <= ready_wait[i] + 1'b1;
+            end
+
+            // Issue: remove the issued instructions
+            for (int p = 0; p < ISSUE_WIDTH; p++) begin
+                if (issue_valid[p] && issue_ack[p])
+                    valid[issue_slot[p]] <= 1'b0;
             end
 
-            // Dispatch: insert new instruction
-            if (dispatch_en && dispatch_ready) begin
-                valid[free_slot]     <= 1'b1;
-                alu_op[free_slot]    <= dispatch_alu_op;
-                alu_src[free_slot]   <= dispatch_alu_src;
-                imm[free_slot]       <= dispatch_imm;
-                phys_rs1[free_slot]  <= dispatch_phys_rs1;
-                phys_rs2[free_slot]  <= dispatch_phys_rs2;
-                phys_rd[free_slot]   <= dispatch_phys_rd;
-                rob_idx[free_slot]   <= dispatch_rob_idx;
-
-                // Check if sources are already ready (or being woken up this cycle)
-                src1_rdy[free_slot]  <= dispatch_src1_ready ||
-                                        (wakeup_en && dispatch_phys_rs1 == wakeup_phys_rd && wakeup_phys_rd != 0);
-                src2_rdy[free_slot]  <= dispatch_src2_ready ||
-                                        (wakeup_en && dispatch_phys_rs2 == wakeup_phys_rd && wakeup_phys_rd != 0);
+            // Squash: remove wrong-path instructions
+            begin : squash_loop
+                integer i;
+                for (i = 0; i < IQ_SIZE; i++) begin
+                    if (valid[i] && squashed[i])
+                        valid[i] <= 1'b0;
+                end
+            end
+
+            // Dispatch: insert new instructions (not while squashing)
+            if (dispatch_ready && !squash_en) begin
+                for (int k = 0; k < WIDTH; k++) begin
+                    if (dispatch_en[k]) begin
+                        valid[free_slot[k]]     <= 1'b1;
+                        alu_op[free_slot[k]]    <= dispatch_alu_op[k];
+                        alu_src[free_slot[k]]   <= dispatch_alu_src[k];
+                        imm[free_slot[k]]       <= dispatch_imm[k];
+                        phys_rs1[free_slot[k]]  <= dispatch_phys_rs1[k];
+                        phys_rs2[free_slot[k]]  <= dispatch_phys_rs2[k];
+                        phys_rd[free_slot[k]]   <= dispatch_phys_rd[k];
+                        rob_idx[free_slot[k]]   <= dispatch_rob_idx[k];
+                        br_kind[free_slot[k]]   <= dispatch_br_kind[k];
+                        funct3[free_slot[k]]    <= dispatch_funct3[k];
+                        br_tag[free_slot[k]]    <= dispatch_br_tag[k];
+                        mem_op[free_slot[k]]    <= dispatch_mem_op[k];
+                        lsq_idx[free_slot[k]]   <= dispatch_lsq_idx[k];
+                        fu[free_slot[k]]        <= dispatch_fu[k];
+                        wait_count[free_slot[k]] <= 0;
+                        ready_wait[free_slot[k]] <= 0;
+
+                        // Check if sources are already ready (or being woken up this cycle)
+                        src1_rdy[free_slot[k]]  <= dispatch_src1_ready[k] ||
+                                                   woken(dispatch_phys_rs1[k], wakeup_en, wakeup_phys_rd);
+                        src2_rdy[free_slot[k]]  <= dispatch_src2_ready[k] ||
+                                                   woken(dispatch_phys_rs2[k], wakeup_en, wakeup_phys_rd);
+                    end
+                end
             end
         end
     end
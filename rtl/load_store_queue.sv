@@ -0,0 +1,348 @@
+// load_store_queue.sv - Load/Store Queue for the OoO CPU
+// Holds every load and store in program order, between dispatch and the
+// moment it leaves the core (loads at commit, stores once written)
+//
+// Life of an entry:
+// - Allocate: at dispatch, in program order (tail)
+// - Address:  the issue queue sends the instruction through the ALU as
+//             soon as its base register is ready; the address (and store
+//             data) is written into the entry, out of order
+// - Loads execute from here: the oldest load with a known address goes
+//   next. It takes its data from the youngest older store to the same
+//   word, or from the D-cache if there is none. Older stores whose
+//   address isn't known yet are ignored: the load is speculative.
+//   The exception is a load the store-set predictor tied to an older
+//   store at dispatch: it waits until that store has its address.
+// - Stores only write the D-cache after they commit, from the head
+//
+// Ordering violations:
+// - When a store's address arrives, any younger load that already ran
+//   with the same address (and didn't get its data from a store younger
+//   than this one) read a stale value. It is marked, and when it reaches
+//   commit the CPU flushes and refetches from that load (replay).
+//
+// Pointers (extra bit for full/empty, like the free list):
+//   head       oldest entry (committed stores waiting to drain)
+//   commit_ptr oldest uncommitted entry
+//   tail       next free entry
+//
+// Recovery:
+// - Branch misprediction: restore the tail saved in the branch checkpoint
+// - Replay flush: drop every uncommitted entry; committed stores stay
+
+module load_store_queue #(
+    parameter LSQ_SIZE      = 8,
+    parameter LSQ_IDX_BITS  = 3,    // log2(LSQ_SIZE)
+    parameter ROB_IDX_BITS  = 4,
+    parameter PHYS_REG_BITS = 6,
+    parameter NUM_CKPTS     = 4,
+    parameter CKPT_BITS     = 2
+) (
+    input  logic        clk,
+    input  logic        rst,
+    input  logic        flush,          // Replay: drop uncommitted entries
+
+    // Allocate (dispatch, program order)
+    input  logic                     alloc_en,
+    input  logic                     alloc_is_store,
+    input  logic [ROB_IDX_BITS-1:0]  alloc_rob_idx,
+    input  logic [PHYS_REG_BITS-1:0] alloc_phys_rd,   // Load destination
+    input  logic [31:0]              alloc_pc,
+    input  logic                     alloc_wait_valid, // Predicted dependence:
+    input  logic [LSQ_IDX_BITS-1:0]  alloc_wait_idx,   // wait for this store
+    output logic [LSQ_IDX_BITS-1:0]  alloc_idx,
+    output logic                     alloc_ready,
+
+    // Address (and store data) from execute
+    input  logic                     addr_en,
+    input  logic [LSQ_IDX_BITS-1:0]  addr_idx,
+    input  logic [31:0]              addr,
+    input  logic [31:0]              store_data,
+
+    // Load result (to the complete stage, which always takes it)
+    output logic                     load_done,
+    output logic [ROB_IDX_BITS-1:0]  load_rob_idx,
+    output logic [PHYS_REG_BITS-1:0] load_phys_rd,
+    output logic [31:0]              load_data,
+
+    // D-cache port
+    output logic [31:0]              cache_addr,
+    output logic                     cache_read_en,
+    output logic                     cache_write_en,
+    output logic [31:0]              cache_write_data,
+    input  logic [31:0]              cache_read_data,
+    input  logic                     cache_stall,
+
+    // Commit: the oldest uncommitted entry, for the ROB head to match
+    output logic                     commit_pending,
+    output logic [ROB_IDX_BITS-1:0]  commit_rob_idx,
+    output logic                     commit_violation,  // Load must replay
+    input  logic                     commit_en,
+
+    // Ordering violation (to train the store-set predictor)
+    output logic                     violation_en,
+    output logic [31:0]              violation_load_pc,
+    output logic [31:0]              violation_store_pc,
+
+    // Branch checkpoints: save / restore the tail
+    input  logic                     ckpt_en,
+    input  logic [CKPT_BITS-1:0]     ckpt_id,
+    input  logic                     restore_en,
+    input  logic [CKPT_BITS-1:0]     restore_id,
+
+    // Statistics
+    output logic [31:0]              stat_forwards,    // Loads fed by an older store
+    output logic [31:0]              stat_violations,  // Loads marked for replay
+    output logic [31:0]              stat_spec_loads   // Loads that ran past an unknown store address
+);
+
+    // Entry fields (separate arrays for Icarus compatibility)
+    logic                     is_store   [0:LSQ_SIZE-1];
+    logic                     addr_valid [0:LSQ_SIZE-1];
+    logic [31:0]              address    [0:LSQ_SIZE-1];
+    logic [31:0]              data       [0:LSQ_SIZE-1];  // Store data
+    logic [ROB_IDX_BITS-1:0]  rob_idx    [0:LSQ_SIZE-1];
+    logic [PHYS_REG_BITS-1:0] phys_rd    [0:LSQ_SIZE-1];
+    logic                     done       [0:LSQ_SIZE-1];  // Load has its data
+    logic                     violation  [0:LSQ_SIZE-1];
+    logic                     fwd_valid  [0:LSQ_SIZE-1];  // Load forwarded from...
+    logic [LSQ_IDX_BITS-1:0]  fwd_idx    [0:LSQ_SIZE-1];  // ...this store
+    logic [31:0]              pc         [0:LSQ_SIZE-1];
+    logic                     wait_valid [0:LSQ_SIZE-1];  // Predicted dependence
+    logic [LSQ_IDX_BITS-1:0]  wait_idx   [0:LSQ_SIZE-1];
+
+    logic [LSQ_IDX_BITS:0]    head;
+    logic [LSQ_IDX_BITS:0]    commit_ptr;
+    logic [LSQ_IDX_BITS:0]    tail;
+    logic [LSQ_IDX_BITS:0]    count;
+    logic [LSQ_IDX_BITS:0]    tail_ckpt [0:NUM_CKPTS-1];
+
+    logic [LSQ_IDX_BITS-1:0]  head_idx;
+    logic [LSQ_IDX_BITS-1:0]  commit_idx;
+
+    assign head_idx   = head[LSQ_IDX_BITS-1:0];
+    assign commit_idx = commit_ptr[LSQ_IDX_BITS-1:0];
+    assign count      = tail - head;
+
+    assign alloc_idx   = tail[LSQ_IDX_BITS-1:0];
+    assign alloc_ready = (count < LSQ_SIZE);
+
+    // Age of every entry (0 = head)
+    logic [LSQ_IDX_BITS-1:0] entry_age [0:LSQ_SIZE-1];
+    logic                    in_use    [0:LSQ_SIZE-1];
+    logic                    blocked   [0:LSQ_SIZE-1];  // Waiting on a predicted store
+
+    always_comb begin
+        for (int i = 0; i < LSQ_SIZE; i++) begin
+            entry_age[i] = i[LSQ_IDX_BITS-1:0] - head_idx;
+            in_use[i]    = ({1'b0, entry_age[i]} < count);
+        end
+        // The store must still be there and older: the slot may have been
+        // drained and reused since dispatch
+        for (int i = 0; i < LSQ_SIZE; i++) begin
+            blocked[i] = wait_valid[i] && in_use[wait_idx[i]] && is_store[wait_idx[i]] &&
+                         !addr_valid[wait_idx[i]] && (entry_age[wait_idx[i]] < entry_age[i]);
+        end
+    end
+
+    // ========================================================================
+    // Load select: oldest load with an address that hasn't run yet
+    // ========================================================================
+    logic                    ld_found;
+    logic [LSQ_IDX_BITS-1:0] ld_idx;
+
+    always_comb begin
+        ld_found = 1'b0;
+        ld_idx   = '0;
+        for (int k = 0; k < LSQ_SIZE; k++) begin
+            if (!ld_found && k < count) begin
+                if (!is_store[head_idx + k[LSQ_IDX_BITS-1:0]] &&
+                    addr_valid[head_idx + k[LSQ_IDX_BITS-1:0]] &&
+                    !done[head_idx + k[LSQ_IDX_BITS-1:0]] &&
+                    !blocked[head_idx + k[LSQ_IDX_BITS-1:0]]) begin
+                    ld_found = 1'b1;
+                    ld_idx   = head_idx + k[LSQ_IDX_BITS-1:0];
+                end
+            end
+        end
+    end
+
+    // Store-to-load forwarding: youngest older store to the same word
+    logic                    fwd_hit;
+    logic [LSQ_IDX_BITS-1:0] fwd_src;
+    logic                    ld_speculative;  // An older store address is still unknown
+
+    always_comb begin
+        fwd_hit = 1'b0;
+        fwd_src = '0;
+        ld_speculative = 1'b0;
+        for (int k = 0; k < LSQ_SIZE; k++) begin
+            if (k < entry_age[ld_idx] &&
+                is_store[head_idx + k[LSQ_IDX_BITS-1:0]] &&
+                !addr_valid[head_idx + k[LSQ_IDX_BITS-1:0]]) begin
+                ld_speculative = 1'b1;
+            end
+            if (k < entry_age[ld_idx] &&
+                is_store[head_idx + k[LSQ_IDX_BITS-1:0]] &&
+                addr_valid[head_idx + k[LSQ_IDX_BITS-1:0]] &&
+                address[head_idx + k[LSQ_IDX_BITS-1:0]][31:2] == address[ld_idx][31:2]) begin
+                fwd_hit = 1'b1;
+                fwd_src = head_idx + k[LSQ_IDX_BITS-1:0];
+            end
+        end
+    end
+
+    // ========================================================================
+    // D-cache port: loads first, committed stores drain when it's free
+    // ========================================================================
+    logic ld_needs_cache;
+    logic st_drain;
+    logic st_written;
+
+    assign ld_needs_cache = ld_found && !fwd_hit;
+    assign st_drain       = (head != commit_ptr) && is_store[head_idx];
+
+    assign cache_read_en    = ld_needs_cache;
+    assign cache_write_en   = !ld_needs_cache && st_drain;
+    assign cache_addr       = ld_needs_cache ? address[ld_idx] : address[head_idx];
+    assign cache_write_data = data[head_idx];
+
+    assign st_written = cache_write_en && !cache_stall;
+
+    assign load_done    = ld_found && (fwd_hit || !cache_stall);
+    assign load_rob_idx = rob_idx[ld_idx];
+    assign load_phys_rd = phys_rd[ld_idx];
+    assign load_data    = fwd_hit ? data[fwd_src] : cache_read_data;
+
+    // ========================================================================
+    // Violation check: a store address arriving after a younger load ran
+    // ========================================================================
+    logic                    st_addr_en;
+    logic [LSQ_IDX_BITS-1:0] st_age;
+    logic                    stale      [0:LSQ_SIZE-1];
+    logic                    stale_now;  // The load running this cycle
+    logic                    stale_any;
+    logic [31:0]             stale_pc;   // One of the loads, for training
+
+    assign st_addr_en = addr_en && is_store[addr_idx];
+    assign st_age     = entry_age[addr_idx];
+
+    always_comb begin
+        for (int i = 0; i < LSQ_SIZE; i++) begin
+            stale[i] = st_addr_en && in_use[i] && !is_store[i] && done[i] &&
+                       entry_age[i] > st_age &&
+                       address[i][31:2] == addr[31:2] &&
+                       !(fwd_valid[i] && entry_age[fwd_idx[i]] > st_age);
+        end
+        stale_now = st_addr_en && load_done &&
+                    entry_age[ld_idx] > st_age &&
+                    address[ld_idx][31:2] == addr[31:2] &&
+                    !(fwd_hit && entry_age[fwd_src] > st_age);
+        stale_any = stale_now;
+        stale_pc  = pc[ld_idx];
+        for (int i = 0; i < LSQ_SIZE; i++) begin
+            if (stale[i]) begin
+                stale_any = 1'b1;
+                stale_pc  = pc[i];
+            end
+        end
+    end
+
+    assign violation_en       = stale_any;
+    assign violation_load_pc  = stale_pc;
+    assign violation_store_pc = pc[addr_idx];
+
+    // ========================================================================
+    // Commit
+    // ========================================================================
+    assign commit_pending   = (commit_ptr != tail);
+    assign commit_rob_idx   = rob_idx[commit_idx];
+    assign commit_violation = !is_store[commit_idx] && violation[commit_idx];
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            head       <= '0;
+            commit_ptr <= '0;
+            tail       <= '0;
+            stat_forwards   <= 32'd0;
+            stat_violations <= 32'd0;
+            stat_spec_loads <= 32'd0;
+            for (int i = 0; i < LSQ_SIZE; i++) begin
+                is_store[i]   <= 1'b0;
+                addr_valid[i] <= 1'b0;
+                address[i]    <= 32'd0;
+                data[i]       <= 32'd0;
+                rob_idx[i]    <= '0;
+                phys_rd[i]    <= '0;
+                done[i]       <= 1'b0;
+                violation[i]  <= 1'b0;
+                fwd_valid[i]  <= 1'b0;
+                fwd_idx[i]    <= '0;
+                pc[i]         <= 32'd0;
+                wait_valid[i] <= 1'b0;
+                wait_idx[i]   <= '0;
+            end
+        end else begin
+            // Tail: replay flush > branch restore > allocate
+            if (flush) begin
+                tail <= commit_ptr;  // Nothing commits in a replay cycle
+            end else if (restore_en) begin
+                tail <= tail_ckpt[restore_id];
+            end else if (alloc_en && alloc_ready) begin
+                is_store[alloc_idx]   <= alloc_is_store;
+                addr_valid[alloc_idx] <= 1'b0;
+                rob_idx[alloc_idx]    <= alloc_rob_idx;
+                phys_rd[alloc_idx]    <= alloc_phys_rd;
+                done[alloc_idx]       <= 1'b0;
+                violation[alloc_idx]  <= 1'b0;
+                fwd_valid[alloc_idx]  <= 1'b0;
+                pc[alloc_idx]         <= alloc_pc;
+                wait_valid[alloc_idx] <= alloc_wait_valid;
+                wait_idx[alloc_idx]   <= alloc_wait_idx;
+                tail <= tail + 1'b1;
+            end
+
+            if (ckpt_en) begin
+                tail_ckpt[ckpt_id] <= tail + ((alloc_en && alloc_ready) ? 1 : 0);
+            end
+
+            // Address and store data
+            if (addr_en && !flush) begin
+                addr_valid[addr_idx] <= 1'b1;
+                address[addr_idx]    <= addr;
+                data[addr_idx]       <= store_data;
+            end
+
+            // Older loads that read too early
+            for (int i = 0; i < LSQ_SIZE; i++) begin
+                if (stale[i]) violation[i] <= 1'b1;
+            end
+
+            // Load executed
+            if (load_done) begin
+                done[ld_idx]      <= 1'b1;
+                fwd_valid[ld_idx] <= fwd_hit;
+                fwd_idx[ld_idx]   <= fwd_src;
+                violation[ld_idx] <= stale_now;
+                if (fwd_hit) stat_forwards <= stat_forwards + 1;
+                if (ld_speculative) stat_spec_loads <= stat_spec_loads + 1;
+            end
+
+            if (stale_any) begin
+                stat_violations <= stat_violations + 1;
+            end
+
+            // Commit in order
+            if (commit_en) begin
+                commit_ptr <= commit_ptr + 1'b1;
+            end
+
+            // Leave from the head: committed loads right away, committed
+            // stores once the D-cache has taken them
+            if (head != commit_ptr && (!is_store[head_idx] || st_written)) begin
+                head <= head + 1'b1;
+            end
+        end
+    end
+
+endmodule
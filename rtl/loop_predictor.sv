@@ -0,0 +1,206 @@
+// loop_predictor.sv - Learns trip counts of counted loops
+//
+// A loop branch with a fixed trip count is taken N times, then not taken
+// once. Saturating counters always predict "taken" there, so the exit
+// mispredicts every time the loop runs. A loop predictor counts instead:
+//
+// Structure:
+// - Small direct-mapped table of backward conditional branches
+// - Each entry: [valid][tag][trip count][speculative iteration]
+//               [committed iteration][2-bit confidence]
+// - trip = number of times the branch was taken before it fell through
+//
+// Prediction (IF):
+// - Only when the entry is confident (seen the same trip count 3 times in
+//   a row) does it override the base predictor
+// - Predict not taken once the speculative iteration reaches the trip
+//   count, taken otherwise
+// - The speculative iteration advances with every fetched instance of the
+//   branch, so instances still in flight are counted
+// - Each prediction hands out a checkpoint: every entry's speculative
+//   iteration before the prediction touches one. When the front end
+//   throws predictions away without a misprediction (IF's predecode
+//   redirect), restoring the redirected instruction's checkpoint takes
+//   back the increments fetch made past it, in whichever entries they
+//   went to, while keeping those of older branches still in flight. A
+//   branch that was predicted not taken and only redirects for its length
+//   keeps its own outcome: its entry restarts at 0 after the restore
+//
+// Update (EX):
+// - Committed iteration counts real outcomes. On the exit, compare it with
+//   the stored trip count: same => more confident, different => relearn
+// - A mispredicted exit of an unknown backward branch allocates an entry
+// - On any misprediction the wrong path is gone, so every speculative
+//   iteration is reset to its committed value
+
+module loop_predictor #(
+    parameter INDEX_BITS = 3,  // 2^3 = 8 entries
+    parameter TAG_BITS   = 10, // PC bits for matching
+    parameter COUNT_BITS = 8   // Longest trip count we can learn: 2^8 - 1
+)(
+    input  logic        clk,
+    input  logic        rst,
+
+    // Prediction interface (IF stage)
+    input  logic [31:0] pc_if,
+    output logic        predict_valid,   // Confident: use predict_taken
+    output logic        predict_taken,
+    input  logic        predict_en,      // Conditional branch leaving IF
+    input  logic        predict_final,   // Direction the CPU actually predicted
+    output logic [(1 << INDEX_BITS)-1:0][COUNT_BITS-1:0] ckpt_iter, // Checkpoint for this prediction
+
+    // Front-end redirect (predecode): roll back to a prediction's checkpoint
+    input  logic                                         restore_en,
+    input  logic [(1 << INDEX_BITS)-1:0][COUNT_BITS-1:0] restore_iter,
+    input  logic [31:0]                                  restore_pc,        // Redirected instruction
+    input  logic                                         restore_not_taken, // ...is a not-taken branch
+
+    // Update interface (when the branch resolves)
+    input  logic        update_en,       // Conditional branch resolved
+    input  logic [31:0] update_pc,
+    input  logic        update_backward, // Target is below the branch
+    input  logic        actual_taken,
+    input  logic        mispredict,      // Any misprediction this cycle (repair)
+
+    // Statistics
+    output logic [31:0] stat_predictions, // Resolved branches the loop predictor covered
+    output logic [31:0] stat_wrong        // ...that it got wrong
+);
+
+    localparam NUM_ENTRIES = (1 << INDEX_BITS);
+
+    logic                  valid       [0:NUM_ENTRIES-1];
+    logic [TAG_BITS-1:0]   tags        [0:NUM_ENTRIES-1];
+    logic [COUNT_BITS-1:0] trip        [0:NUM_ENTRIES-1];
+    logic [COUNT_BITS-1:0] spec_iter   [0:NUM_ENTRIES-1];
+    logic [COUNT_BITS-1:0] commit_iter [0:NUM_ENTRIES-1];
+    logic [1:0]            conf        [0:NUM_ENTRIES-1];
+
+    // Index and tag extraction (skip bottom 2 bits; bit 1 of a compressed
+    // branch's PC flips the bottom tag bit)
+    logic [INDEX_BITS-1:0] p_index;
+    logic [TAG_BITS-1:0]   p_tag;
+    logic [INDEX_BITS-1:0] u_index;
+    logic [TAG_BITS-1:0]   u_tag;
+    logic [INDEX_BITS-1:0] r_index;
+    logic [TAG_BITS-1:0]   r_tag;
+
+    assign p_index = pc_if[INDEX_BITS+1:2];
+    assign p_tag   = pc_if[INDEX_BITS+TAG_BITS+1:INDEX_BITS+2] ^ {{(TAG_BITS-1){1'b0}}, pc_if[1]};
+    assign u_index = update_pc[INDEX_BITS+1:2];
+    assign u_tag   = update_pc[INDEX_BITS+TAG_BITS+1:INDEX_BITS+2] ^ {{(TAG_BITS-1){1'b0}}, update_pc[1]};
+    assign r_index = restore_pc[INDEX_BITS+1:2];
+    assign r_tag   = restore_pc[INDEX_BITS+TAG_BITS+1:INDEX_BITS+2] ^ {{(TAG_BITS-1){1'b0}}, restore_pc[1]};
+
+    logic p_hit;
+    logic u_hit;
+    logic r_hit;
+
+    assign p_hit = valid[p_index] && (tags[p_index] == p_tag);
+    assign u_hit = valid[u_index] && (tags[u_index] == u_tag);
+    assign r_hit = valid[r_index] && (tags[r_index] == r_tag);
+
+    // Prediction
+    assign predict_valid = p_hit && (conf[p_index] == 2'b11);
+    assign predict_taken = (spec_iter[p_index] != trip[p_index]);
+
+    always_comb begin
+        for (int i = 0; i < NUM_ENTRIES; i++)
+            ckpt_iter[i] = spec_iter[i];
+    end
+
+    // What a confident entry should have said, from committed state
+    logic u_confident;
+    logic u_predicted;
+
+    assign u_confident = u_hit && (conf[u_index] == 2'b11);
+    assign u_predicted = (commit_iter[u_index] != trip[u_index]);
+
+    // Committed iteration after this update
+    logic [COUNT_BITS-1:0] u_commit_next;
+    assign u_commit_next = actual_taken ? commit_iter[u_index] + 1'b1 : '0;
+
+    initial begin
+        for (int i = 0; i < NUM_ENTRIES; i++) begin
+            valid[i]       = 1'b0;
+            tags[i]        = '0;
+            trip[i]        = '0;
+            spec_iter[i]   = '0;
+            commit_iter[i] = '0;
+            conf[i]        = 2'b00;
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            for (int i = 0; i < NUM_ENTRIES; i++) begin
+                valid[i]       <= 1'b0;
+                tags[i]        <= '0;
+                trip[i]        <= '0;
+                spec_iter[i]   <= '0;
+                commit_iter[i] <= '0;
+                conf[i]        <= 2'b00;
+            end
+            stat_predictions <= 32'd0;
+            stat_wrong       <= 32'd0;
+        end else begin
+            // Speculative iteration tracking at fetch
+            if (restore_en) begin
+                for (int i = 0; i < NUM_ENTRIES; i++)
+                    spec_iter[i] <= restore_iter[i];
+                if (restore_not_taken && r_hit)
+                    spec_iter[r_index] <= '0;
+            end else if (predict_en && p_hit && !mispredict) begin
+                spec_iter[p_index] <= predict_final ? spec_iter[p_index] + 1'b1 : '0;
+            end
+
+            // Repair: the wrong path is gone, resync speculative counts
+            if (mispredict) begin
+                for (int i = 0; i < NUM_ENTRIES; i++) begin
+                    spec_iter[i] <= commit_iter[i];
+                end
+            end
+
+            if (update_en && u_hit) begin
+                commit_iter[u_index] <= u_commit_next;
+                if (mispredict) begin
+                    spec_iter[u_index] <= u_commit_next;
+                end
+
+                if (!actual_taken) begin
+                    // Loop exit: did it run the same number of times again?
+                    if (commit_iter[u_index] == trip[u_index]) begin
+                        if (conf[u_index] != 2'b11)
+                            conf[u_index] <= conf[u_index] + 2'b01;
+                    end else begin
+                        trip[u_index] <= commit_iter[u_index];
+                        conf[u_index] <= 2'b00;
+                    end
+                end else if (commit_iter[u_index] == {COUNT_BITS{1'b1}}) begin
+                    // Trip count too long to track
+                    valid[u_index] <= 1'b0;
+                end
+
+                if (u_confident) begin
+                    stat_predictions <= stat_predictions + 1;
+                    if (u_predicted != actual_taken)
+                        stat_wrong <= stat_wrong + 1;
+                end
+            end else if (update_en && update_backward && !actual_taken && mispredict) begin
+                // Mispredicted exit of an unknown loop: start learning it,
+                // unless the slot holds a confident loop (age that instead)
+                if (!valid[u_index] || conf[u_index] == 2'b00) begin
+                    valid[u_index]       <= 1'b1;
+                    tags[u_index]        <= u_tag;
+                    trip[u_index]        <= '0;
+                    spec_iter[u_index]   <= '0;
+                    commit_iter[u_index] <= '0;
+                    conf[u_index]        <= 2'b00;
+                end else begin
+                    conf[u_index] <= conf[u_index] - 2'b01;
+                end
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,130 @@
+// macro_fusion.sv - Detects adjacent instruction pairs that run as one op
+//
+// Looks at two consecutive instructions (first at first_pc, second right
+// after it) and, if they form one of the pairs below, describes the single
+// internal op that replaces them. The fused op takes the second
+// instruction's place (its PC, prediction and control-flow type); the
+// first instruction is dropped.
+//
+//   LI:     lui  r, hi     + addi r, r, lo     -> r = hi + lo
+//   CALL:   auipc r, hi    + jalr r, lo(r)     -> jump to first_pc + hi + lo, r = link
+//   CMP_BR: slt[u] r, a, b + bne/beq r, x0, L  -> r = a < b, branch on a < b / a >= b
+//
+// Every pair writes the same register in both halves (or, for CMP_BR, the
+// branch only reads it), so the first instruction's result is never seen
+// on its own and dropping it is invisible. Register x0 never fuses.
+//
+// The fused op uses the normal ALU encodings: LI and CALL add an immediate
+// to x0 (CALL's immediate is the jump target), CMP_BR is an SLT/SLTU on
+// a and b whose branch compares the same operands (BLT/BGE or BLTU/BGEU).
+
+module macro_fusion (
+    input  logic [31:0] first,
+    input  logic [31:0] second,
+    input  logic [31:0] first_pc,
+
+    output logic        fuse,         // The pair fuses
+    output logic [1:0]  kind,         // Which pair (see below)
+
+    // The fused op (only meaningful when fuse is set)
+    output logic [4:0]  rs1,
+    output logic [4:0]  rs2,
+    output logic [4:0]  rd,
+    output logic [31:0] imm,          // ALU immediate, or branch offset for CMP_BR
+    output logic [4:0]  alu_op,
+    output logic        alu_src,      // 0 = rs2, 1 = immediate
+    output logic [2:0]  branch_type   // CMP_BR branch condition (funct3)
+);
+
+    // Pair kinds
+    localparam logic [1:0] FUSE_NONE   = 2'd0;
+    localparam logic [1:0] FUSE_LI     = 2'd1;
+    localparam logic [1:0] FUSE_CALL   = 2'd2;
+    localparam logic [1:0] FUSE_CMP_BR = 2'd3;
+
+    // Opcode definitions
+    localparam OP_LUI    = 7'b0110111;
+    localparam OP_AUIPC  = 7'b0010111;
+    localparam OP_JALR   = 7'b1100111;
+    localparam OP_BRANCH = 7'b1100011;
+    localparam OP_OPIMM  = 7'b0010011;
+    localparam OP_OP     = 7'b0110011;
+
+    // ALU operation codes (match alu.sv)
+    localparam ALU_ADD  = 5'b00000;
+    localparam ALU_SLT  = 5'b00101;
+    localparam ALU_SLTU = 5'b00110;
+
+    // Fields of both instructions
+    logic [6:0]  op1, op2;
+    logic [4:0]  rd1, rs1_1, rs2_1;
+    logic [4:0]  rd2, rs1_2, rs2_2;
+    logic [2:0]  f3_1, f3_2;
+    logic [31:0] u_imm1;   // first's U-type immediate
+    logic [31:0] i_imm2;   // second's I-type immediate
+    logic [31:0] b_imm2;   // second's B-type immediate
+
+    assign op1    = first[6:0];
+    assign rd1    = first[11:7];
+    assign f3_1   = first[14:12];
+    assign rs1_1  = first[19:15];
+    assign rs2_1  = first[24:20];
+    assign op2    = second[6:0];
+    assign rd2    = second[11:7];
+    assign f3_2   = second[14:12];
+    assign rs1_2  = second[19:15];
+    assign rs2_2  = second[24:20];
+    assign u_imm1 = {first[31:12], 12'd0};
+    assign i_imm2 = {{20{second[31]}}, second[31:20]};
+    assign b_imm2 = {{20{second[31]}}, second[7], second[30:25], second[11:8], 1'b0};
+
+    // Pair detection
+    logic is_li, is_call, is_cmp_br;
+    logic cmp_unsigned;   // SLTU rather than SLT
+    logic br_on_set;      // BNE: taken when the compare is true
+
+    assign is_li     = (op1 == OP_LUI) && (op2 == OP_OPIMM) && (f3_2 == 3'b000) &&
+                       (rd1 != 5'd0) && (rd2 == rd1) && (rs1_2 == rd1);
+    assign is_call   = (op1 == OP_AUIPC) && (op2 == OP_JALR) && (f3_2 == 3'b000) &&
+                       (rd1 != 5'd0) && (rd2 == rd1) && (rs1_2 == rd1);
+    assign is_cmp_br = (op1 == OP_OP) && (f3_1 == 3'b010 || f3_1 == 3'b011) &&
+                       (first[31:25] == 7'd0) && (rd1 != 5'd0) &&
+                       (op2 == OP_BRANCH) && (f3_2 == 3'b000 || f3_2 == 3'b001) &&
+                       ((rs1_2 == rd1 && rs2_2 == 5'd0) || (rs1_2 == 5'd0 && rs2_2 == rd1));
+
+    assign cmp_unsigned = f3_1[0];
+    assign br_on_set    = f3_2[0];
+
+    always_comb begin
+        fuse        = 1'b0;
+        kind        = FUSE_NONE;
+        rs1         = 5'd0;
+        rs2         = 5'd0;
+        rd          = rd1;
+        imm         = 32'd0;
+        alu_op      = ALU_ADD;
+        alu_src     = 1'b1;
+        branch_type = 3'b000;
+
+        if (is_li) begin
+            fuse = 1'b1;
+            kind = FUSE_LI;
+            imm  = u_imm1 + i_imm2;
+        end else if (is_call) begin
+            fuse = 1'b1;
+            kind = FUSE_CALL;
+            imm  = first_pc + u_imm1 + i_imm2;
+        end else if (is_cmp_br) begin
+            fuse        = 1'b1;
+            kind        = FUSE_CMP_BR;
+            rs1         = rs1_1;
+            rs2         = rs2_1;
+            imm         = b_imm2;
+            alu_op      = cmp_unsigned ? ALU_SLTU : ALU_SLT;
+            alu_src     = 1'b0;
+            // BLT/BGE = 100/101, BLTU/BGEU = 110/111
+            branch_type = {1'b1, cmp_unsigned, !br_on_set};
+        end
+    end
+
+endmodule
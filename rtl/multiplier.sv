@@ -0,0 +1,120 @@
+// multiplier.sv - Pipelined 32x32 multiplier for the M extension
+//
+// Three stages, one new multiply per cycle:
+//   1. Four 17x17 partial products of the sign/zero-extended operands
+//   2. The two middle products are added
+//   3. Everything is summed into the 64-bit product and the half the op
+//      asks for goes into the result register
+// A multiply started in cycle t has its result out (done) in cycle t+3.
+//
+// Ops (funct3[1:0]): 00 MUL (low word), 01 MULH (signed x signed),
+// 10 MULHSU (signed x unsigned), 11 MULHU (unsigned x unsigned).
+//
+// Each op carries a tag for the caller (destination, ROB index). The two
+// stages before the result are visible so the caller can announce a
+// result a cycle early, or drop ops that turned out to be wrong-path.
+
+module multiplier #(
+    parameter TAG_BITS = 1
+) (
+    input  logic                clk,
+    input  logic                rst,
+    input  logic                flush,      // Drop everything in flight
+
+    // Start a multiply
+    input  logic                start,
+    input  logic [1:0]          op,
+    input  logic [31:0]         a,
+    input  logic [31:0]         b,
+    input  logic [TAG_BITS-1:0] tag,
+
+    // Stages 1 and 2: ops still in flight. A killed op doesn't move on.
+    output logic [1:0]               stage_valid,
+    output logic [1:0][TAG_BITS-1:0] stage_tag,
+    input  logic [1:0]               stage_kill,
+
+    // Stage 3: the result
+    output logic                done,
+    output logic [31:0]         result,
+    output logic [TAG_BITS-1:0] done_tag
+);
+
+    localparam logic [1:0] OP_MUL    = 2'b00;
+    localparam logic [1:0] OP_MULH   = 2'b01;
+    localparam logic [1:0] OP_MULHSU = 2'b10;
+
+    // Operands as 33-bit signed numbers, split into a signed high half and
+    // an unsigned low half
+    logic               a_signed, b_signed;
+    logic signed [16:0] a_hi, a_lo, b_hi, b_lo;
+
+    assign a_signed = (op == OP_MULH) || (op == OP_MULHSU);
+    assign b_signed = (op == OP_MULH);
+    assign a_hi     = $signed({a_signed & a[31], a[31:16]});
+    assign a_lo     = $signed({1'b0, a[15:0]});
+    assign b_hi     = $signed({b_signed & b[31], b[31:16]});
+    assign b_lo     = $signed({1'b0, b[15:0]});
+
+    // Stage 1: partial products
+    logic               s1_valid;
+    logic [1:0]         s1_op;
+    logic [TAG_BITS-1:0] s1_tag;
+    logic signed [33:0] s1_ll, s1_lh, s1_hl, s1_hh;
+
+    // Stage 2: middle products added
+    logic               s2_valid;
+    logic [1:0]         s2_op;
+    logic [TAG_BITS-1:0] s2_tag;
+    logic signed [33:0] s2_ll, s2_hh;
+    logic signed [34:0] s2_mid;
+
+    // Stage 3: full product, sign-extended pieces added at their weights
+    logic [65:0] product;
+    assign product = {s2_hh, 32'd0} +
+                     {{15{s2_mid[34]}}, s2_mid, 16'd0} +
+                     {{32{s2_ll[33]}}, s2_ll};
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst || flush) begin
+            s1_valid <= 1'b0;
+            s1_op    <= OP_MUL;
+            s1_tag   <= '0;
+            s1_ll    <= '0;
+            s1_lh    <= '0;
+            s1_hl    <= '0;
+            s1_hh    <= '0;
+            s2_valid <= 1'b0;
+            s2_op    <= OP_MUL;
+            s2_tag   <= '0;
+            s2_ll    <= '0;
+            s2_hh    <= '0;
+            s2_mid   <= '0;
+            done     <= 1'b0;
+            result   <= 32'd0;
+            done_tag <= '0;
+        end else begin
+            s1_valid <= start;
+            s1_op    <= op;
+            s1_tag   <= tag;
+            s1_ll    <= a_lo * b_lo;
+            s1_lh    <= a_lo * b_hi;
+            s1_hl    <= a_hi * b_lo;
+            s1_hh    <= a_hi * b_hi;
+
+            s2_valid <= s1_valid && !stage_kill[0];
+            s2_op    <= s1_op;
+            s2_tag   <= s1_tag;
+            s2_ll    <= s1_ll;
+            s2_hh    <= s1_hh;
+            s2_mid   <= s1_lh + s1_hl;
+
+            done     <= s2_valid && !stage_kill[1];
+            result   <= (s2_op == OP_MUL) ? product[31:0] : product[63:32];
+            done_tag <= s2_tag;
+        end
+    end
+
+    assign stage_valid = {s2_valid, s1_valid};
+    assign stage_tag   = {s2_tag, s1_tag};
+
+endmodule
@@ -0,0 +1,107 @@
+// perf_counters.sv - Zicntr/Zihpm performance counters, read with csrr
+//
+// 64-bit counters for cycles, retired instructions and NUM_HPM hardware
+// events, readable from programs through the counter CSRs:
+//
+//   0xC00 cycle     0xC01 time (= cycle)   0xC02 instret
+//   0xC03-0xC1F     hpmcounter3-31
+//   0xC80-0xC9F     upper halves of the above (cycleh, instreth, ...)
+//   0xB00-0xB1F, 0xB80-0xB9F   the machine-mode names for the same counters
+//   0x323-0x33F     mhpmevent3-31: the event each hpmcounter counts
+//
+// Counters past hpmcounter(2 + NUM_HPM) and unknown CSRs read as zero.
+// The counters are read-only: there's no privileged mode to write them
+// from, so which event each hpmcounter counts is chosen per build with
+// HPM_EVENTS, a nibble per counter (hpmcounter3 in the low nibble).
+//
+// Events (a core that lacks the structure ties its event low):
+//   1 I-cache hit      2 I-cache miss     3 D-cache hit     4 D-cache miss
+//   5 branch/jump mispredicted            6 load-use stall cycle
+//   7 dispatch blocked by a full issue queue
+//   8 dispatch blocked by a full reorder buffer
+//   0 counts nothing
+//
+// A csrr reads instret as of its own place in program order: the core
+// passes in how many older instructions are still in flight
+// (instret_pending), since those haven't been counted yet.
+
+module perf_counters #(
+    parameter NUM_PORTS    = 1,              // CSR read ports
+    parameter RETIRE_BITS  = 2,              // Width of the per-cycle retire count
+    parameter PENDING_BITS = 8,              // Width of instret_pending
+    parameter [31:0] HPM_EVENTS = 32'h87654321
+) (
+    input  logic                  clk,
+    input  logic                  rst,
+
+    input  logic [RETIRE_BITS-1:0] retired,  // Instructions retired this cycle
+    input  logic [7:0]             events,   // Bit e-1 = event e happened this cycle
+
+    // Read ports
+    input  logic [NUM_PORTS-1:0][11:0]             csr_addr,
+    input  logic [NUM_PORTS-1:0][PENDING_BITS-1:0] instret_pending,
+    output logic [NUM_PORTS-1:0][31:0]             csr_rdata
+);
+
+    localparam NUM_HPM = 8;  // hpmcounter3-10
+
+    // Counter storage
+    logic [63:0] cycle;
+    logic [63:0] instret;
+    logic [63:0] hpm       [0:NUM_HPM-1];
+    logic [3:0]  hpm_event [0:NUM_HPM-1];
+
+    always_comb begin
+        for (int i = 0; i < NUM_HPM; i++)
+            hpm_event[i] = HPM_EVENTS[4*i +: 4];
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            cycle   <= 64'd0;
+            instret <= 64'd0;
+            for (int i = 0; i < NUM_HPM; i++)
+                hpm[i] <= 64'd0;
+        end else begin
+            cycle   <= cycle + 1;
+            instret <= instret + retired;
+            for (int i = 0; i < NUM_HPM; i++) begin
+                if (hpm_event[i] != 4'd0 && hpm_event[i] <= 4'd8 && events[hpm_event[i] - 1])
+                    hpm[i] <= hpm[i] + 1;
+            end
+        end
+    end
+
+    // CSR reads
+    logic [63:0] value    [0:NUM_PORTS-1];   // Counter named by the low 5 bits
+    logic [4:0]  index    [0:NUM_PORTS-1];
+
+    always_comb begin
+        for (int p = 0; p < NUM_PORTS; p++) begin
+            index[p] = csr_addr[p][4:0];
+
+            case (index[p])
+                5'd0, 5'd1: value[p] = cycle;
+                5'd2:       value[p] = instret + instret_pending[p];
+                default:    value[p] = (index[p] < 3 + NUM_HPM) ? hpm[index[p] - 3] : 64'd0;
+            endcase
+
+            case (csr_addr[p][11:5])
+                7'b1100000, 7'b1011000:  // cycle..hpmcounter31, mcycle..mhpmcounter31
+                    csr_rdata[p] = value[p][31:0];
+                7'b1100100, 7'b1011100:  // The upper halves
+                    csr_rdata[p] = value[p][63:32];
+                7'b0011001:              // mhpmevent3-31
+                    csr_rdata[p] = (index[p] >= 3 && index[p] < 3 + NUM_HPM) ?
+                                   {28'd0, hpm_event[index[p] - 3]} : 32'd0;
+                default:
+                    csr_rdata[p] = 32'd0;
+            endcase
+
+            // time has no machine-mode counterpart
+            if (csr_addr[p][11:8] == 4'hB && index[p] == 5'd1)
+                csr_rdata[p] = 32'd0;
+        end
+    end
+
+endmodule
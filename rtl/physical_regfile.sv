@@ -1,38 +1,46 @@
 // physical_regfile.sv - Physical Register File for OoO CPU
 // 64 physical registers (more than 32 architectural to allow renaming)
+//
+// One pair of read ports per execution port (NUM_PORTS) and one write
+// port per complete port (NUM_WRITE_PORTS: the execution ports plus the
+// multiply/divide unit), so every port reads its operands and writes its
+// result in the same cycle as the others. Writers never collide: each
+// physical register has exactly one producer in flight.
+//
+// Reads return the registers as of the start of the cycle. A result being
+// written this cycle reaches its consumers over the CPU's bypass network.
 
 module physical_regfile #(
     parameter NUM_PHYS_REGS = 64,
-    parameter PHYS_REG_BITS = 6    // log2(64)
+    parameter PHYS_REG_BITS = 6,   // log2(64)
+    parameter NUM_PORTS     = 1,
+    parameter NUM_WRITE_PORTS = NUM_PORTS
 ) (
     input  logic        clk,
     input  logic        rst,
 
-    // Read port 1
-    input  logic [PHYS_REG_BITS-1:0] read_addr1,
-    output logic [31:0]              read_data1,
+    // Read ports 1 and 2 of each execution port
+    input  logic [NUM_PORTS-1:0][PHYS_REG_BITS-1:0] read_addr1,
+    output logic [NUM_PORTS-1:0][31:0]              read_data1,
+    input  logic [NUM_PORTS-1:0][PHYS_REG_BITS-1:0] read_addr2,
+    output logic [NUM_PORTS-1:0][31:0]              read_data2,
 
-    // Read port 2
-    input  logic [PHYS_REG_BITS-1:0] read_addr2,
-    output logic [31:0]              read_data2,
-
-    // Write port (from completing instructions)
-    input  logic                     write_en,
-    input  logic [PHYS_REG_BITS-1:0] write_addr,
-    input  logic [31:0]              write_data
+    // Write ports (from completing instructions)
+    input  logic [NUM_WRITE_PORTS-1:0]                    write_en,
+    input  logic [NUM_WRITE_PORTS-1:0][PHYS_REG_BITS-1:0] write_addr,
+    input  logic [NUM_WRITE_PORTS-1:0][31:0]              write_data
 );
 
     // Physical register storage
     logic [31:0] regs [0:NUM_PHYS_REGS-1];
 
-    // Combinational reads with write-through
-    assign read_data1 = (read_addr1 == 0) ? 32'd0 :
-                        (write_en && write_addr == read_addr1) ? write_data :
-                        regs[read_addr1];
-
-    assign read_data2 = (read_addr2 == 0) ? 32'd0 :
-                        (write_en && write_addr == read_addr2) ? write_data :
-                        regs[read_addr2];
+    // Combinational reads
+    always_comb begin
+        for (int r = 0; r < NUM_PORTS; r++) begin
+            read_data1[r] = (read_addr1[r] == 0) ? 32'd0 : regs[read_addr1[r]];
+            read_data2[r] = (read_addr2[r] == 0) ? 32'd0 : regs[read_addr2[r]];
+        end
+    end
 
     // Synchronous write
     always_ff @(posedge clk or posedge rst) begin
@@ -41,8 +49,11 @@ module physical_regfile #(
             for (i = 0; i < NUM_PHYS_REGS; i++) begin
                 regs[i] <= 32'd0;
             end
-        end else if (write_en && write_addr != 0) begin
-            regs[write_addr] <= write_data;
+        end else begin
+            for (int w = 0; w < NUM_WRITE_PORTS; w++) begin
+                if (write_en[w] && write_addr[w] != 0)
+                    regs[write_addr[w]] <= write_data[w];
+            end
         end
     end
 
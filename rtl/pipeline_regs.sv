@@ -1,46 +1,6 @@
 // pipeline_regs.sv - Pipeline registers between stages
-// IF/ID, ID/EX, EX/MEM, MEM/WB
-
-// ============================================================
-// IF/ID Pipeline Register
-// Holds: instruction, PC, branch prediction info
-// ============================================================
-module pipe_if_id (
-    input  logic        clk,
-    input  logic        rst,
-    input  logic        flush,          // Clear on branch misprediction
-    input  logic        stall,          // Hold values (for hazards)
-
-    // Inputs from IF stage
-    input  logic [31:0] if_pc,
-    input  logic [31:0] if_instruction,
-    input  logic        if_predict_taken,  // Branch prediction
-    input  logic [31:0] if_predict_target, // Predicted target
-
-    // Outputs to ID stage
-    output logic [31:0] id_pc,
-    output logic [31:0] id_instruction,
-    output logic        id_predict_taken,
-    output logic [31:0] id_predict_target
-);
-
-    always_ff @(posedge clk or posedge rst) begin
-        if (rst || flush) begin
-            id_pc             <= 32'd0;
-            id_instruction    <= 32'h00000013;  // NOP
-            id_predict_taken  <= 1'b0;
-            id_predict_target <= 32'd0;
-        end else if (!stall) begin
-            id_pc             <= if_pc;
-            id_instruction    <= if_instruction;
-            id_predict_taken  <= if_predict_taken;
-            id_predict_target <= if_predict_target;
-        end
-        // If stall, keep current values
-    end
-
-endmodule
-
+// ID/EX, EX/MEM, MEM/WB
+// (IF -> ID goes through the instruction buffer, see fetch_queue.sv)
 
 // ============================================================
 // ID/EX Pipeline Register
@@ -52,6 +12,11 @@ module pipe_id_ex (
     input  logic        flush,
     input  logic        stall,          // Hold values (for cache misses)
 
+    // While held, the operands are refreshed with their forwarded values:
+    // WB keeps draining, so a value forwarded from WB would otherwise be lost
+    input  logic [31:0] ex_fwd_data1,
+    input  logic [31:0] ex_fwd_data2,
+
     // Inputs from ID stage
     input  logic [31:0] id_pc,
     input  logic [31:0] id_read_data1,
@@ -62,9 +27,12 @@ module pipe_id_ex (
     input  logic [4:0]  id_rd,
     input  logic        id_predict_taken,
     input  logic [31:0] id_predict_target,
+    input  logic [31:0] id_bp_history,
+    input  logic [3:0]  id_ras_ptr,
+    input  logic [31:0] id_ras_top,
 
     // Control signals from ID stage
-    input  logic [3:0]  id_alu_op,
+    input  logic [4:0]  id_alu_op,
     input  logic        id_alu_src,
     input  logic        id_reg_write,
     input  logic        id_mem_read,
@@ -73,6 +41,12 @@ module pipe_id_ex (
     input  logic        id_branch,
     input  logic [2:0]  id_branch_type,
     input  logic        id_jump,
+    input  logic [1:0]  id_cf_type,
+    input  logic        id_muldiv,
+    input  logic [2:0]  id_muldiv_op,
+    input  logic        id_rvc,         // Compressed: next instruction at PC + 2
+    input  logic        id_csr,         // Counter CSR read
+    input  logic [1:0]  id_insts,       // Instructions carried: 0 bubble, 2 fused pair
 
     // Outputs to EX stage
     output logic [31:0] ex_pc,
@@ -84,9 +58,12 @@ module pipe_id_ex (
     output logic [4:0]  ex_rd,
     output logic        ex_predict_taken,
     output logic [31:0] ex_predict_target,
+    output logic [31:0] ex_bp_history,
+    output logic [3:0]  ex_ras_ptr,
+    output logic [31:0] ex_ras_top,
 
     // Control signals to EX stage
-    output logic [3:0]  ex_alu_op,
+    output logic [4:0]  ex_alu_op,
     output logic        ex_alu_src,
     output logic        ex_reg_write,
     output logic        ex_mem_read,
@@ -94,7 +71,13 @@ module pipe_id_ex (
     output logic        ex_mem_to_reg,
     output logic        ex_branch,
     output logic [2:0]  ex_branch_type,
-    output logic        ex_jump
+    output logic        ex_jump,
+    output logic [1:0]  ex_cf_type,
+    output logic        ex_muldiv,
+    output logic [2:0]  ex_muldiv_op,
+    output logic        ex_rvc,
+    output logic        ex_csr,
+    output logic [1:0]  ex_insts
 );
 
     always_ff @(posedge clk or posedge rst) begin
@@ -108,7 +91,10 @@ module pipe_id_ex (
             ex_rd             <= 5'd0;
             ex_predict_taken  <= 1'b0;
             ex_predict_target <= 32'd0;
-            ex_alu_op         <= 4'd0;
+            ex_bp_history     <= 32'd0;
+            ex_ras_ptr        <= 4'd0;
+            ex_ras_top        <= 32'd0;
+            ex_alu_op         <= 5'd0;
             ex_alu_src        <= 1'b0;
             ex_reg_write      <= 1'b0;
             ex_mem_read       <= 1'b0;
@@ -117,6 +103,12 @@ module pipe_id_ex (
             ex_branch         <= 1'b0;
             ex_branch_type    <= 3'd0;
             ex_jump           <= 1'b0;
+            ex_cf_type        <= 2'b00;
+            ex_muldiv         <= 1'b0;
+            ex_muldiv_op      <= 3'd0;
+            ex_rvc            <= 1'b0;
+            ex_csr            <= 1'b0;
+            ex_insts          <= 2'd0;
         end else if (!stall) begin
             ex_pc             <= id_pc;
             ex_read_data1     <= id_read_data1;
@@ -127,6 +119,9 @@ module pipe_id_ex (
             ex_rd             <= id_rd;
             ex_predict_taken  <= id_predict_taken;
             ex_predict_target <= id_predict_target;
+            ex_bp_history     <= id_bp_history;
+            ex_ras_ptr        <= id_ras_ptr;
+            ex_ras_top        <= id_ras_top;
             ex_alu_op         <= id_alu_op;
             ex_alu_src        <= id_alu_src;
             ex_reg_write      <= id_reg_write;
@@ -136,6 +131,15 @@ module pipe_id_ex (
             ex_branch         <= id_branch;
             ex_branch_type    <= id_branch_type;
             ex_jump           <= id_jump;
+            ex_cf_type        <= id_cf_type;
+            ex_muldiv         <= id_muldiv;
+            ex_muldiv_op      <= id_muldiv_op;
+            ex_rvc            <= id_rvc;
+            ex_csr            <= id_csr;
+            ex_insts          <= id_insts;
+        end else begin
+            ex_read_data1     <= ex_fwd_data1;
+            ex_read_data2     <= ex_fwd_data2;
         end
     end
 
@@ -144,12 +148,13 @@ endmodule
 
 // ============================================================
 // EX/MEM Pipeline Register
-// Holds: ALU result, data for store, control signals, prediction
+// Holds: ALU result, data for store, control signals
+// (branches have already resolved in EX, so nothing about them goes on)
 // ============================================================
 module pipe_ex_mem (
     input  logic        clk,
     input  logic        rst,
-    input  logic        flush,          // Flush on misprediction
+    input  logic        flush,          // Bubble while EX waits on the multiply/divide unit
     input  logic        stall,          // Hold values (for cache misses)
 
     // Inputs from EX stage
@@ -158,18 +163,14 @@ module pipe_ex_mem (
     input  logic [31:0] ex_alu_result,
     input  logic [31:0] ex_read_data2,
     input  logic [4:0]  ex_rd,
-    input  logic        ex_zero,
-    input  logic [31:0] ex_branch_target,
-    input  logic        ex_predict_taken,
 
     // Control signals from EX stage
     input  logic        ex_reg_write,
     input  logic        ex_mem_read,
     input  logic        ex_mem_write,
     input  logic        ex_mem_to_reg,
-    input  logic        ex_branch,
-    input  logic [2:0]  ex_branch_type,
     input  logic        ex_jump,
+    input  logic [1:0]  ex_insts,       // Instructions carried (for instret)
 
     // Outputs to MEM stage
     output logic [31:0] mem_pc,
@@ -177,18 +178,14 @@ module pipe_ex_mem (
     output logic [31:0] mem_alu_result,
     output logic [31:0] mem_read_data2,
     output logic [4:0]  mem_rd,
-    output logic        mem_zero,
-    output logic [31:0] mem_branch_target,
-    output logic        mem_predict_taken,
 
     // Control signals to MEM stage
     output logic        mem_reg_write,
     output logic        mem_mem_read,
     output logic        mem_mem_write,
     output logic        mem_mem_to_reg,
-    output logic        mem_branch,
-    output logic [2:0]  mem_branch_type,
-    output logic        mem_jump
+    output logic        mem_jump,
+    output logic [1:0]  mem_insts
 );
 
     always_ff @(posedge clk or posedge rst) begin
@@ -198,32 +195,24 @@ module pipe_ex_mem (
             mem_alu_result    <= 32'd0;
             mem_read_data2    <= 32'd0;
             mem_rd            <= 5'd0;
-            mem_zero          <= 1'b0;
-            mem_branch_target <= 32'd0;
-            mem_predict_taken <= 1'b0;
             mem_reg_write     <= 1'b0;
             mem_mem_read      <= 1'b0;
             mem_mem_write     <= 1'b0;
             mem_mem_to_reg    <= 1'b0;
-            mem_branch        <= 1'b0;
-            mem_branch_type   <= 3'd0;
             mem_jump          <= 1'b0;
+            mem_insts         <= 2'd0;
         end else if (!stall) begin
             mem_pc            <= ex_pc;
             mem_pc_plus4      <= ex_pc_plus4;
             mem_alu_result    <= ex_alu_result;
             mem_read_data2    <= ex_read_data2;
             mem_rd            <= ex_rd;
-            mem_zero          <= ex_zero;
-            mem_branch_target <= ex_branch_target;
-            mem_predict_taken <= ex_predict_taken;
             mem_reg_write     <= ex_reg_write;
             mem_mem_read      <= ex_mem_read;
             mem_mem_write     <= ex_mem_write;
             mem_mem_to_reg    <= ex_mem_to_reg;
-            mem_branch        <= ex_branch;
-            mem_branch_type   <= ex_branch_type;
             mem_jump          <= ex_jump;
+            mem_insts         <= ex_insts;
         end
     end
 
@@ -237,7 +226,7 @@ endmodule
 module pipe_mem_wb (
     input  logic        clk,
     input  logic        rst,
-    input  logic        stall,          // Hold values (for cache misses)
+    input  logic        flush,          // Bubble while MEM waits on the D-cache
 
     // Inputs from MEM stage
     input  logic [31:0] mem_pc_plus4,
@@ -249,6 +238,7 @@ module pipe_mem_wb (
     input  logic        mem_reg_write,
     input  logic        mem_mem_to_reg,
     input  logic        mem_jump,
+    input  logic [1:0]  mem_insts,
 
     // Outputs to WB stage
     output logic [31:0] wb_pc_plus4,
@@ -259,11 +249,12 @@ module pipe_mem_wb (
     // Control signals to WB stage
     output logic        wb_reg_write,
     output logic        wb_mem_to_reg,
-    output logic        wb_jump
+    output logic        wb_jump,
+    output logic [1:0]  wb_insts        // Instructions retiring this cycle
 );
 
     always_ff @(posedge clk or posedge rst) begin
-        if (rst) begin
+        if (rst || flush) begin
             wb_pc_plus4    <= 32'd0;
             wb_alu_result  <= 32'd0;
             wb_read_data   <= 32'd0;
@@ -271,7 +262,8 @@ module pipe_mem_wb (
             wb_reg_write   <= 1'b0;
             wb_mem_to_reg  <= 1'b0;
             wb_jump        <= 1'b0;
-        end else if (!stall) begin
+            wb_insts       <= 2'd0;
+        end else begin
             wb_pc_plus4    <= mem_pc_plus4;
             wb_alu_result  <= mem_alu_result;
             wb_read_data   <= mem_read_data;
@@ -279,6 +271,7 @@ module pipe_mem_wb (
             wb_reg_write   <= mem_reg_write;
             wb_mem_to_reg  <= mem_mem_to_reg;
             wb_jump        <= mem_jump;
+            wb_insts       <= mem_insts;
         end
     end
 
@@ -1,30 +1,60 @@
 // rat.sv - Register Alias Table
 // Maps architectural registers (x0-x31) to physical registers
 // Maintains speculative and committed mappings
+//
+// Branch checkpoints: when a branch is renamed, the whole speculative
+// table (including that instruction's own mapping) is copied into one of
+// NUM_CKPTS snapshot slots. A misprediction copies its slot back in a
+// single cycle, undoing every rename younger than the branch.
+//
+// Rename groups: up to WIDTH instructions are renamed per cycle, slot 0
+// being the oldest. A slot's sources and old mapping come from the
+// youngest older slot in the group that writes the same register, and
+// only then from the table (intra-group dependency check). A slot never
+// sees its own destination: "addi x1, x1, 1" reads the previous x1.
+//
+// A renamed register doesn't have to be a new one: an eliminated move maps
+// rd to its source's physical register, so several architectural
+// registers can share one. The free list counts the sharers.
+//
+// Up to RETIRE_WIDTH instructions update the committed table per cycle,
+// in retire order, so a younger write to the same register wins.
 
 module rat #(
-    parameter PHYS_REG_BITS = 6
+    parameter PHYS_REG_BITS = 6,
+    parameter WIDTH         = 1,   // Renames per cycle
+    parameter RETIRE_WIDTH  = 1,   // Commits per cycle
+    parameter NUM_CKPTS     = 4,
+    parameter CKPT_BITS     = 2    // log2(NUM_CKPTS)
 ) (
     input  logic        clk,
     input  logic        rst,
     input  logic        flush,   // Restore speculative RAT from committed RAT
 
-    // Lookup: read current mapping for source registers
-    input  logic [4:0]  rs1,
-    input  logic [4:0]  rs2,
-    output logic [PHYS_REG_BITS-1:0] phys_rs1,
-    output logic [PHYS_REG_BITS-1:0] phys_rs2,
-
-    // Rename: update mapping for destination register
-    input  logic        rename_en,
-    input  logic [4:0]  rename_rd,
-    input  logic [PHYS_REG_BITS-1:0] rename_phys_rd,  // New physical reg
-    output logic [PHYS_REG_BITS-1:0] rename_old_phys,  // Old mapping (for freeing on commit)
-
-    // Commit: update committed RAT
-    input  logic        commit_en,
-    input  logic [4:0]  commit_rd,
-    input  logic [PHYS_REG_BITS-1:0] commit_phys_rd
+    // Lookup: read current mapping for source registers, one pair per slot
+    input  logic [WIDTH-1:0][4:0]               rs1,
+    input  logic [WIDTH-1:0][4:0]               rs2,
+    output logic [WIDTH-1:0][PHYS_REG_BITS-1:0] phys_rs1,
+    output logic [WIDTH-1:0][PHYS_REG_BITS-1:0] phys_rs2,
+
+    // Rename: update mapping for destination register, one per slot
+    input  logic [WIDTH-1:0]                    rename_en,
+    input  logic [WIDTH-1:0][4:0]               rename_rd,
+    input  logic [WIDTH-1:0][PHYS_REG_BITS-1:0] rename_phys_rd,  // New (or shared) physical reg
+    output logic [WIDTH-1:0][PHYS_REG_BITS-1:0] rename_old_phys, // Old mapping (for freeing on commit)
+
+    // Checkpoint: snapshot the speculative RAT (after this cycle's renames)
+    input  logic                 ckpt_en,
+    input  logic [CKPT_BITS-1:0] ckpt_id,
+
+    // Restore: roll the speculative RAT back to a snapshot (misprediction)
+    input  logic                 restore_en,
+    input  logic [CKPT_BITS-1:0] restore_id,
+
+    // Commit: update committed RAT, one per retire slot
+    input  logic [RETIRE_WIDTH-1:0]                    commit_en,
+    input  logic [RETIRE_WIDTH-1:0][4:0]               commit_rd,
+    input  logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] commit_phys_rd
 );
 
     // Speculative RAT (updated during rename)
@@ -33,17 +63,34 @@ module rat #(
     // Committed RAT (updated during commit, used for recovery)
     logic [PHYS_REG_BITS-1:0] comm_rat [0:31];
 
-    // Combinational lookup (with bypass for same-cycle rename)
-    assign phys_rs1 = (rs1 == 5'd0) ? {PHYS_REG_BITS{1'b0}} :
-                      (rename_en && rename_rd == rs1 && rename_rd != 5'd0) ? rename_phys_rd :
-                      spec_rat[rs1];
+    // Snapshots, one 32-entry table per checkpoint: index = {ckpt_id, arch reg}
+    logic [PHYS_REG_BITS-1:0] ckpt_rat [0:NUM_CKPTS*32-1];
+
+    // Combinational lookup, bypassing renames from older slots in the group
+    always_comb begin
+        for (int k = 0; k < WIDTH; k++) begin
+            phys_rs1[k]        = spec_rat[rs1[k]];
+            phys_rs2[k]        = spec_rat[rs2[k]];
+            rename_old_phys[k] = spec_rat[rename_rd[k]];
 
-    assign phys_rs2 = (rs2 == 5'd0) ? {PHYS_REG_BITS{1'b0}} :
-                      (rename_en && rename_rd == rs2 && rename_rd != 5'd0) ? rename_phys_rd :
-                      spec_rat[rs2];
+            // Later (younger) matches override earlier ones
+            for (int j = 0; j < k; j++) begin
+                if (rename_en[j] && rename_rd[j] != 5'd0) begin
+                    if (rename_rd[j] == rs1[k])
+                        phys_rs1[k] = rename_phys_rd[j];
+                    if (rename_rd[j] == rs2[k])
+                        phys_rs2[k] = rename_phys_rd[j];
+                    if (rename_rd[j] == rename_rd[k])
+                        rename_old_phys[k] = rename_phys_rd[j];
+                end
+            end
 
-    // Old physical register for the destination (will be freed on commit)
-    assign rename_old_phys = spec_rat[rename_rd];
+            if (rs1[k] == 5'd0)
+                phys_rs1[k] = {PHYS_REG_BITS{1'b0}};
+            if (rs2[k] == 5'd0)
+                phys_rs2[k] = {PHYS_REG_BITS{1'b0}};
+        end
+    end
 
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
@@ -60,14 +107,37 @@ module rat #(
                 spec_rat[i] <= comm_rat[i];
             end
         end else begin
-            // Update speculative RAT on rename
-            if (rename_en && rename_rd != 5'd0) begin
-                spec_rat[rename_rd] <= rename_phys_rd;
+            integer i;
+
+            if (restore_en) begin
+                // Misprediction: everything renamed after the branch is undone
+                for (i = 0; i < 32; i++) begin
+                    spec_rat[i] <= ckpt_rat[{restore_id, i[4:0]}];
+                end
+            end else begin
+                // Update speculative RAT on rename (younger slots win)
+                for (int k = 0; k < WIDTH; k++) begin
+                    if (rename_en[k] && rename_rd[k] != 5'd0)
+                        spec_rat[rename_rd[k]] <= rename_phys_rd[k];
+                end
+            end
+
+            // Snapshot, including the group's renames (a branch is always
+            // the last slot of its group, and JALR writes rd)
+            if (ckpt_en) begin
+                for (i = 0; i < 32; i++) begin
+                    ckpt_rat[{ckpt_id, i[4:0]}] <= spec_rat[i];
+                    for (int k = 0; k < WIDTH; k++) begin
+                        if (rename_en[k] && rename_rd[k] == i[4:0] && rename_rd[k] != 5'd0)
+                            ckpt_rat[{ckpt_id, i[4:0]}] <= rename_phys_rd[k];
+                    end
+                end
             end
 
-            // Update committed RAT on commit
-            if (commit_en && commit_rd != 5'd0) begin
-                comm_rat[commit_rd] <= commit_phys_rd;
+            // Update committed RAT on commit (younger slots win)
+            for (int r = 0; r < RETIRE_WIDTH; r++) begin
+                if (commit_en[r] && commit_rd[r] != 5'd0)
+                    comm_rat[commit_rd[r]] <= commit_phys_rd[r];
             end
         end
     end
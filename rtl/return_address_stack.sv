@@ -0,0 +1,89 @@
+// return_address_stack.sv - Predicts function return addresses
+//
+// A return (jalr x0, 0(ra)) jumps to a different place depending on who
+// called the function, so the BTB's single target per PC keeps missing.
+// Calls and returns nest, so a small stack predicts them almost perfectly:
+// - Call   (jal/jalr with rd = ra): push the return address (PC + 4)
+// - Return (jalr with rs1 = ra, rd = x0): pop, predict the popped address
+//
+// The stack is circular: overflow silently overwrites the oldest entry and
+// underflow returns a stale address (which then simply mispredicts).
+//
+// Push/pop happen speculatively in IF, so wrong-path calls and returns
+// corrupt it. Every instruction carries a checkpoint of the stack pointer
+// and top entry from when it was fetched. On a misprediction the CPU hands
+// back the mispredicted instruction's checkpoint: the pointer and top entry
+// are restored, then that instruction's own push/pop is replayed.
+
+module return_address_stack #(
+    parameter DEPTH = 8  // Number of entries (max 16)
+)(
+    input  logic        clk,
+    input  logic        rst,
+
+    // Speculative push/pop (IF stage)
+    input  logic        push_en,        // Call fetched
+    input  logic [31:0] push_addr,      // Return address to push
+    input  logic        pop_en,         // Return fetched
+    output logic [31:0] top_addr,       // Predicted return address
+
+    // Checkpoint of the current state (travels down the pipeline)
+    output logic [3:0]  ckpt_ptr,
+    output logic [31:0] ckpt_top,
+
+    // Repair on misprediction
+    input  logic        repair_en,
+    input  logic [3:0]  repair_ptr,     // Checkpoint of the mispredicted instruction
+    input  logic [31:0] repair_top,
+    input  logic        repair_push,    // Mispredicted instruction was a call
+    input  logic        repair_pop,     // Mispredicted instruction was a return
+    input  logic [31:0] repair_push_addr
+);
+
+    logic [31:0] stack [0:DEPTH-1];
+    logic [3:0]  ptr;  // Index of the top entry
+
+    function automatic logic [3:0] ptr_inc(input logic [3:0] p);
+        ptr_inc = (p == DEPTH - 1) ? 4'd0 : p + 4'd1;
+    endfunction
+
+    function automatic logic [3:0] ptr_dec(input logic [3:0] p);
+        ptr_dec = (p == 4'd0) ? DEPTH - 1 : p - 4'd1;
+    endfunction
+
+    assign top_addr = stack[ptr];
+    assign ckpt_ptr = ptr;
+    assign ckpt_top = stack[ptr];
+
+    initial begin
+        for (int i = 0; i < DEPTH; i++) begin
+            stack[i] = 32'd0;
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            ptr <= 4'd0;
+            for (int i = 0; i < DEPTH; i++) begin
+                stack[i] <= 32'd0;
+            end
+        end else if (repair_en) begin
+            // Restore, then replay the mispredicted instruction's own operation
+            stack[repair_ptr] <= repair_top;
+            if (repair_push) begin
+                stack[ptr_inc(repair_ptr)] <= repair_push_addr;
+                ptr <= ptr_inc(repair_ptr);
+            end else if (repair_pop) begin
+                ptr <= ptr_dec(repair_ptr);
+            end else begin
+                ptr <= repair_ptr;
+            end
+        end else if (push_en) begin
+            stack[ptr_inc(ptr)] <= push_addr;
+            ptr <= ptr_inc(ptr);
+        end else if (pop_en) begin
+            ptr <= ptr_dec(ptr);
+        end
+    end
+
+endmodule
@@ -1,37 +1,88 @@
 // rob.sv - Reorder Buffer
 // Circular queue that maintains program order for in-order commit
 // Tracks instruction status: dispatched → completed → committed
+//
+// A mispredicted branch squashes only the entries younger than itself:
+// the tail moves back to just after the branch, the older entries keep
+// going. Age is distance from the head, so the CPU can compare any two
+// ROB indices against head_idx the same way.
+//
+// Up to WIDTH entries are allocated per cycle, in slot order from the
+// tail. Slots that don't allocate don't use up an index. Each execution
+// port and the multiply/divide unit has its own complete port
+// (COMPLETE_PORTS).
+//
+// Retire: up to RETIRE_WIDTH consecutive done entries from the head are
+// offered each cycle (commit slot r = head + r). The CPU acknowledges a
+// prefix of them; each entry says whether it is a load/store, since the
+// LSQ only commits one of those per cycle.
+//
+// Eliminated moves and zero idioms never execute: they are allocated
+// already done, and say so at commit (they share phys_rd instead of
+// having allocated it).
+//
+// Instruction counts: an entry can stand for more than one instruction -
+// a fused pair, plus any NOPs and other instructions decode dropped just
+// before it. It carries that count to commit for instret, and the counts
+// of everything in flight are summed for csrr (see perf_counters.sv),
+// and those of the entries a squash drops for top-down accounting.
+//
+// Statistics: occupancy summed over cycles (divide by cycles for the
+// average), cycles the ROB was full, and commit stalls - cycles with
+// entries in the ROB but an unfinished head.
 
 module rob #(
     parameter ROB_SIZE     = 16,
     parameter ROB_IDX_BITS = 4,    // log2(16)
-    parameter PHYS_REG_BITS = 6
+    parameter PHYS_REG_BITS = 6,
+    parameter WIDTH        = 1,    // Allocations per cycle
+    parameter COMPLETE_PORTS = 1,  // Complete ports
+    parameter RETIRE_WIDTH = 1     // Commits per cycle
 ) (
     input  logic        clk,
     input  logic        rst,
-    input  logic        flush,     // Clear all entries (misprediction)
-
-    // Allocate: new instruction enters the ROB (during dispatch)
-    input  logic        alloc_en,
-    input  logic [4:0]  alloc_rd,                    // Architectural dest reg
-    input  logic [PHYS_REG_BITS-1:0] alloc_phys_rd,  // Physical dest reg
-    input  logic [PHYS_REG_BITS-1:0] alloc_old_phys, // Old physical mapping (to free)
-    input  logic [31:0] alloc_pc,
-    output logic [ROB_IDX_BITS-1:0]  alloc_idx,      // Assigned ROB index
-    output logic        alloc_ready,                  // ROB has space
-
-    // Complete: mark instruction as done (from execution unit)
-    input  logic        complete_en,
-    input  logic [ROB_IDX_BITS-1:0] complete_idx,
-    input  logic [31:0] complete_result,
-
-    // Commit: retire from head (in program order)
-    output logic        commit_valid,                 // Head is ready to commit
-    output logic [4:0]  commit_rd,
-    output logic [PHYS_REG_BITS-1:0] commit_phys_rd,
-    output logic [PHYS_REG_BITS-1:0] commit_old_phys, // Register to free
-    output logic [31:0] commit_result,
-    input  logic        commit_ack                    // Acknowledge commit
+    input  logic        flush,     // Clear all entries
+
+    // Squash: drop everything younger than squash_idx (branch misprediction)
+    input  logic        squash_en,
+    input  logic [ROB_IDX_BITS-1:0] squash_idx,
+    output logic [ROB_IDX_BITS-1:0] head_idx,       // Oldest entry, for age compares
+    output logic [ROB_IDX_BITS+3:0] squash_insts,   // Instructions the squash drops
+
+    // Allocate: new instructions enter the ROB (during dispatch), one per slot
+    input  logic [WIDTH-1:0]                    alloc_en,
+    input  logic [WIDTH-1:0][4:0]               alloc_rd,       // Architectural dest reg
+    input  logic [WIDTH-1:0][PHYS_REG_BITS-1:0] alloc_phys_rd,  // Physical dest reg
+    input  logic [WIDTH-1:0][PHYS_REG_BITS-1:0] alloc_old_phys, // Old physical mapping (to free)
+    input  logic [WIDTH-1:0][31:0]              alloc_pc,
+    input  logic [WIDTH-1:0]                    alloc_mem,      // Load or store
+    input  logic [WIDTH-1:0]                    alloc_elim,     // Eliminated: done already
+    input  logic [WIDTH-1:0][3:0]               alloc_insts,    // Instructions it stands for
+    output logic [WIDTH-1:0][ROB_IDX_BITS-1:0]  alloc_idx,      // Assigned ROB index
+    output logic                                alloc_ready,    // Room for a full group
+
+    // Complete: mark instructions as done (one per complete port)
+    input  logic [COMPLETE_PORTS-1:0]                   complete_en,
+    input  logic [COMPLETE_PORTS-1:0][ROB_IDX_BITS-1:0] complete_idx,
+    input  logic [COMPLETE_PORTS-1:0][31:0]             complete_result,
+
+    // Commit: retire from head (in program order), slot r = head + r
+    output logic [RETIRE_WIDTH-1:0]                    commit_valid,    // Entries head..head+r all done
+    output logic [RETIRE_WIDTH-1:0][4:0]               commit_rd,
+    output logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] commit_phys_rd,
+    output logic [RETIRE_WIDTH-1:0][PHYS_REG_BITS-1:0] commit_old_phys, // Register to free
+    output logic [RETIRE_WIDTH-1:0][31:0]              commit_result,
+    output logic [RETIRE_WIDTH-1:0][31:0]              commit_pc,       // For replaying from the head
+    output logic [RETIRE_WIDTH-1:0]                    commit_mem,      // Load or store
+    output logic [RETIRE_WIDTH-1:0]                    commit_elim,     // Eliminated at rename
+    output logic [RETIRE_WIDTH-1:0][3:0]               commit_insts,
+    input  logic [RETIRE_WIDTH-1:0]                    commit_ack,      // Retire these (a prefix)
+    output logic [ROB_IDX_BITS+3:0]                    insts_in_flight, // Sum over valid entries
+
+    // Statistics
+    output logic [31:0] stat_occupancy,     // Sum of entries in use, per cycle
+    output logic [31:0] stat_full_cycles,   // Cycles with no room for a group
+    output logic [31:0] stat_commit_stalls  // Cycles with a busy, unfinished head
 );
 
     // ROB entry fields (separate arrays for Icarus compatibility)
@@ -42,21 +93,84 @@ module rob #(
     logic [PHYS_REG_BITS-1:0] old_phys  [0:ROB_SIZE-1];
     logic [31:0] result     [0:ROB_SIZE-1];
     logic [31:0] pc         [0:ROB_SIZE-1];
+    logic        mem        [0:ROB_SIZE-1];
+    logic        elim       [0:ROB_SIZE-1];
+    logic [3:0]  insts      [0:ROB_SIZE-1];
 
     // Head and tail pointers
     logic [ROB_IDX_BITS-1:0] head;
     logic [ROB_IDX_BITS-1:0] tail;
     logic [ROB_IDX_BITS:0]   count;
 
+    // Slot k gets the index after those taken by older slots
+    logic [ROB_IDX_BITS:0] alloc_total;
+
+    always_comb begin
+        alloc_total = 0;
+        for (int k = 0; k < WIDTH; k++) begin
+            alloc_idx[k] = tail + alloc_total[ROB_IDX_BITS-1:0];
+            if (alloc_en[k])
+                alloc_total = alloc_total + 1;
+        end
+    end
+
     // Outputs
-    assign alloc_idx   = tail;
-    assign alloc_ready = (count < ROB_SIZE);
+    assign head_idx    = head;
+    assign alloc_ready = (count <= ROB_SIZE - WIDTH);
 
-    assign commit_valid    = (count > 0) && valid[head] && done[head];
-    assign commit_rd       = rd[head];
-    assign commit_phys_rd  = phys_rd[head];
-    assign commit_old_phys = old_phys[head];
-    assign commit_result   = result[head];
+    // Retire candidates: a run of done entries starting at the head
+    logic [ROB_IDX_BITS-1:0] commit_idx [0:RETIRE_WIDTH-1];
+    logic [ROB_IDX_BITS:0]   commit_total;
+    logic                    commit_run;
+
+    always_comb begin
+        commit_total = 0;
+        commit_run   = 1'b1;
+        for (int r = 0; r < RETIRE_WIDTH; r++) begin
+            commit_idx[r]      = head + r;
+            commit_run         = commit_run && (count > r) &&
+                                 valid[commit_idx[r]] && done[commit_idx[r]];
+            commit_valid[r]    = commit_run;
+            commit_rd[r]       = rd[commit_idx[r]];
+            commit_phys_rd[r]  = phys_rd[commit_idx[r]];
+            commit_old_phys[r] = old_phys[commit_idx[r]];
+            commit_result[r]   = result[commit_idx[r]];
+            commit_pc[r]       = pc[commit_idx[r]];
+            commit_mem[r]      = mem[commit_idx[r]];
+            commit_elim[r]     = elim[commit_idx[r]];
+            commit_insts[r]    = insts[commit_idx[r]];
+            if (commit_ack[r] && commit_valid[r])
+                commit_total = commit_total + 1;
+        end
+    end
+
+    always_comb begin
+        insts_in_flight = 0;
+        for (int i = 0; i < ROB_SIZE; i++) begin
+            if (valid[i])
+                insts_in_flight = insts_in_flight + insts[i];
+        end
+    end
+
+    // Age of every entry (0 = head), and how many entries a squash keeps
+    logic [ROB_IDX_BITS-1:0] entry_age [0:ROB_SIZE-1];
+    logic [ROB_IDX_BITS-1:0] squash_age;
+
+    always_comb begin
+        for (int i = 0; i < ROB_SIZE; i++) begin
+            entry_age[i] = i[ROB_IDX_BITS-1:0] - head;
+        end
+    end
+
+    assign squash_age = squash_idx - head;
+
+    always_comb begin
+        squash_insts = 0;
+        for (int i = 0; i < ROB_SIZE; i++) begin
+            if (valid[i] && entry_age[i] > squash_age)
+                squash_insts = squash_insts + insts[i];
+        end
+    end
 
     always_ff @(posedge clk or posedge rst) begin
         if (rst || flush) begin
@@ -73,37 +187,81 @@ module rob #(
                     old_phys[i] <= 0;
                     result[i]   <= 32'd0;
                     pc[i]       <= 32'd0;
+                    mem[i]      <= 1'b0;
+                    elim[i]     <= 1'b0;
+                    insts[i]    <= 4'd0;
                 end
             end
         end else begin
-            // Allocate new entry at tail
-            if (alloc_en && alloc_ready) begin
-                valid[tail]    <= 1'b1;
-                done[tail]     <= 1'b0;
-                rd[tail]       <= alloc_rd;
-                phys_rd[tail]  <= alloc_phys_rd;
-                old_phys[tail] <= alloc_old_phys;
-                pc[tail]       <= alloc_pc;
-                tail           <= tail + 1;
+            // Allocate new entries at the tail (not while squashing)
+            if (alloc_ready && !squash_en) begin
+                for (int k = 0; k < WIDTH; k++) begin
+                    if (alloc_en[k]) begin
+                        valid[alloc_idx[k]]    <= 1'b1;
+                        done[alloc_idx[k]]     <= alloc_elim[k];
+                        rd[alloc_idx[k]]       <= alloc_rd[k];
+                        phys_rd[alloc_idx[k]]  <= alloc_phys_rd[k];
+                        old_phys[alloc_idx[k]] <= alloc_old_phys[k];
+                        pc[alloc_idx[k]]       <= alloc_pc[k];
+                        mem[alloc_idx[k]]      <= alloc_mem[k];
+                        elim[alloc_idx[k]]     <= alloc_elim[k];
+                        insts[alloc_idx[k]]    <= alloc_insts[k];
+                    end
+                end
+                tail <= tail + alloc_total[ROB_IDX_BITS-1:0];
             end
 
-            // Mark instruction as complete
-            if (complete_en) begin
-                done[complete_idx]   <= 1'b1;
-                result[complete_idx] <= complete_result;
+            // Mark instructions as complete
+            for (int p = 0; p < COMPLETE_PORTS; p++) begin
+                if (complete_en[p]) begin
+                    done[complete_idx[p]]   <= 1'b1;
+                    result[complete_idx[p]] <= complete_result[p];
+                end
             end
 
             // Commit from head
-            if (commit_ack && commit_valid) begin
-                valid[head] <= 1'b0;
-                done[head]  <= 1'b0;
-                head        <= head + 1;
+            for (int r = 0; r < RETIRE_WIDTH; r++) begin
+                if (commit_ack[r] && commit_valid[r]) begin
+                    valid[commit_idx[r]] <= 1'b0;
+                    done[commit_idx[r]]  <= 1'b0;
+                end
+            end
+            head <= head + commit_total[ROB_IDX_BITS-1:0];
+
+            if (squash_en) begin
+                // Keep the branch and everything older
+                begin : squash_loop
+                    integer i;
+                    for (i = 0; i < ROB_SIZE; i++) begin
+                        if (entry_age[i] > squash_age) begin
+                            valid[i] <= 1'b0;
+                            done[i]  <= 1'b0;
+                        end
+                    end
+                end
+                tail  <= squash_idx + 1;
+                count <= {1'b0, squash_age} + 1 - commit_total;
+            end else begin
+                // Update count
+                count <= count
+                         + (alloc_ready ? alloc_total : 0)
+                         - commit_total;
             end
+        end
+    end
 
-            // Update count
-            count <= count
-                     + (alloc_en && alloc_ready ? 1 : 0)
-                     - (commit_ack && commit_valid ? 1 : 0);
+    // Statistics
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            stat_occupancy     <= 32'd0;
+            stat_full_cycles   <= 32'd0;
+            stat_commit_stalls <= 32'd0;
+        end else begin
+            stat_occupancy <= stat_occupancy + count;
+            if (!alloc_ready)
+                stat_full_cycles <= stat_full_cycles + 1;
+            if (count > 0 && !commit_valid[0])
+                stat_commit_stalls <= stat_commit_stalls + 1;
         end
     end
 
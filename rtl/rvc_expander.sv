@@ -0,0 +1,178 @@
+// rvc_expander.sv - Expands RV32C compressed instructions to their 32-bit forms
+//
+// Every compressed instruction is shorthand for one base instruction, so
+// the rest of the pipeline never sees a 16-bit encoding: fetch expands it
+// here and the decoder gets the equivalent 32-bit instruction. Only the
+// length (2 bytes, so the next instruction is at PC + 2 and a JAL/JALR
+// links PC + 2) has to travel down the pipeline alongside it.
+//
+// An instruction whose low two bits are 11 is not compressed and passes
+// through untouched. Encodings this core doesn't implement (the F/D loads
+// and stores, RV64-only ops, reserved encodings) expand to all zeroes,
+// which the decoder treats as a bubble.
+//
+// Register fields written rd'/rs1'/rs2' are 3 bits wide and name x8-x15.
+
+module rvc_expander (
+    input  logic [31:0] instruction,   // Compressed in [15:0], or a full instruction
+    output logic [31:0] expanded,
+    output logic        compressed     // Low two bits weren't 11
+);
+
+    // Opcode definitions
+    localparam OP_LUI    = 7'b0110111;
+    localparam OP_JAL    = 7'b1101111;
+    localparam OP_JALR   = 7'b1100111;
+    localparam OP_BRANCH = 7'b1100011;
+    localparam OP_LOAD   = 7'b0000011;
+    localparam OP_STORE  = 7'b0100011;
+    localparam OP_OPIMM  = 7'b0010011;
+    localparam OP_OP     = 7'b0110011;
+
+    // Fields of the compressed instruction
+    logic [15:0] c;
+    logic [1:0]  quadrant;
+    logic [2:0]  funct3;
+    logic [4:0]  rd;          // Full register fields (rd = rs1)
+    logic [4:0]  rs2;
+    logic [4:0]  rd_p;        // rd'/rs1' at [9:7], mapped to x8-x15
+    logic [4:0]  rs2_p;       // rd'/rs2' at [4:2]
+
+    assign c          = instruction[15:0];
+    assign quadrant   = c[1:0];
+    assign funct3     = c[15:13];
+    assign rd         = c[11:7];
+    assign rs2        = c[6:2];
+    assign rd_p       = {2'b01, c[9:7]};
+    assign rs2_p      = {2'b01, c[4:2]};
+    assign compressed = (quadrant != 2'b11);
+
+    // Immediates, already scaled and sign-extended
+    logic [11:0] imm6;        // C.ADDI, C.LI, C.ANDI: imm[5:0]
+    logic [11:0] imm_addi4spn;
+    logic [11:0] imm_addi16sp;
+    logic [11:0] imm_lw;      // C.LW / C.SW
+    logic [11:0] imm_lwsp;
+    logic [11:0] imm_swsp;
+    logic [19:0] imm_lui;     // C.LUI: upper 20 bits
+    logic [20:0] imm_j;       // C.J / C.JAL
+    logic [12:0] imm_b;       // C.BEQZ / C.BNEZ
+    logic [4:0]  shamt;
+
+    assign imm6         = {{7{c[12]}}, c[6:2]};
+    assign imm_addi4spn = {2'b00, c[10:7], c[12:11], c[5], c[6], 2'b00};
+    assign imm_addi16sp = {{3{c[12]}}, c[4:3], c[5], c[2], c[6], 4'b0000};
+    assign imm_lw       = {5'd0, c[5], c[12:10], c[6], 2'b00};
+    assign imm_lwsp     = {4'd0, c[3:2], c[12], c[6:4], 2'b00};
+    assign imm_swsp     = {4'd0, c[8:7], c[12:9], 2'b00};
+    assign imm_lui      = {{15{c[12]}}, c[6:2]};
+    assign imm_j        = {{10{c[12]}}, c[8], c[10:9], c[6], c[7], c[2], c[11], c[5:3], 1'b0};
+    assign imm_b        = {{5{c[12]}}, c[6:5], c[2], c[11:10], c[4:3], 1'b0};
+    assign shamt        = c[6:2];
+
+    always_comb begin
+        expanded = 32'd0;
+
+        case (quadrant)
+            2'b00: begin
+                case (funct3)
+                    3'b000: // C.ADDI4SPN: addi rd', x2, nzuimm
+                        if (imm_addi4spn != 12'd0)
+                            expanded = {imm_addi4spn, 5'd2, 3'b000, rs2_p, OP_OPIMM};
+                    3'b010: // C.LW: lw rd', uimm(rs1')
+                        expanded = {imm_lw, rd_p, 3'b010, rs2_p, OP_LOAD};
+                    3'b110: // C.SW: sw rs2', uimm(rs1')
+                        expanded = {imm_lw[11:5], rs2_p, rd_p, 3'b010, imm_lw[4:0], OP_STORE};
+                    default: ;
+                endcase
+            end
+
+            2'b01: begin
+                case (funct3)
+                    3'b000: // C.ADDI (C.NOP for rd = x0): addi rd, rd, imm
+                        expanded = {imm6, rd, 3'b000, rd, OP_OPIMM};
+                    3'b001, 3'b101: // C.JAL / C.J: jal x1/x0, offset
+                        expanded = {imm_j[20], imm_j[10:1], imm_j[11], imm_j[19:12],
+                                    funct3[2] ? 5'd0 : 5'd1, OP_JAL};
+                    3'b010: // C.LI: addi rd, x0, imm
+                        expanded = {imm6, 5'd0, 3'b000, rd, OP_OPIMM};
+                    3'b011: begin
+                        if (rd == 5'd2) begin
+                            // C.ADDI16SP: addi x2, x2, nzimm
+                            if (imm_addi16sp != 12'd0)
+                                expanded = {imm_addi16sp, 5'd2, 3'b000, 5'd2, OP_OPIMM};
+                        end else if (imm_lui != 20'd0) begin
+                            // C.LUI: lui rd, nzimm
+                            expanded = {imm_lui, rd, OP_LUI};
+                        end
+                    end
+                    3'b100: begin
+                        case (c[11:10])
+                            2'b00: // C.SRLI
+                                if (!c[12])
+                                    expanded = {7'b0000000, shamt, rd_p, 3'b101, rd_p, OP_OPIMM};
+                            2'b01: // C.SRAI
+                                if (!c[12])
+                                    expanded = {7'b0100000, shamt, rd_p, 3'b101, rd_p, OP_OPIMM};
+                            2'b10: // C.ANDI
+                                expanded = {imm6, rd_p, 3'b111, rd_p, OP_OPIMM};
+                            2'b11: // C.SUB / C.XOR / C.OR / C.AND (c[12] set is RV64 only)
+                                if (!c[12]) begin
+                                    case (c[6:5])
+                                        2'b00: expanded = {7'b0100000, rs2_p, rd_p, 3'b000, rd_p, OP_OP};
+                                        2'b01: expanded = {7'b0000000, rs2_p, rd_p, 3'b100, rd_p, OP_OP};
+                                        2'b10: expanded = {7'b0000000, rs2_p, rd_p, 3'b110, rd_p, OP_OP};
+                                        2'b11: expanded = {7'b0000000, rs2_p, rd_p, 3'b111, rd_p, OP_OP};
+                                    endcase
+                                end
+                        endcase
+                    end
+                    3'b110, 3'b111: // C.BEQZ / C.BNEZ: beq/bne rs1', x0, offset
+                        expanded = {imm_b[12], imm_b[10:5], 5'd0, rd_p, 2'b00, funct3[0],
+                                    imm_b[4:1], imm_b[11], OP_BRANCH};
+                    default: ;
+                endcase
+            end
+
+            2'b10: begin
+                case (funct3)
+                    3'b000: // C.SLLI
+                        if (!c[12])
+                            expanded = {7'b0000000, shamt, rd, 3'b001, rd, OP_OPIMM};
+                    3'b010: // C.LWSP: lw rd, uimm(x2)
+                        if (rd != 5'd0)
+                            expanded = {imm_lwsp, 5'd2, 3'b010, rd, OP_LOAD};
+                    3'b100: begin
+                        if (!c[12]) begin
+                            if (rs2 == 5'd0) begin
+                                // C.JR: jalr x0, 0(rs1)
+                                if (rd != 5'd0)
+                                    expanded = {12'd0, rd, 3'b000, 5'd0, OP_JALR};
+                            end else begin
+                                // C.MV: add rd, x0, rs2
+                                expanded = {7'b0000000, rs2, 5'd0, 3'b000, rd, OP_OP};
+                            end
+                        end else begin
+                            if (rs2 == 5'd0) begin
+                                // C.EBREAK, or C.JALR: jalr x1, 0(rs1)
+                                if (rd == 5'd0)
+                                    expanded = 32'h00100073;
+                                else
+                                    expanded = {12'd0, rd, 3'b000, 5'd1, OP_JALR};
+                            end else begin
+                                // C.ADD: add rd, rd, rs2
+                                expanded = {7'b0000000, rs2, rd, 3'b000, rd, OP_OP};
+                            end
+                        end
+                    end
+                    3'b110: // C.SWSP: sw rs2, uimm(x2)
+                        expanded = {imm_swsp[11:5], rs2, 5'd2, 3'b010, imm_swsp[4:0], OP_STORE};
+                    default: ;
+                endcase
+            end
+
+            default: expanded = instruction;  // Not compressed
+        endcase
+    end
+
+endmodule
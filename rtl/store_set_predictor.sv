@@ -0,0 +1,155 @@
+// store_set_predictor.sv - Memory dependence prediction (store sets)
+//
+// Loads in the OoO core run as soon as their address is known, even past
+// older stores whose address isn't. Almost always that's fine. When it
+// isn't, the load is replayed, which costs a full flush. Store sets learn
+// which loads have collided with which stores, and only those loads wait.
+//
+// Structure:
+// - SSIT (store set ID table): indexed by PC, gives the store set a load
+//   or store belongs to (if any)
+// - LFST (last fetched store table): per store set, the LSQ entry of the
+//   most recently dispatched store in that set
+//
+// Dispatch:
+// - Store in a set: becomes the set's last fetched store
+// - Load in a set:  waits for that store's address (if there is one)
+// When the store's address is computed, it is no longer something to wait
+// for, so its LFST entry is cleared.
+//
+// Training (ordering violation between a store and a load):
+// - Neither in a set: both join a new set (numbered after the load's PC)
+// - One in a set:     the other joins it
+// - Both in sets:     both go to the load's set
+//
+// The SSIT is wiped every 2^CLEAR_BITS cycles so stale dependences that
+// only serialize loads don't live forever.
+
+module store_set_predictor #(
+    parameter SSIT_BITS    = 6,   // 2^6 = 64 SSIT entries
+    parameter SSID_BITS    = 4,   // 2^4 = 16 store sets
+    parameter LSQ_IDX_BITS = 3,
+    parameter CLEAR_BITS   = 12   // Wipe the SSIT every 4096 cycles
+)(
+    input  logic                    clk,
+    input  logic                    rst,
+    input  logic                    flush,        // Replay: no stores in flight
+
+    // Dispatch lookup
+    input  logic [31:0]             dispatch_pc,
+    input  logic                    dispatch_load,
+    input  logic                    dispatch_store,
+    input  logic [LSQ_IDX_BITS-1:0] dispatch_lsq_idx,
+    output logic                    wait_valid,   // Load should wait for...
+    output logic [LSQ_IDX_BITS-1:0] wait_idx,     // ...this store's address
+
+    // A store computed its address
+    input  logic                    store_exec_en,
+    input  logic [LSQ_IDX_BITS-1:0] store_exec_idx,
+
+    // Ordering violation between these two
+    input  logic                    train_en,
+    input  logic [31:0]             train_load_pc,
+    input  logic [31:0]             train_store_pc,
+
+    // Statistics
+    output logic [31:0]             stat_predicted_deps  // Loads told to wait
+);
+
+    localparam SSIT_SIZE = (1 << SSIT_BITS);
+    localparam NUM_SETS  = (1 << SSID_BITS);
+
+    logic                    ssit_valid [0:SSIT_SIZE-1];
+    logic [SSID_BITS-1:0]    ssit_ssid  [0:SSIT_SIZE-1];
+    logic                    lfst_valid [0:NUM_SETS-1];
+    logic [LSQ_IDX_BITS-1:0] lfst_idx   [0:NUM_SETS-1];
+
+    logic [CLEAR_BITS-1:0]   clear_count;
+
+    // Lookup
+    logic [SSIT_BITS-1:0] d_index;
+    logic [SSID_BITS-1:0] d_ssid;
+    logic                 d_in_set;
+
+    assign d_index  = dispatch_pc[SSIT_BITS+1:2];
+    assign d_in_set = ssit_valid[d_index];
+    assign d_ssid   = ssit_ssid[d_index];
+
+    assign wait_valid = dispatch_load && d_in_set && lfst_valid[d_ssid];
+    assign wait_idx   = lfst_idx[d_ssid];
+
+    // Training
+    logic [SSIT_BITS-1:0] t_load_index;
+    logic [SSIT_BITS-1:0] t_store_index;
+    logic [SSID_BITS-1:0] t_ssid;
+
+    assign t_load_index  = train_load_pc[SSIT_BITS+1:2];
+    assign t_store_index = train_store_pc[SSIT_BITS+1:2];
+    assign t_ssid = ssit_valid[t_load_index]  ? ssit_ssid[t_load_index] :
+                    ssit_valid[t_store_index] ? ssit_ssid[t_store_index] :
+                                                train_load_pc[SSID_BITS+1:2];
+
+    initial begin
+        for (int i = 0; i < SSIT_SIZE; i++) begin
+            ssit_valid[i] = 1'b0;
+            ssit_ssid[i]  = '0;
+        end
+        for (int s = 0; s < NUM_SETS; s++) begin
+            lfst_valid[s] = 1'b0;
+            lfst_idx[s]   = '0;
+        end
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            for (int i = 0; i < SSIT_SIZE; i++) begin
+                ssit_valid[i] <= 1'b0;
+                ssit_ssid[i]  <= '0;
+            end
+            for (int s = 0; s < NUM_SETS; s++) begin
+                lfst_valid[s] <= 1'b0;
+                lfst_idx[s]   <= '0;
+            end
+            clear_count         <= '0;
+            stat_predicted_deps <= 32'd0;
+        end else begin
+            clear_count <= clear_count + 1'b1;
+
+            // SSIT: periodic wipe > training
+            if (clear_count == {CLEAR_BITS{1'b1}}) begin
+                for (int i = 0; i < SSIT_SIZE; i++) begin
+                    ssit_valid[i] <= 1'b0;
+                end
+            end else if (train_en) begin
+                ssit_valid[t_load_index]  <= 1'b1;
+                ssit_ssid[t_load_index]   <= t_ssid;
+                ssit_valid[t_store_index] <= 1'b1;
+                ssit_ssid[t_store_index]  <= t_ssid;
+            end
+
+            // LFST
+            if (flush) begin
+                for (int s = 0; s < NUM_SETS; s++) begin
+                    lfst_valid[s] <= 1'b0;
+                end
+            end else begin
+                // Store addresses that are known no longer block anything
+                if (store_exec_en) begin
+                    for (int s = 0; s < NUM_SETS; s++) begin
+                        if (lfst_valid[s] && lfst_idx[s] == store_exec_idx)
+                            lfst_valid[s] <= 1'b0;
+                    end
+                end
+                if (dispatch_store && d_in_set) begin
+                    lfst_valid[d_ssid] <= 1'b1;
+                    lfst_idx[d_ssid]   <= dispatch_lsq_idx;
+                end
+            end
+
+            if (wait_valid) begin
+                stat_predicted_deps <= stat_predicted_deps + 1;
+            end
+        end
+    end
+
+endmodule
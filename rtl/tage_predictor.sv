@@ -0,0 +1,329 @@
+// tage_predictor.sv - TAGE branch direction predictor
+//
+// TAGE = TAgged GEometric history length predictor.
+//
+// Structure:
+// - Base predictor: PC-indexed table of 2-bit counters (same as bimodal)
+// - NUM_TABLES tagged tables. Table t is indexed and tagged with a hash of
+//   the PC and the most recent hist_len(t) bits of global history, where the
+//   lengths grow geometrically: MIN_HIST, 2*MIN_HIST, 4*MIN_HIST, ...
+//   (capped at the 32-bit history the pipeline carries)
+// - Each tagged entry: [valid][tag][3-bit counter][2-bit useful]
+//
+// Prediction:
+// - The "provider" is the hitting table with the longest history
+// - The "alternate" is the next hitting table below it (or the base)
+// - Predict with the provider's counter (taken if counter >= 4)
+//
+// Update (when the branch resolves):
+// - Train the provider's counter (or the base counter if nothing hit)
+// - If provider and alternate disagreed, bump the provider's useful bits up
+//   when it was right and down when it was wrong
+// - On a misprediction, allocate an entry in a longer-history table whose
+//   useful bits are 0. If none is free, age the candidates instead.
+// - Every 2^AGE_BITS updates all useful bits are halved, so stale entries
+//   eventually become replaceable
+//
+// Storage (bits) = 2 * 2^BASE_INDEX_BITS
+//                + NUM_TABLES * 2^TABLE_INDEX_BITS * (1 + TAG_BITS + 3 + 2)
+// A configuration over STORAGE_BUDGET bits stops the simulation at time 0
+// (0 = no budget), so table sizes can be traded without creeping past it.
+//
+// Same predict/update interface as branch_predictor.sv, including the
+// speculative global history with checkpoint repair on misprediction.
+
+module tage_predictor #(
+    parameter BASE_INDEX_BITS  = 6,  // 2^6 = 64 base counters
+    parameter NUM_TABLES       = 4,  // Tagged tables
+    parameter TABLE_INDEX_BITS = 5,  // 2^5 = 32 entries per tagged table
+    parameter TAG_BITS         = 8,  // Partial tag per tagged entry
+    parameter MIN_HIST         = 4,  // History length of the first tagged table
+    parameter AGE_BITS         = 8,  // Halve useful bits every 2^8 updates
+    parameter STORAGE_BUDGET   = 2048  // Bits the tables may use (0 = unchecked)
+)(
+    input  logic        clk,
+    input  logic        rst,
+
+    // Prediction interface (IF stage)
+    input  logic [31:0] pc_if,           // PC to predict for
+    output logic        predict_taken,   // Prediction: 1=taken, 0=not taken
+    input  logic        predict_en,      // Known branch leaving IF: shift prediction into GHR
+    input  logic        predict_final,   // Direction fetch followed (after any override)
+    output logic [31:0] predict_history, // GHR used for this prediction (checkpoint)
+
+    // Update interface (when branch resolves)
+    input  logic        update_en,       // Update the predictor
+    input  logic [31:0] update_pc,       // PC of the branch being updated
+    input  logic        actual_taken,    // What actually happened
+    input  logic [31:0] update_history,  // GHR checkpoint captured at predict time
+    input  logic        mispredict,      // Branch was mispredicted: repair the GHR
+
+    // Redirect by something other than a conditional branch (predecode, a
+    // mispredicted jump): roll the GHR back to that instruction's checkpoint
+    input  logic        restore_en,
+    input  logic [31:0] restore_history,
+
+    // Statistics
+    output logic [31:0] stat_branches,   // Branches resolved
+    output logic [31:0] stat_mispredicts // Branches mispredicted
+);
+
+    localparam BASE_ENTRIES  = (1 << BASE_INDEX_BITS);
+    localparam TABLE_ENTRIES = (1 << TABLE_INDEX_BITS);
+    localparam STORAGE_BITS  = 2 * BASE_ENTRIES +
+                               NUM_TABLES * TABLE_ENTRIES * (1 + TAG_BITS + 3 + 2);
+
+    initial begin
+        if (STORAGE_BUDGET != 0 && STORAGE_BITS > STORAGE_BUDGET)
+            $fatal(1, "tage_predictor: %0d bits of storage, budget is %0d",
+                   STORAGE_BITS, STORAGE_BUDGET);
+    end
+
+    // ============================================================
+    // Storage
+    // ============================================================
+
+    logic [1:0]          base_ctr [0:BASE_ENTRIES-1];
+
+    logic                valid  [0:NUM_TABLES-1][0:TABLE_ENTRIES-1];
+    logic [TAG_BITS-1:0] tags   [0:NUM_TABLES-1][0:TABLE_ENTRIES-1];
+    logic [2:0]          ctr    [0:NUM_TABLES-1][0:TABLE_ENTRIES-1];
+    logic [1:0]          useful [0:NUM_TABLES-1][0:TABLE_ENTRIES-1];
+
+    logic [31:0]         ghr;
+    logic [AGE_BITS-1:0] age_counter;
+
+    assign predict_history = ghr;
+
+    // ============================================================
+    // Hashing helpers
+    // ============================================================
+
+    // History length for tagged table t (geometric, capped at 32)
+    function automatic integer hist_len(input integer t);
+        hist_len = ((MIN_HIST << t) > 32) ? 32 : (MIN_HIST << t);
+    endfunction
+
+    // XOR-fold the most recent len bits of history down to width bits
+    function automatic logic [31:0] fold_history(input logic [31:0] hist,
+                                                 input integer len,
+                                                 input integer width);
+        fold_history = 32'd0;
+        for (int b = 0; b < 32; b++) begin
+            if (b < len)
+                fold_history[b % width] = fold_history[b % width] ^ hist[b];
+        end
+    endfunction
+
+    function automatic logic [TABLE_INDEX_BITS-1:0] table_index(input logic [31:0] pc,
+                                                                input logic [31:0] hist,
+                                                                input integer t);
+        logic [31:0] folded;
+        folded = fold_history(hist, hist_len(t), TABLE_INDEX_BITS);
+        table_index = pc[TABLE_INDEX_BITS+1:2] ^ pc[2*TABLE_INDEX_BITS+1:TABLE_INDEX_BITS+2] ^
+                      folded[TABLE_INDEX_BITS-1:0];
+    endfunction
+
+    function automatic logic [TAG_BITS-1:0] table_tag(input logic [31:0] pc,
+                                                      input logic [31:0] hist,
+                                                      input integer t);
+        logic [31:0] folded_a;
+        logic [31:0] folded_b;
+        folded_a = fold_history(hist, hist_len(t), TAG_BITS);
+        folded_b = fold_history(hist, hist_len(t), TAG_BITS - 1);
+        table_tag = pc[TAG_BITS+1:2] ^ folded_a[TAG_BITS-1:0] ^ {folded_b[TAG_BITS-2:0], 1'b0};
+    endfunction
+
+    // 3-bit saturating counter step
+    function automatic logic [2:0] ctr3_next(input logic [2:0] c, input logic up);
+        if (up)
+            ctr3_next = (c == 3'b111) ? c : c + 3'd1;
+        else
+            ctr3_next = (c == 3'b000) ? c : c - 3'd1;
+    endfunction
+
+    // 2-bit saturating counter step
+    function automatic logic [1:0] ctr2_next(input logic [1:0] c, input logic up);
+        if (up)
+            ctr2_next = (c == 2'b11) ? c : c + 2'd1;
+        else
+            ctr2_next = (c == 2'b00) ? c : c - 2'd1;
+    endfunction
+
+    // ============================================================
+    // Table lookups (one set for predict, one for update)
+    // ============================================================
+
+    logic [NUM_TABLES-1:0][TABLE_INDEX_BITS-1:0] p_index;
+    logic [NUM_TABLES-1:0][TAG_BITS-1:0]         p_tag;
+    logic [NUM_TABLES-1:0]                       p_hit;
+
+    logic [NUM_TABLES-1:0][TABLE_INDEX_BITS-1:0] u_index;
+    logic [NUM_TABLES-1:0][TAG_BITS-1:0]         u_tag;
+    logic [NUM_TABLES-1:0]                       u_hit;
+
+    genvar t;
+    generate
+        for (t = 0; t < NUM_TABLES; t++) begin : g_lookup
+            assign p_index[t] = table_index(pc_if, ghr, t);
+            assign p_tag[t]   = table_tag(pc_if, ghr, t);
+            assign p_hit[t]   = valid[t][p_index[t]] && (tags[t][p_index[t]] == p_tag[t]);
+
+            assign u_index[t] = table_index(update_pc, update_history, t);
+            assign u_tag[t]   = table_tag(update_pc, update_history, t);
+            assign u_hit[t]   = valid[t][u_index[t]] && (tags[t][u_index[t]] == u_tag[t]);
+        end
+    endgenerate
+
+    logic [BASE_INDEX_BITS-1:0] p_base_index;
+    logic [BASE_INDEX_BITS-1:0] u_base_index;
+
+    assign p_base_index = pc_if[BASE_INDEX_BITS+1:2];
+    assign u_base_index = update_pc[BASE_INDEX_BITS+1:2];
+
+    // ============================================================
+    // Prediction: longest matching history wins
+    // ============================================================
+
+    always_comb begin
+        predict_taken = base_ctr[p_base_index][1];
+        for (int i = 0; i < NUM_TABLES; i++) begin
+            if (p_hit[i])
+                predict_taken = ctr[i][p_index[i]][2];
+        end
+    end
+
+    // ============================================================
+    // Update-side provider / alternate / allocation selection
+    // ============================================================
+
+    logic                  u_provider_hit;
+    integer                u_provider;
+    logic                  u_provider_pred;
+    logic                  u_alt_pred;
+    logic                  alloc_found;
+    integer                alloc_table;
+
+    always_comb begin
+        u_provider_hit  = 1'b0;
+        u_provider      = 0;
+        u_provider_pred = base_ctr[u_base_index][1];
+        u_alt_pred      = base_ctr[u_base_index][1];
+        for (int i = 0; i < NUM_TABLES; i++) begin
+            if (u_hit[i]) begin
+                u_alt_pred      = u_provider_pred;
+                u_provider_hit  = 1'b1;
+                u_provider      = i;
+                u_provider_pred = ctr[i][u_index[i]][2];
+            end
+        end
+
+        // First longer-history table with a non-useful entry
+        alloc_found = 1'b0;
+        alloc_table = 0;
+        for (int i = 0; i < NUM_TABLES; i++) begin
+            if (!alloc_found && (!u_provider_hit || i > u_provider) &&
+                useful[i][u_index[i]] == 2'b00) begin
+                alloc_found = 1'b1;
+                alloc_table = i;
+            end
+        end
+    end
+
+    // ============================================================
+    // Initialization and update
+    // ============================================================
+
+    initial begin
+        for (int i = 0; i < BASE_ENTRIES; i++) begin
+            base_ctr[i] = 2'b10;  // Weakly taken, like the bimodal predictor
+        end
+        for (int i = 0; i < NUM_TABLES; i++) begin
+            for (int j = 0; j < TABLE_ENTRIES; j++) begin
+                valid[i][j]  = 1'b0;
+                tags[i][j]   = '0;
+                ctr[i][j]    = 3'b100;
+                useful[i][j] = 2'b00;
+            end
+        end
+        ghr = 32'd0;
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            for (int i = 0; i < BASE_ENTRIES; i++) begin
+                base_ctr[i] <= 2'b10;
+            end
+            for (int i = 0; i < NUM_TABLES; i++) begin
+                for (int j = 0; j < TABLE_ENTRIES; j++) begin
+                    valid[i][j]  <= 1'b0;
+                    tags[i][j]   <= '0;
+                    ctr[i][j]    <= 3'b100;
+                    useful[i][j] <= 2'b00;
+                end
+            end
+            ghr              <= 32'd0;
+            age_counter      <= '0;
+            stat_branches    <= 32'd0;
+            stat_mispredicts <= 32'd0;
+        end else begin
+            if (update_en) begin
+                // Train the provider (or the base table if nothing hit)
+                if (u_provider_hit) begin
+                    ctr[u_provider][u_index[u_provider]] <=
+                        ctr3_next(ctr[u_provider][u_index[u_provider]], actual_taken);
+
+                    // Useful bits track whether the provider beat the alternate
+                    if (u_provider_pred != u_alt_pred) begin
+                        useful[u_provider][u_index[u_provider]] <=
+                            ctr2_next(useful[u_provider][u_index[u_provider]],
+                                      u_provider_pred == actual_taken);
+                    end
+                end else begin
+                    base_ctr[u_base_index] <= ctr2_next(base_ctr[u_base_index], actual_taken);
+                end
+
+                // Allocate a longer-history entry on a misprediction
+                if (u_provider_pred != actual_taken &&
+                    (!u_provider_hit || u_provider < NUM_TABLES - 1)) begin
+                    if (alloc_found) begin
+                        valid[alloc_table][u_index[alloc_table]]  <= 1'b1;
+                        tags[alloc_table][u_index[alloc_table]]   <= u_tag[alloc_table];
+                        ctr[alloc_table][u_index[alloc_table]]    <= actual_taken ? 3'b100 : 3'b011;
+                        useful[alloc_table][u_index[alloc_table]] <= 2'b00;
+                    end else begin
+                        for (int i = 0; i < NUM_TABLES; i++) begin
+                            if (!u_provider_hit || i > u_provider)
+                                useful[i][u_index[i]] <= ctr2_next(useful[i][u_index[i]], 1'b0);
+                        end
+                    end
+                end
+
+                // Periodic useful-bit aging
+                age_counter <= age_counter + 1;
+                if (age_counter == {AGE_BITS{1'b1}}) begin
+                    for (int i = 0; i < NUM_TABLES; i++) begin
+                        for (int j = 0; j < TABLE_ENTRIES; j++) begin
+                            useful[i][j] <= useful[i][j] >> 1;
+                        end
+                    end
+                end
+
+                stat_branches <= stat_branches + 1;
+                if (mispredict) begin
+                    stat_mispredicts <= stat_mispredicts + 1;
+                end
+            end
+
+            // History: repair on misprediction, otherwise shift in predictions
+            if (update_en && mispredict) begin
+                ghr <= {update_history[30:0], actual_taken};
+            end else if (restore_en) begin
+                ghr <= restore_history;
+            end else if (predict_en) begin
+                ghr <= {ghr[30:0], predict_final};
+            end
+        end
+    end
+
+endmodule
@@ -16,6 +16,8 @@ typedef struct {
     uint8_t* mem;
     uint32_t mem_size;
     bool halted;
+    uint64_t cycle;
+    uint64_t instret;
 } RiscvCpu;
 
 void riscv_init(RiscvCpu* cpu, uint8_t* mem, uint32_t mem_size);
@@ -24,6 +26,7 @@ uint32_t riscv_get_pc(RiscvCpu* cpu);
 uint32_t riscv_get_reg(RiscvCpu* cpu, uint32_t reg);
 void riscv_set_reg(RiscvCpu* cpu, uint32_t reg, uint32_t value);
 void riscv_load_program(RiscvCpu* cpu, const uint8_t* program, uint32_t size);
+uint32_t riscv_get_csr(RiscvCpu* cpu, uint32_t csr);
 bool riscv_is_halted(RiscvCpu* cpu);
 
 #ifdef __cplusplus
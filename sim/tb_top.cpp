@@ -133,6 +133,14 @@ public:
         return rtl->rootp->cpu_top__DOT__pc;
     }
 
+    uint64_t getRtlInstret() {
+        return rtl->rootp->cpu_top__DOT__perf__DOT__instret;
+    }
+
+    uint64_t getRtlCycles() {
+        return rtl->rootp->cpu_top__DOT__perf__DOT__cycle;
+    }
+
     bool compareState() {
         bool match = true;
 
@@ -158,6 +166,13 @@ public:
             }
         }
 
+        // Compare retired-instruction counts
+        if (getRtlInstret() != ref.instret) {
+            std::cerr << "INSTRET MISMATCH: RTL=" << getRtlInstret()
+                      << " REF=" << ref.instret << std::endl;
+            match = false;
+        }
+
         return match;
     }
 
@@ -215,6 +230,22 @@ public:
         }
 
         printState();
+        printTopDown();
+    }
+
+    // Top-down breakdown of the run. The single-cycle core issues and
+    // retires an instruction every cycle, so nothing is ever frontend,
+    // speculation or backend bound; any other split means it lost a cycle.
+    void printTopDown() {
+        uint64_t slots = getRtlCycles();
+        uint64_t retiring = getRtlInstret();
+        uint64_t lost = slots - retiring;
+
+        std::cout << "Top-down (" << slots << " issue slots):" << std::endl;
+        std::cout << "  Retiring " << retiring << " ("
+                  << (slots ? retiring * 100 / slots : 0) << "%)";
+        if (lost) std::cout << ", " << lost << " slots lost!";
+        std::cout << std::endl;
     }
 };
 
@@ -271,6 +302,17 @@ int main(int argc, char** argv) {
     test_shift.push_back(0x00000013);  // nop
     tb.runTest("Shifts", test_shift, 4);
 
+    // Test 6: Counter CSRs (one instruction per cycle, no hardware events)
+    std::vector<uint32_t> test_csr;
+    test_csr.push_back(0xC00020F3);  // csrr x1, cycle       (x1 = 0)
+    test_csr.push_back(0x00100293);  // addi x5, x0, 1
+    test_csr.push_back(0xC0202173);  // csrr x2, instret     (x2 = 2)
+    test_csr.push_back(0xC03021F3);  // csrr x3, hpmcounter3 (x3 = 0)
+    test_csr.push_back(0x32302273);  // csrr x4, mhpmevent3  (x4 = 1, I-cache hits)
+    test_csr.push_back(0xC8002373);  // csrr x6, cycleh      (x6 = 0)
+    test_csr.push_back(0x00000013);  // nop
+    tb.runTest("Counter CSRs", test_csr, 7);
+
     // Summary
     std::cout << "\n========================================" << std::endl;
     std::cout << "Test Summary" << std::endl;
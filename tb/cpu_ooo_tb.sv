@@ -1,16 +1,45 @@
 // cpu_ooo_tb.sv - Testbench for Out-of-Order CPU
 
-module cpu_ooo_tb;
+module cpu_ooo_tb #(
+    parameter BP_TYPE = 2,  // 0 = bimodal, 1 = gshare, 2 = tournament, 3 = TAGE
+    parameter [31:0] HPM_EVENTS = 32'h87654321, // Event per hpmcounter
+    parameter MAX_CYCLES = 5000                 // Limit for programs that don't halt
+);
 
     logic clk;
     logic rst;
+    int   td_slots;   // Top-down total
+    int   cycles;
+
+    logic [31:0][31:0] final_regs;
 
     // Instantiate the OoO CPU
-    cpu_ooo cpu (
+    cpu_ooo #(
+        .BP_TYPE(BP_TYPE),
+        .HPM_EVENTS(HPM_EVENTS)
+    ) cpu (
         .clk (clk),
         .rst (rst)
     );
 
+    // Per-PC profile: D-cache misses go to the load or store the LSQ sent
+    // to the cache, mispredicts to the branch that recovered, and cycles
+    // dispatch was blocked to the first instruction of the waiting group.
+    // There's no I-cache.
+    logic [31:0] dc_access_pc;
+
+    assign dc_access_pc = cpu.lsq.pc[cpu.lsq.cache_read_en ? cpu.lsq.ld_idx : cpu.lsq.head_idx];
+
+    pc_profile prof (
+        .clk        (clk),
+        .rst        (rst),
+        .event_valid({cpu.frontend_stall, cpu.recover, cpu.dc_miss, 1'b0}),
+        .event_pc   ({cpu.fd_pc, cpu.resolve_pc, dc_access_pc, 32'd0})
+    );
+
+    // Checks the committed registers against +expect=<file>
+    reg_check regs_check ();
+
     // Clock generation: 10ns period
     initial begin
         clk = 0;
@@ -26,7 +55,7 @@ module cpu_ooo_tb;
         $display("  RISC-V Out-of-Order CPU Test");
         $display("===========================================");
         $display("");
-        $display("Test program:");
+        $display("Default test program:");
         $display("  ADDI x1, x0, 5     // x1 = 5");
         $display("  ADDI x2, x0, 3     // x2 = 3  (independent)");
         $display("  ADD  x3, x1, x2    // x3 = 8  (depends on x1, x2)");
@@ -62,29 +91,69 @@ module cpu_ooo_tb;
                      cpu.prf.regs[cpu.rat_inst.comm_rat[5]]);
         end
 
+        // Run the rest of the program: until fetch is parked on its final
+        // `j .` with everything ahead of it committed
+        cycles = 60;
+        while (!(cpu.fd_valid[0] && cpu.fd_instruction[0] == 32'h0000006f &&
+                 cpu.rob_insts_in_flight == 0) && cycles < MAX_CYCLES) begin
+            @(posedge clk);
+            cycles += 1;
+        end
+        repeat (100) @(posedge clk);
+        #1;
+
         $display("");
-        $display("===========================================");
-        $display("  Final Register Values (committed)");
-        $display("===========================================");
+        $display("Front end: %0d instructions dispatched in %0d groups",
+                 cpu.stat_dispatched, cpu.stat_dispatch_groups);
+        $display("Rename: %0d moves and %0d zero idioms eliminated",
+                 cpu.stat_moves_elim, cpu.stat_zeros_elim);
+        $display("Fusion: %0d lui+addi, %0d auipc+jalr, %0d compare+branch",
+                 cpu.stat_fused_li, cpu.stat_fused_call, cpu.stat_fused_cmp_br);
+        $display("MulDiv: %0d multiplies, %0d divides, divider busy %0d cycles",
+                 cpu.stat_mul_ops, cpu.stat_div_ops, cpu.stat_div_busy);
+        $display("Issue: %0d cycles issued on more than one port", cpu.stat_multi_issue);
+        $display("       cycles in IQ: 0:%0d 1:%0d 2:%0d 3:%0d 4-7:%0d 8-15:%0d 16-31:%0d 32+:%0d",
+                 cpu.stat_issue_latency[0], cpu.stat_issue_latency[1],
+                 cpu.stat_issue_latency[2], cpu.stat_issue_latency[3],
+                 cpu.stat_issue_latency[4], cpu.stat_issue_latency[5],
+                 cpu.stat_issue_latency[6], cpu.stat_issue_latency[7]);
+        $display("       ready but waiting: %0d entry-cycles, longest %0d cycles",
+                 cpu.stat_ready_waits, cpu.stat_max_ready_wait);
+        $display("Retire: %0d instructions in %0d cycles, %0d cycles retired more than one",
+                 cpu.stat_retired, cpu.stat_cycles, cpu.stat_multi_retire);
+        $display("ROB: %0d entry-cycles in use, %0d cycles full, %0d cycles waiting on the head",
+                 cpu.stat_rob_occupancy, cpu.stat_rob_full, cpu.stat_commit_stalls);
+        $display("Branches (predictor type %0d): %0d resolved, %0d mispredicted; %0d checkpoint recoveries",
+                 BP_TYPE, cpu.stat_branches, cpu.stat_mispredicts, cpu.stat_recoveries);
+        $display("Memory: %0d loads forwarded, %0d ordering violations, %0d replays",
+                 cpu.stat_lsq_forwards, cpu.stat_lsq_violations, cpu.stat_replays);
+        $display("        %0d loads ran past unknown store addresses, %0d held back by store sets",
+                 cpu.stat_lsq_spec_loads, cpu.stat_predicted_deps);
+        $display("Counters: cycle %0d, instret %0d",
+                 cpu.perf.cycle, cpu.perf.instret);
+        for (int i = 0; i < 8; i++)
+            $display("          hpmcounter%0d (event %0d): %0d",
+                     i + 3, cpu.perf.hpm_event[i], cpu.perf.hpm[i]);
+        td_slots = cpu.stat_td_frontend + cpu.stat_td_bad_spec + cpu.stat_td_backend_mem +
+                   cpu.stat_td_backend_core + cpu.stat_td_retiring;
+        $display("Top-down (%0d issue slots):", td_slots);
+        $display("  Frontend bound    %6d  %3d%%", cpu.stat_td_frontend,
+                 cpu.stat_td_frontend * 100 / td_slots);
+        $display("  Bad speculation   %6d  %3d%%", cpu.stat_td_bad_spec,
+                 cpu.stat_td_bad_spec * 100 / td_slots);
+        $display("  Backend (memory)  %6d  %3d%%", cpu.stat_td_backend_mem,
+                 cpu.stat_td_backend_mem * 100 / td_slots);
+        $display("  Backend (core)    %6d  %3d%%", cpu.stat_td_backend_core,
+                 cpu.stat_td_backend_core * 100 / td_slots);
+        $display("  Retiring          %6d  %3d%%", cpu.stat_td_retiring,
+                 cpu.stat_td_retiring * 100 / td_slots);
+        prof.report(8);
 
         // Read committed values through committed RAT
-        $display("x1 = %0d (expected: 5)",  cpu.prf.regs[cpu.rat_inst.comm_rat[1]]);
-        $display("x2 = %0d (expected: 3)",  cpu.prf.regs[cpu.rat_inst.comm_rat[2]]);
-        $display("x3 = %0d (expected: 8)",  cpu.prf.regs[cpu.rat_inst.comm_rat[3]]);
-        $display("x4 = %0d (expected: 10)", cpu.prf.regs[cpu.rat_inst.comm_rat[4]]);
-        $display("x5 = %0d (expected: 18)", cpu.prf.regs[cpu.rat_inst.comm_rat[5]]);
-
-        if (cpu.prf.regs[cpu.rat_inst.comm_rat[1]] == 5 &&
-            cpu.prf.regs[cpu.rat_inst.comm_rat[2]] == 3 &&
-            cpu.prf.regs[cpu.rat_inst.comm_rat[3]] == 8 &&
-            cpu.prf.regs[cpu.rat_inst.comm_rat[4]] == 10 &&
-            cpu.prf.regs[cpu.rat_inst.comm_rat[5]] == 18) begin
-            $display("");
-            $display("*** PASS - Out-of-order execution works! ***");
-        end else begin
-            $display("");
-            $display("*** FAIL ***");
-        end
+        for (int i = 0; i < 32; i++)
+            final_regs[i] = cpu.prf.regs[cpu.rat_inst.comm_rat[i]];
+        $display("");
+        regs_check.check(final_regs);
 
         $display("");
         $finish;
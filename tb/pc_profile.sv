@@ -0,0 +1,110 @@
+// pc_profile.sv - Per-PC event profile for the testbenches
+//
+// The stat counters say how often something slow happened; this says
+// where. Every cycle the testbench hands over up to four events, each
+// with the PC of the instruction responsible for it:
+//
+//   0 icache_miss   an I-cache miss starting its fill
+//   1 dcache_miss   a D-cache miss starting its fill
+//   2 mispredict    a branch or jump that redirected fetch when it resolved
+//   3 stall         a cycle the core held an instruction back (which
+//                   stall counts, and whose PC it goes to, is up to the tb)
+//
+// report() prints the PCs with the most events, hottest first. With
+// +profile=<file> on the vvp command line it also writes every nonzero
+// count in folded-stack form, one "event;0xPC count" line each: the PCs
+// match the addresses in the assembler's listing (riscv-asm -l), and
+// flamegraph.pl takes the file as is.
+//
+// Counts are kept per halfword (compressed instructions sit at halfword
+// addresses) for PCs below 2^PC_BITS; a PC above that lands on its low
+// bits.
+
+module pc_profile #(
+    parameter PC_BITS = 12      // Covers the 4KB instruction memory
+) (
+    input  logic             clk,
+    input  logic             rst,
+    input  logic [3:0]       event_valid,   // Bit e = event e happened this cycle
+    input  logic [3:0][31:0] event_pc       // ...at this PC
+);
+
+    localparam NUM_EVENTS = 4;
+    localparam ENTRIES    = 1 << (PC_BITS - 1);
+
+    int count [0:NUM_EVENTS-1][0:ENTRIES-1];
+
+    always @(posedge clk) begin
+        if (!rst) begin
+            for (int e = 0; e < NUM_EVENTS; e++) begin
+                if (event_valid[e])
+                    count[e][event_pc[e][PC_BITS-1:1]] += 1;
+            end
+        end
+    end
+
+    function automatic string event_name(input int e);
+        case (e)
+            0:       return "icache_miss";
+            1:       return "dcache_miss";
+            2:       return "mispredict";
+            default: return "stall";
+        endcase
+    endfunction
+
+    function automatic int total(input int i);
+        total = 0;
+        for (int e = 0; e < NUM_EVENTS; e++)
+            total += count[e][i];
+    endfunction
+
+    // Prints the top_n PCs by total events and writes the folded profile
+    task automatic report(input int top_n);
+        int    order [0:ENTRIES-1];   // PCs with any events, hottest first
+        int    used;
+        int    best;
+        int    swap;
+        int    fd;
+        string path;
+
+        used = 0;
+        for (int i = 0; i < ENTRIES; i++) begin
+            if (total(i) != 0) begin
+                order[used] = i;
+                used += 1;
+            end
+        end
+
+        // Selection sort, only as far as the rows printed
+        for (int k = 0; k < used && k < top_n; k++) begin
+            best = k;
+            for (int j = k + 1; j < used; j++) begin
+                if (total(order[j]) > total(order[best]))
+                    best = j;
+            end
+            swap        = order[k];
+            order[k]    = order[best];
+            order[best] = swap;
+        end
+
+        $display("Hot spots (%0d PCs with events):", used);
+        $display("  PC          I$ miss  D$ miss  mispred    stall");
+        for (int k = 0; k < used && k < top_n; k++)
+            $display("  0x%08h  %7d  %7d  %7d  %7d", order[k] << 1,
+                     count[0][order[k]], count[1][order[k]],
+                     count[2][order[k]], count[3][order[k]]);
+
+        if ($value$plusargs("profile=%s", path)) begin
+            fd = $fopen(path, "w");
+            for (int e = 0; e < NUM_EVENTS; e++) begin
+                for (int i = 0; i < ENTRIES; i++) begin
+                    if (count[e][i] != 0)
+                        $fwrite(fd, "%s;0x%08h %0d\n", event_name(e), i << 1, count[e][i]);
+                end
+            end
+            $fclose(fd);
+            $display("  folded profile written to %s", path);
+        end
+    endtask
+
+endmodule
@@ -0,0 +1,50 @@
+// reg_check.sv - Final register check for the testbenches
+//
+// With +expect=<file> on the vvp command line, check() compares the
+// architectural registers the testbench hands it against the values in
+// the file, and stops the simulation with $fatal if any differ. The file
+// is $readmemh input, an "@<register>" address and a value per line:
+//
+//   @0a 00000005    // x10 = 5
+//
+// Registers the file leaves out aren't checked. Without +expect nothing
+// is checked.
+
+module reg_check;
+
+    logic [31:0] expected [0:31];
+
+    task automatic check(input logic [31:0][31:0] regs);
+        string path;
+        int    checked;
+        int    wrong;
+
+        if (!$value$plusargs("expect=%s", path)) begin
+            $display("No +expect file, registers not checked");
+        end else begin
+            $readmemh(path, expected);
+
+            checked = 0;
+            wrong   = 0;
+            $display("Registers (%s):", path);
+            for (int i = 1; i < 32; i++) begin
+                if (expected[i] !== 32'hxxxxxxxx) begin
+                    checked += 1;
+                    if (regs[i] !== expected[i]) begin
+                        wrong += 1;
+                        $display("  x%0d = 0x%08h  expected 0x%08h", i, regs[i], expected[i]);
+                    end else begin
+                        $display("  x%0d = 0x%08h", i, regs[i]);
+                    end
+                end
+            end
+
+            if (checked == 0)
+                $fatal(1, "No registers to check in %s", path);
+            if (wrong != 0)
+                $fatal(1, "*** FAIL - %0d of %0d registers wrong ***", wrong, checked);
+            $display("*** PASS - %0d registers match ***", checked);
+        end
+    endtask
+
+endmodule